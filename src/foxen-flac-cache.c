@@ -0,0 +1,323 @@
+/*
+ *  libfoxenflac -- Tiny FLAC Decoder Library
+ *  Copyright (C) 2018-2025  Andreas Stöckel
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "foxen-flac-cache.h"
+
+/******************************************************************************
+ * Internal structs                                                           *
+ ******************************************************************************/
+
+/**
+ * Marks the end of the LRU list.
+ */
+#define FX_FLAC_CACHE_NONE UINT32_MAX
+
+/**
+ * Bookkeeping information for a single slot.
+ */
+typedef struct {
+	/**
+	 * Index of the first sample (per channel) of the frame in this slot.
+	 */
+	uint64_t first_sample;
+
+	/**
+	 * Number of samples per channel in the frame.
+	 */
+	uint32_t n_samples;
+
+	/**
+	 * Neighbours in the LRU list; prev is used more recently.
+	 */
+	uint32_t prev;
+	uint32_t next;
+
+	/**
+	 * Number of interleaved channels.
+	 */
+	uint8_t n_channels;
+} fx_flac_cache_slot_t;
+
+/**
+ * Private definition of the fx_flac_cache structure.
+ */
+struct fx_flac_cache {
+	/**
+	 * Number of samples that fit into a single slot.
+	 */
+	uint32_t slot_size;
+
+	/**
+	 * Number of slots and number of slots in use. Slots are taken in order,
+	 * so the slots [0, n_used) are in use.
+	 */
+	uint32_t n_slots;
+	uint32_t n_used;
+
+	/**
+	 * Most and least recently used slot.
+	 */
+	uint32_t lru_head;
+	uint32_t lru_tail;
+
+	/**
+	 * Hit and miss counters.
+	 */
+	fx_flac_cache_stats_t stats;
+
+	/**
+	 * Bookkeeping information for each slot.
+	 */
+	fx_flac_cache_slot_t *slots;
+
+	/**
+	 * Indices of the slots in use, sorted by their first sample.
+	 */
+	uint32_t *order;
+
+	/**
+	 * Sample memory; slot i starts at data + i * slot_size.
+	 */
+	int32_t *data;
+};
+
+/******************************************************************************
+ * PRIVATE CODE                                                               *
+ ******************************************************************************/
+
+#define FX_FLAC_CACHE_ALIGN 8U
+
+#define FX_FLAC_CACHE_ALIGN_ADDR(P)                                  \
+	((fx_flac_cache_t *)(((uintptr_t)(P) + FX_FLAC_CACHE_ALIGN - 1U) & \
+	                     (~(uintptr_t)(FX_FLAC_CACHE_ALIGN - 1U))))
+
+static void _fx_flac_cache_unlink(fx_flac_cache_t *cache, uint32_t i) {
+	fx_flac_cache_slot_t *slot = &cache->slots[i];
+	if (slot->prev != FX_FLAC_CACHE_NONE) {
+		cache->slots[slot->prev].next = slot->next;
+	} else {
+		cache->lru_head = slot->next;
+	}
+	if (slot->next != FX_FLAC_CACHE_NONE) {
+		cache->slots[slot->next].prev = slot->prev;
+	} else {
+		cache->lru_tail = slot->prev;
+	}
+}
+
+static void _fx_flac_cache_push_front(fx_flac_cache_t *cache, uint32_t i) {
+	fx_flac_cache_slot_t *slot = &cache->slots[i];
+	slot->prev = FX_FLAC_CACHE_NONE;
+	slot->next = cache->lru_head;
+	if (cache->lru_head != FX_FLAC_CACHE_NONE) {
+		cache->slots[cache->lru_head].prev = i;
+	} else {
+		cache->lru_tail = i;
+	}
+	cache->lru_head = i;
+}
+
+/**
+ * Returns the number of entries in the order array whose first sample is
+ * smaller than or equal to the given sample.
+ */
+static uint32_t _fx_flac_cache_bisect(const fx_flac_cache_t *cache,
+                                      uint64_t sample) {
+	uint32_t lo = 0U, hi = cache->n_used;
+	while (lo < hi) {
+		const uint32_t mid = lo + (hi - lo) / 2U;
+		if (cache->slots[cache->order[mid]].first_sample <= sample) {
+			lo = mid + 1U;
+		} else {
+			hi = mid;
+		}
+	}
+	return lo;
+}
+
+/**
+ * Returns the slot holding the given sample or FX_FLAC_CACHE_NONE.
+ */
+static uint32_t _fx_flac_cache_find(const fx_flac_cache_t *cache,
+                                    uint64_t sample) {
+	const uint32_t pos = _fx_flac_cache_bisect(cache, sample);
+	if (pos == 0U) {
+		return FX_FLAC_CACHE_NONE;
+	}
+	const uint32_t i = cache->order[pos - 1U];
+	const fx_flac_cache_slot_t *slot = &cache->slots[i];
+	return (sample - slot->first_sample < slot->n_samples) ? i
+	                                                       : FX_FLAC_CACHE_NONE;
+}
+
+/**
+ * Removes the least recently used frame from the cache and returns its slot.
+ */
+static uint32_t _fx_flac_cache_evict(fx_flac_cache_t *cache) {
+	const uint32_t i = cache->lru_tail;
+	_fx_flac_cache_unlink(cache, i);
+
+	/* Frames with the same first sample are never stored twice, so the
+	   bisection finds exactly this slot */
+	const uint32_t pos =
+	    _fx_flac_cache_bisect(cache, cache->slots[i].first_sample) - 1U;
+	for (uint32_t j = pos; j + 1U < cache->n_used; j++) {
+		cache->order[j] = cache->order[j + 1U];
+	}
+	cache->n_used--;
+	cache->stats.n_evictions++;
+	return i;
+}
+
+/******************************************************************************
+ * PUBLIC API                                                                 *
+ ******************************************************************************/
+
+fx_flac_cache_t *fx_flac_cache_init(void *mem, uint32_t size,
+                                    uint16_t max_block_size,
+                                    uint8_t max_channels) {
+	const uint32_t overhead = sizeof(fx_flac_cache_t) + FX_FLAC_CACHE_ALIGN;
+	const uint32_t slot_size = (uint32_t)max_block_size * max_channels;
+	const uint64_t slot_bytes = sizeof(fx_flac_cache_slot_t) +
+	                            sizeof(uint32_t) +
+	                            (uint64_t)slot_size * sizeof(int32_t);
+	if (!mem || (size < overhead) || (slot_size == 0U) ||
+	    ((size - overhead) / slot_bytes == 0U)) {
+		return NULL;
+	}
+	fx_flac_cache_t *cache = FX_FLAC_CACHE_ALIGN_ADDR(mem);
+	cache->slot_size = slot_size;
+	cache->n_slots = (uint32_t)((size - overhead) / slot_bytes);
+	cache->slots = (fx_flac_cache_slot_t *)(cache + 1);
+	cache->order = (uint32_t *)(cache->slots + cache->n_slots);
+	cache->data = (int32_t *)(cache->order + cache->n_slots);
+	cache->stats.n_hits = 0U;
+	cache->stats.n_misses = 0U;
+	cache->stats.n_evictions = 0U;
+	fx_flac_cache_clear(cache);
+	return (fx_flac_cache_t *)mem;
+}
+
+void fx_flac_cache_clear(fx_flac_cache_t *cache) {
+	cache = FX_FLAC_CACHE_ALIGN_ADDR(cache);
+	cache->n_used = 0U;
+	cache->lru_head = FX_FLAC_CACHE_NONE;
+	cache->lru_tail = FX_FLAC_CACHE_NONE;
+}
+
+bool fx_flac_cache_insert(fx_flac_cache_t *cache, uint64_t first_sample,
+                          uint32_t n_samples, uint8_t n_channels,
+                          const int32_t *samples) {
+	cache = FX_FLAC_CACHE_ALIGN_ADDR(cache);
+	const uint64_t n = (uint64_t)n_samples * n_channels;
+	if ((n == 0U) || (n > cache->slot_size)) {
+		return false;
+	}
+
+	/* Frames that are already cached are only marked as used */
+	uint32_t pos = _fx_flac_cache_bisect(cache, first_sample);
+	if ((pos > 0U) &&
+	    (cache->slots[cache->order[pos - 1U]].first_sample == first_sample)) {
+		const uint32_t i = cache->order[pos - 1U];
+		_fx_flac_cache_unlink(cache, i);
+		_fx_flac_cache_push_front(cache, i);
+		return true;
+	}
+
+	/* Take the next free slot or evict the least recently used frame */
+	uint32_t i = cache->n_used;
+	if (cache->n_used == cache->n_slots) {
+		i = _fx_flac_cache_evict(cache);
+		pos = _fx_flac_cache_bisect(cache, first_sample);
+	}
+	fx_flac_cache_slot_t *slot = &cache->slots[i];
+	slot->first_sample = first_sample;
+	slot->n_samples = n_samples;
+	slot->n_channels = n_channels;
+	int32_t *tar = cache->data + (size_t)i * cache->slot_size;
+	for (uint32_t j = 0U; j < n; j++) {
+		tar[j] = samples[j];
+	}
+
+	/* Keep the order array sorted */
+	for (uint32_t j = cache->n_used; j > pos; j--) {
+		cache->order[j] = cache->order[j - 1U];
+	}
+	cache->order[pos] = i;
+	cache->n_used++;
+	_fx_flac_cache_push_front(cache, i);
+	return true;
+}
+
+bool fx_flac_cache_read(fx_flac_cache_t *cache, uint64_t sample,
+                        int32_t *out, uint32_t *out_len,
+                        uint8_t *n_channels) {
+	cache = FX_FLAC_CACHE_ALIGN_ADDR(cache);
+	uint32_t n_written = 0U;
+	uint8_t cc = 0U;
+	uint32_t i;
+	while ((i = _fx_flac_cache_find(cache, sample)) != FX_FLAC_CACHE_NONE) {
+		const fx_flac_cache_slot_t *slot = &cache->slots[i];
+		if (cc == 0U) {
+			cc = slot->n_channels;
+		} else if (slot->n_channels != cc) {
+			break;
+		}
+
+		/* Copy as many samples of this frame as fit into the output */
+		const uint32_t offs = (uint32_t)(sample - slot->first_sample);
+		uint32_t n = slot->n_samples - offs;
+		if (n > (*out_len - n_written) / cc) {
+			n = (*out_len - n_written) / cc;
+		}
+		const int32_t *src =
+		    cache->data + (size_t)i * cache->slot_size + (size_t)offs * cc;
+		for (uint32_t j = 0U; j < n * cc; j++) {
+			out[n_written + j] = src[j];
+		}
+		n_written += n * cc;
+		sample += n;
+		_fx_flac_cache_unlink(cache, i);
+		_fx_flac_cache_push_front(cache, i);
+		if (n < slot->n_samples - offs) {
+			break; /* Output buffer is full */
+		}
+	}
+	*out_len = n_written;
+	if (n_channels) {
+		*n_channels = cc;
+	}
+	if (cc == 0U) {
+		cache->stats.n_misses++;
+		return false;
+	}
+	cache->stats.n_hits++;
+	return true;
+}
+
+void fx_flac_cache_get_stats(const fx_flac_cache_t *cache,
+                             fx_flac_cache_stats_t *stats) {
+	cache = FX_FLAC_CACHE_ALIGN_ADDR(cache);
+	*stats = cache->stats;
+	stats->n_frames = cache->n_used;
+	stats->max_frames = cache->n_slots;
+}
@@ -0,0 +1,159 @@
+/*
+ *  libfoxenflac -- Tiny FLAC Decoder Library
+ *  Copyright (C) 2018-2025  Andreas Stöckel
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file foxen-flac-cache.h
+ *
+ * Cache for decoded frames, e.g. for editors scrubbing over the same region
+ * or for looped playback. Frames are stored in a fixed-size memory region and
+ * looked up by sample number; once the region is full, the least recently
+ * used frame is evicted. Just like the decoder itself, this code does not
+ * depend on the C library.
+ *
+ * @author Andreas Stöckel
+ */
+
+#ifndef FOXEN_FLAC_CACHE_H
+#define FOXEN_FLAC_CACHE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "foxen-flac.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Opaque struct representing a frame cache.
+ */
+struct fx_flac_cache;
+
+/**
+ * Typedef for the fx_flac_cache struct.
+ */
+typedef struct fx_flac_cache fx_flac_cache_t;
+
+/**
+ * Cache statistics, see fx_flac_cache_get_stats().
+ */
+typedef struct {
+	/**
+	 * Number of calls to fx_flac_cache_read() that returned samples.
+	 */
+	uint32_t n_hits;
+
+	/**
+	 * Number of calls to fx_flac_cache_read() that did not find the sample.
+	 */
+	uint32_t n_misses;
+
+	/**
+	 * Number of frames that were evicted to make room for new frames.
+	 */
+	uint32_t n_evictions;
+
+	/**
+	 * Number of frames currently stored in the cache.
+	 */
+	uint32_t n_frames;
+
+	/**
+	 * Maximum number of frames the cache can hold.
+	 */
+	uint32_t max_frames;
+} fx_flac_cache_stats_t;
+
+/**
+ * Initializes an empty cache in the given memory region. The region is split
+ * into slots that hold one frame each.
+ *
+ * @param mem is a pointer at the memory region the cache is stored in. May be
+ * NULL, in which case NULL is returned.
+ * @param size is the size of the memory region in bytes, i.e. the byte budget
+ * of the cache.
+ * @param max_block_size is the maximum number of samples per channel in a
+ * frame. Frames with more samples cannot be cached.
+ * @param max_channels is the maximum number of channels of a frame.
+ * @return a pointer at the cache instance, or NULL if the memory region is too
+ * small to hold a single frame.
+ */
+FX_EXPORT fx_flac_cache_t *fx_flac_cache_init(void *mem, uint32_t size,
+                                              uint16_t max_block_size,
+                                              uint8_t max_channels);
+
+/**
+ * Macro which calls malloc to allocate memory for a new cache with the given
+ * byte budget. The returned pointer must be freed using free.
+ */
+#define FX_FLAC_CACHE_ALLOC(size, max_block_size, max_channels) \
+	fx_flac_cache_init(malloc(size), (size), (max_block_size), (max_channels))
+
+/**
+ * Removes all frames from the cache. The statistics are retained.
+ */
+FX_EXPORT void fx_flac_cache_clear(fx_flac_cache_t *cache);
+
+/**
+ * Stores a decoded frame in the cache, evicting the least recently used
+ * frame if necessary. Frames already in the cache are only marked as used.
+ *
+ * @param cache is the cache instance.
+ * @param first_sample is the index of the first sample (per channel) of the
+ * frame, see fx_flac_get_frame_info().
+ * @param n_samples is the number of samples per channel in the frame.
+ * @param n_channels is the number of interleaved channels.
+ * @param samples is a pointer at the interleaved samples as written by
+ * fx_flac_process().
+ * @return false if the frame exceeds the size passed to fx_flac_cache_init()
+ * and was not stored, true otherwise.
+ */
+FX_EXPORT bool fx_flac_cache_insert(fx_flac_cache_t *cache,
+                                    uint64_t first_sample, uint32_t n_samples,
+                                    uint8_t n_channels, const int32_t *samples);
+
+/**
+ * Copies samples starting at the given sample from the cache. Continues with
+ * the following frames as long as they are cached, have the same number of
+ * channels and there is space in the output buffer.
+ *
+ * @param cache is the cache instance.
+ * @param sample is the index of the first sample (per channel) to read.
+ * @param out is the buffer receiving the interleaved samples.
+ * @param out_len is a pointer at the number of samples (not samples per
+ * channel) that fit into out. Contains the number of samples written after
+ * the function returns; this is always a multiple of n_channels.
+ * @param n_channels is a pointer at a variable receiving the number of
+ * interleaved channels. May be NULL.
+ * @return true if the frame containing the sample is cached, false otherwise.
+ */
+FX_EXPORT bool fx_flac_cache_read(fx_flac_cache_t *cache, uint64_t sample,
+                                  int32_t *out, uint32_t *out_len,
+                                  uint8_t *n_channels);
+
+/**
+ * Returns the hit and miss counters and the occupancy of the cache.
+ */
+FX_EXPORT void fx_flac_cache_get_stats(const fx_flac_cache_t *cache,
+                                       fx_flac_cache_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* FOXEN_FLAC_CACHE_H */
@@ -0,0 +1,352 @@
+/*
+ *  libfoxenflac -- Tiny FLAC Decoder Library
+ *  Copyright (C) 2018-2025  Andreas Stöckel
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "foxen-flac-index.h"
+
+/******************************************************************************
+ * Internal state machine enums and structs                                   *
+ ******************************************************************************/
+
+/**
+ * Maximum size of a frame header in bytes. Headers starting within this many
+ * bytes of the end of the data are parsed in the next call.
+ */
+#define FX_FLAC_INDEX_MAX_HEADER_SIZE 16U
+
+/**
+ * Lower bound for the size of a frame in bytes: frame header, a single
+ * constant subframe and the CRC-16 checksum. Used to bound the number of
+ * frames with a damaged header between two frames.
+ */
+#define FX_FLAC_INDEX_MIN_FRAME_SIZE 9U
+
+typedef enum {
+	INDEX_MARKER = 0,
+	INDEX_METADATA = 1,
+	INDEX_FRAMES = 2,
+	INDEX_ERR = 3
+} fx_flac_index_state_t;
+
+/**
+ * Private definition of the fx_flac_index structure.
+ */
+struct fx_flac_index {
+	/**
+	 * Stream format read from the STREAMINFO block; used to validate frame
+	 * headers.
+	 */
+	fx_flac_probe_t info;
+
+	/**
+	 * File offset of the next byte passed to fx_flac_index_extend().
+	 */
+	uint64_t offset;
+
+	/**
+	 * Number of bytes that should be skipped before parsing continues.
+	 */
+	uint64_t skip;
+
+	/**
+	 * Index of the first sample of the frame following the last frame.
+	 */
+	uint64_t next_sample;
+
+	/**
+	 * File offset of the last frame.
+	 */
+	uint64_t last_offset;
+
+	/**
+	 * Frame that does not follow the last frame but may follow a frame with
+	 * a damaged header; it is only indexed once the next frame continues it.
+	 * Stores the offset, first sample and the first sample of the next frame.
+	 */
+	uint64_t resync_offset;
+	uint64_t resync_sample;
+	uint64_t resync_next;
+
+	/**
+	 * Current state of the parser.
+	 */
+	fx_flac_index_state_t state;
+
+	/**
+	 * True once the last metadata block header has been read.
+	 */
+	bool last_metadata;
+
+	/**
+	 * True once the first frame has been found.
+	 */
+	bool has_frame;
+
+	/**
+	 * True if resync_offset, resync_sample and resync_next are valid.
+	 */
+	bool has_resync;
+
+	/**
+	 * Minimum distance between entries in samples.
+	 */
+	uint32_t spacing;
+
+	/**
+	 * Capacity of the entry array and the number of valid entries. The latter
+	 * is published to readers using atomic operations.
+	 */
+	uint32_t max_entries;
+	uint32_t n_entries;
+
+	/**
+	 * Entries, stored directly after this structure.
+	 */
+	fx_flac_index_entry_t *entries;
+};
+
+/******************************************************************************
+ * PRIVATE CODE                                                               *
+ ******************************************************************************/
+
+#define FX_FLAC_INDEX_ALIGN 8U
+
+#define FX_FLAC_INDEX_ALIGN_ADDR(P)                                  \
+	((fx_flac_index_t *)(((uintptr_t)(P) + FX_FLAC_INDEX_ALIGN - 1U) & \
+	                     (~(uintptr_t)(FX_FLAC_INDEX_ALIGN - 1U))))
+
+/* Entries are written before the number of entries is incremented; readers
+   must observe the entries once they observe the new count. Without compiler
+   support for atomics, the index must not be shared between threads. */
+#if defined(__GNUC__) || defined(__clang__)
+#define FX_FLAC_INDEX_LOAD_COUNT(P) __atomic_load_n((P), __ATOMIC_ACQUIRE)
+#define FX_FLAC_INDEX_STORE_COUNT(P, V) \
+	__atomic_store_n((P), (V), __ATOMIC_RELEASE)
+#else
+#define FX_FLAC_INDEX_LOAD_COUNT(P) (*(P))
+#define FX_FLAC_INDEX_STORE_COUNT(P, V) (*(P) = (V))
+#endif
+
+static void _fx_flac_index_append(fx_flac_index_t *idx, uint64_t offset,
+                                  uint64_t first_sample) {
+	const uint32_t n = idx->n_entries; /* Only written by this thread */
+	if ((n > 0U) &&
+	    (first_sample < idx->entries[n - 1U].first_sample + idx->spacing)) {
+		return;
+	}
+	if (n == idx->max_entries) {
+		return; /* The index is full */
+	}
+	idx->entries[n].offset = offset;
+	idx->entries[n].first_sample = first_sample;
+	FX_FLAC_INDEX_STORE_COUNT(&idx->n_entries, n + 1U);
+}
+
+/**
+ * Returns true if a frame starting at the given offset and sample may follow
+ * the last frame. Frames with a damaged header are skipped, so the frame may
+ * start later than expected; each skipped frame occupies at least the minimum
+ * frame size. This bound is loose, a false positive passing it is only ruled
+ * out by the next frame.
+ */
+static bool _fx_flac_index_follows(const fx_flac_index_t *idx,
+                                   uint64_t offset, uint64_t first_sample) {
+	const uint32_t min_size =
+	    (idx->info.min_frame_size > FX_FLAC_INDEX_MIN_FRAME_SIZE)
+	        ? idx->info.min_frame_size
+	        : FX_FLAC_INDEX_MIN_FRAME_SIZE;
+	const uint32_t max_block =
+	    idx->info.max_block_size ? idx->info.max_block_size : 65535U;
+	const uint64_t n_lost = (offset - idx->last_offset) / min_size;
+	return (first_sample >= idx->next_sample) &&
+	       (first_sample - idx->next_sample <= n_lost * max_block);
+}
+
+/******************************************************************************
+ * PUBLIC API                                                                 *
+ ******************************************************************************/
+
+uint32_t fx_flac_index_size(uint32_t max_entries) {
+	return sizeof(fx_flac_index_t) +
+	       max_entries * sizeof(fx_flac_index_entry_t) + FX_FLAC_INDEX_ALIGN;
+}
+
+fx_flac_index_t *fx_flac_index_init(void *mem, uint32_t max_entries,
+                                    uint32_t spacing) {
+	if (mem) {
+		fx_flac_index_t *idx = FX_FLAC_INDEX_ALIGN_ADDR(mem);
+		idx->offset = 0U;
+		idx->skip = 0U;
+		idx->next_sample = 0U;
+		idx->last_offset = 0U;
+		idx->state = INDEX_MARKER;
+		idx->last_metadata = false;
+		idx->has_frame = false;
+		idx->has_resync = false;
+		idx->spacing = spacing;
+		idx->max_entries = max_entries;
+		idx->n_entries = 0U;
+		idx->entries = (fx_flac_index_entry_t *)(idx + 1);
+	}
+	return (fx_flac_index_t *)mem;
+}
+
+uint64_t fx_flac_index_get_offset(const fx_flac_index_t *idx) {
+	return FX_FLAC_INDEX_ALIGN_ADDR(idx)->offset;
+}
+
+bool fx_flac_index_extend(fx_flac_index_t *idx, const uint8_t *buf,
+                          uint32_t *len) {
+	idx = FX_FLAC_INDEX_ALIGN_ADDR(idx);
+	const uint32_t n = *len;
+	uint32_t pos = 0U;
+	bool done = false;
+	while (!done && idx->state != INDEX_ERR) {
+		/* Skip the contents of metadata blocks and frames */
+		if (idx->skip > 0U) {
+			const uint32_t n_skip =
+			    (idx->skip < n - pos) ? (uint32_t)idx->skip : n - pos;
+			pos += n_skip;
+			idx->skip -= n_skip;
+			done = idx->skip > 0U;
+			continue;
+		}
+
+		switch (idx->state) {
+			case INDEX_MARKER: {
+				/* Skip ID3v2 tags and read the STREAMINFO block */
+				const uint32_t res =
+				    fx_flac_probe(buf + pos, n - pos, &idx->info);
+				if (res == 0U) {
+					idx->state = INDEX_ERR;
+				} else if (res <= n - pos) {
+					pos += idx->info.offset + 4U; /* "fLaC" */
+					idx->state = INDEX_METADATA;
+				} else if (idx->info.offset > 0U) {
+					idx->skip = idx->info.offset;
+				} else {
+					done = true; /* Need more data */
+				}
+				break;
+			}
+			case INDEX_METADATA: {
+				if (idx->last_metadata) {
+					idx->state = INDEX_FRAMES;
+					break;
+				}
+				if (n - pos < 4U) {
+					done = true; /* Need more data */
+					break;
+				}
+				const uint8_t *hdr = buf + pos;
+				if ((hdr[0] & 0x7FU) == 0x7FU) {
+					idx->state = INDEX_ERR; /* Invalid block type */
+					break;
+				}
+				idx->last_metadata = hdr[0] & 0x80U;
+				idx->skip = ((uint32_t)hdr[1] << 16U) |
+				            ((uint32_t)hdr[2] << 8U) | hdr[3];
+				pos += 4U;
+				break;
+			}
+			case INDEX_FRAMES: {
+				/* Leave headers that may be incomplete to the next call */
+				if (n - pos <= FX_FLAC_INDEX_MAX_HEADER_SIZE) {
+					done = true;
+					break;
+				}
+				const uint32_t end = n - FX_FLAC_INDEX_MAX_HEADER_SIZE;
+				uint64_t first_sample;
+				uint32_t n_samples;
+				const int32_t res = fx_flac_find_frame(
+				    buf + pos, n - pos, &idx->info, &first_sample, &n_samples);
+				if ((res < 0) || (pos + (uint32_t)res >= end)) {
+					pos = end;
+					done = true;
+					break;
+				}
+				pos += (uint32_t)res;
+
+				/* Only accept frames that follow the last frame; anything else
+				   is a false positive within the audio data or a frame
+				   following frames with a damaged header. Accept the latter
+				   once the next frame continues it. */
+				if (idx->has_frame && (first_sample != idx->next_sample)) {
+					if (!idx->has_resync ||
+					    (first_sample != idx->resync_next)) {
+						if (_fx_flac_index_follows(idx, idx->offset + pos,
+						                           first_sample)) {
+							idx->resync_offset = idx->offset + pos;
+							idx->resync_sample = first_sample;
+							idx->resync_next = first_sample + n_samples;
+							idx->has_resync = true;
+						}
+						pos++;
+						break;
+					}
+					_fx_flac_index_append(idx, idx->resync_offset,
+					                      idx->resync_sample);
+				}
+				idx->has_resync = false;
+				_fx_flac_index_append(idx, idx->offset + pos, first_sample);
+				idx->next_sample = first_sample + n_samples;
+				idx->last_offset = idx->offset + pos;
+				idx->has_frame = true;
+
+				/* Jump over the smallest possible frame */
+				const uint32_t min_size = idx->info.min_frame_size;
+				idx->skip = (min_size > 1U) ? min_size : 1U;
+				break;
+			}
+			case INDEX_ERR:
+				break;
+		}
+	}
+	idx->offset += pos;
+	*len = pos;
+	return idx->state != INDEX_ERR;
+}
+
+uint32_t fx_flac_index_get_count(const fx_flac_index_t *idx) {
+	return FX_FLAC_INDEX_LOAD_COUNT(&FX_FLAC_INDEX_ALIGN_ADDR(idx)->n_entries);
+}
+
+bool fx_flac_index_lookup(const fx_flac_index_t *idx, uint64_t sample,
+                          fx_flac_index_entry_t *entry) {
+	idx = FX_FLAC_INDEX_ALIGN_ADDR(idx);
+	const uint32_t n = FX_FLAC_INDEX_LOAD_COUNT(&idx->n_entries);
+	if ((n == 0U) || (sample < idx->entries[0].first_sample)) {
+		return false;
+	}
+
+	/* Find the last entry with first_sample <= sample */
+	uint32_t lo = 0U, hi = n;
+	while (hi - lo > 1U) {
+		const uint32_t mid = lo + (hi - lo) / 2U;
+		if (idx->entries[mid].first_sample <= sample) {
+			lo = mid;
+		} else {
+			hi = mid;
+		}
+	}
+	*entry = idx->entries[lo];
+	return true;
+}
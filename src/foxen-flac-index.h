@@ -0,0 +1,151 @@
+/*
+ *  libfoxenflac -- Tiny FLAC Decoder Library
+ *  Copyright (C) 2018-2025  Andreas Stöckel
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file foxen-flac-index.h
+ *
+ * Incremental index mapping sample numbers to the byte offsets of frames.
+ * The index is built by scanning the frame headers only, without decoding
+ * the audio data, and can be extended as a file grows, e.g. while a live
+ * session is being recorded. Entries are only ever appended; a single writer
+ * may extend the index while any number of readers look up entries
+ * concurrently. Just like the decoder itself, this code does not depend on
+ * the C library.
+ *
+ * @author Andreas Stöckel
+ */
+
+#ifndef FOXEN_FLAC_INDEX_H
+#define FOXEN_FLAC_INDEX_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "foxen-flac.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Opaque struct representing a frame index.
+ */
+struct fx_flac_index;
+
+/**
+ * Typedef for the fx_flac_index struct.
+ */
+typedef struct fx_flac_index fx_flac_index_t;
+
+/**
+ * Entry of the frame index.
+ */
+typedef struct {
+	/**
+	 * Offset of the frame header relative to the beginning of the file.
+	 */
+	uint64_t offset;
+
+	/**
+	 * Index of the first sample (per channel) in the frame.
+	 */
+	uint64_t first_sample;
+} fx_flac_index_entry_t;
+
+/**
+ * Returns the size of an index with room for the given number of entries in
+ * bytes.
+ */
+FX_EXPORT uint32_t fx_flac_index_size(uint32_t max_entries);
+
+/**
+ * Initializes an empty index at the given memory location.
+ *
+ * @param mem is a pointer at the memory region at which the index should be
+ * stored. Must be at least fx_flac_index_size(max_entries) bytes large. May be
+ * NULL, in which case NULL is returned.
+ * @param max_entries is the maximum number of entries. Once the index is full,
+ * further frames are not indexed.
+ * @param spacing is the minimum distance between two entries in samples (per
+ * channel). Zero indexes every frame; larger values allow to cover longer
+ * recordings with the same number of entries.
+ * @return a pointer at the index instance.
+ */
+FX_EXPORT fx_flac_index_t *fx_flac_index_init(void *mem, uint32_t max_entries,
+                                              uint32_t spacing);
+
+/**
+ * Macro which calls malloc to allocate memory for a new index. The returned
+ * pointer must be freed using free.
+ */
+#define FX_FLAC_INDEX_ALLOC(max_entries, spacing)               \
+	fx_flac_index_init(malloc(fx_flac_index_size(max_entries)), \
+	                   (max_entries), (spacing))
+
+/**
+ * Returns the offset relative to the beginning of the file at which the data
+ * passed to the next call to fx_flac_index_extend() must start. May only be
+ * called by the thread extending the index.
+ */
+FX_EXPORT uint64_t fx_flac_index_get_offset(const fx_flac_index_t *idx);
+
+/**
+ * Parses the frame headers in the given data and appends them to the index.
+ * Bytes at the end of the buffer that may belong to an incomplete frame
+ * header are not consumed; pass them again once more data is available.
+ * Frames following a frame with a damaged header are only indexed once the
+ * next frame confirms them. Only a single thread may extend the index at a
+ * time.
+ *
+ * @param idx is the index instance.
+ * @param buf is a pointer at the file contents starting at the offset
+ * returned by fx_flac_index_get_offset().
+ * @param len is a pointer at the number of valid bytes in buf. Contains the
+ * number of bytes that were consumed after the function returns.
+ * @return false if the file is not a FLAC file, true otherwise.
+ */
+FX_EXPORT bool fx_flac_index_extend(fx_flac_index_t *idx, const uint8_t *buf,
+                                    uint32_t *len);
+
+/**
+ * Returns the number of entries in the index. Safe to call while another
+ * thread extends the index; all entries up to the returned count are valid.
+ */
+FX_EXPORT uint32_t fx_flac_index_get_count(const fx_flac_index_t *idx);
+
+/**
+ * Searches the index for the last frame starting at or before the given
+ * sample using bisection. To seek, flush the decoder using fx_flac_flush(),
+ * pass it the file contents starting at entry->offset and select the sample
+ * using fx_flac_set_range(). Safe to call while another thread extends the
+ * index.
+ *
+ * @param idx is the index instance.
+ * @param sample is the index of the sample (per channel) to look up.
+ * @param entry is a pointer at the structure receiving the entry.
+ * @return false if the index contains no frame starting at or before the
+ * sample.
+ */
+FX_EXPORT bool fx_flac_index_lookup(const fx_flac_index_t *idx,
+                                    uint64_t sample,
+                                    fx_flac_index_entry_t *entry);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* FOXEN_FLAC_INDEX_H */
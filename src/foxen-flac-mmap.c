@@ -0,0 +1,696 @@
+/*
+ *  libfoxenflac -- Tiny FLAC Decoder Library
+ *  Copyright (C) 2018-2025  Andreas Stöckel
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#define _DEFAULT_SOURCE /* for madvise() */
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "foxen-flac-mmap.h"
+
+/******************************************************************************
+ * Internal structs                                                           *
+ ******************************************************************************/
+
+/**
+ * Number of samples that are decoded at once if the output needs to be
+ * converted to a format other than FLAC_PCM_S32.
+ */
+#define FX_FLAC_MMAP_CONV_BUF_SIZE 4096U
+
+/**
+ * Number of bytes read from the beginning of a file by fx_flac_probe_file().
+ */
+#define FX_FLAC_MMAP_PROBE_SIZE 64U
+
+/**
+ * Number of bytes read from the end of a file by fx_flac_probe_file() if the
+ * maximum frame size is unknown. The size of trailing tags is added to this.
+ */
+#define FX_FLAC_MMAP_PROBE_TAIL_SIZE 65536U
+
+/**
+ * Size of the region in bytes below which fx_flac_mmap_seek() switches from
+ * bisection to scanning the frame headers one by one.
+ */
+#define FX_FLAC_MMAP_SEEK_SPAN 8192U
+
+/**
+ * Maximum size of a frame header in bytes.
+ */
+#define FX_FLAC_MMAP_MAX_HEADER_SIZE 16U
+
+/**
+ * Private definition of the fx_flac_mmap structure.
+ */
+struct fx_flac_mmap {
+	/**
+	 * Pointer at the beginning of the mapped file. May be NULL if the file is
+	 * empty.
+	 */
+	const uint8_t *data;
+
+	/**
+	 * Size of the mapped file in bytes.
+	 */
+	size_t size;
+
+	/**
+	 * Current read position in the mapped file.
+	 */
+	size_t pos;
+
+	/**
+	 * Decoder instance.
+	 */
+	fx_flac_t *flac;
+
+	/**
+	 * Stream format and offset of the first frame, used for seeking. The
+	 * offset is zero until determined by fx_flac_mmap_seek().
+	 */
+	fx_flac_probe_t info;
+	size_t audio_start;
+
+	/**
+	 * Optional cache used by fx_flac_mmap_read_range(); not owned by this
+	 * instance.
+	 */
+	fx_flac_cache_t *cache;
+
+	/**
+	 * First sample of the frame the decoder continues with. Only valid if
+	 * positioned is true, i.e. if the decoder has not been used by
+	 * fx_flac_mmap_read() since the last call to fx_flac_mmap_seek().
+	 */
+	uint64_t next_sample;
+	bool positioned;
+
+	/**
+	 * Set once fx_flac_mmap_seek() withdrew the advice to read the mapping
+	 * sequentially.
+	 */
+	bool random_access;
+
+	/**
+	 * Buffer holding the last frame decoded by fx_flac_mmap_read_range(), the
+	 * index of its first sample, its length per channel and its number of
+	 * channels. Allocated on first use.
+	 */
+	int32_t *frame_buf;
+	uint64_t frame_first;
+	uint32_t frame_len;
+	uint8_t frame_channels;
+
+	/**
+	 * Buffer used for format conversion.
+	 */
+	int32_t conv_buf[FX_FLAC_MMAP_CONV_BUF_SIZE];
+};
+
+/******************************************************************************
+ * PRIVATE CODE                                                               *
+ ******************************************************************************/
+
+static void _fx_flac_mmap_convert(const int32_t *src, void *tar, uint32_t n,
+                                  fx_flac_pcm_format_t fmt) {
+	switch (fmt) {
+		case FLAC_PCM_S32: {
+			int32_t *tar_s32 = (int32_t *)tar;
+			for (uint32_t i = 0U; i < n; i++) {
+				tar_s32[i] = src[i];
+			}
+			break;
+		}
+		case FLAC_PCM_S16: {
+			int16_t *tar_s16 = (int16_t *)tar;
+			for (uint32_t i = 0U; i < n; i++) {
+				tar_s16[i] = (int16_t)(src[i] >> 16);
+			}
+			break;
+		}
+		case FLAC_PCM_F32: {
+			float *tar_f32 = (float *)tar;
+			for (uint32_t i = 0U; i < n; i++) {
+				tar_f32[i] = (float)src[i] * (1.0f / 2147483648.0f);
+			}
+			break;
+		}
+	}
+}
+
+/**
+ * Passes data to the decoder until it has read the metadata. Returns false if
+ * the file is not a valid FLAC file.
+ */
+static bool _fx_flac_mmap_read_metadata(fx_flac_mmap_t *f) {
+	fx_flac_state_t state = fx_flac_get_state(f->flac);
+	while (state != FLAC_ERR && state < FLAC_END_OF_METADATA &&
+	       f->pos < f->size) {
+		uint32_t in_len = (f->size - f->pos > UINT32_MAX)
+		                      ? UINT32_MAX
+		                      : (uint32_t)(f->size - f->pos);
+		state =
+		    fx_flac_process(f->flac, f->data + f->pos, &in_len, NULL, NULL);
+		f->pos += in_len;
+	}
+	return state != FLAC_ERR && state >= FLAC_END_OF_METADATA;
+}
+
+/**
+ * Determines the stream format and the offset of the first frame by walking
+ * the metadata block headers.
+ */
+static bool _fx_flac_mmap_locate_audio(fx_flac_mmap_t *f) {
+	if (f->audio_start > 0U) {
+		return true;
+	}
+	const uint32_t len =
+	    (f->size > UINT32_MAX) ? UINT32_MAX : (uint32_t)f->size;
+	const uint32_t res = f->data ? fx_flac_probe(f->data, len, &f->info) : 0U;
+	if (res == 0U || res > len) {
+		return false;
+	}
+	size_t pos = (size_t)f->info.offset + 4U;
+	bool is_last = false;
+	while (!is_last) {
+		if (f->size - pos < 4U) {
+			return false;
+		}
+		const uint8_t *hdr = f->data + pos;
+		is_last = hdr[0] & 0x80U;
+		pos += 4U + (((size_t)hdr[1] << 16U) | ((size_t)hdr[2] << 8U) | hdr[3]);
+		if (pos > f->size) {
+			return false;
+		}
+	}
+	f->audio_start = pos;
+	return true;
+}
+
+/**
+ * Searches for the first plausible frame header in [begin, end), i.e. one
+ * that does not precede the frame at which the search region starts. Returns
+ * the offset of the frame or end if there is none.
+ */
+static size_t _fx_flac_mmap_find_frame(const fx_flac_mmap_t *f, size_t begin,
+                                       size_t end, uint64_t min_sample,
+                                       uint64_t *first_sample) {
+	while (begin < end) {
+		size_t len = end - begin + FX_FLAC_MMAP_MAX_HEADER_SIZE;
+		if (len > f->size - begin) {
+			len = f->size - begin;
+		}
+		if (len > INT32_MAX) {
+			len = INT32_MAX;
+		}
+		const int32_t offs = fx_flac_find_frame(
+		    f->data + begin, (uint32_t)len, &f->info, first_sample, NULL);
+		if (offs < 0 || (size_t)offs >= end - begin) {
+			break;
+		}
+		begin += (size_t)offs;
+		if (*first_sample >= min_sample &&
+		    (f->info.n_samples == 0U || *first_sample < f->info.n_samples)) {
+			return begin;
+		}
+		begin++; /* False positive, continue searching */
+	}
+	return end;
+}
+
+/**
+ * Decodes the frame containing the given sample into the frame buffer and
+ * adds it to the cache. Returns false if the sample cannot be decoded; in
+ * that case ok is set to false if the stream is invalid or memory allocation
+ * failed, as opposed to the sample being past the end of the stream.
+ */
+static bool _fx_flac_mmap_decode_frame(fx_flac_mmap_t *f, uint64_t sample,
+                                       bool *ok) {
+	/* Continue decoding if the sample is close ahead, otherwise seek */
+	const uint32_t max_block = f->info.max_block_size ? f->info.max_block_size
+	                                                  : FLAC_MAX_BLOCK_SIZE;
+	if (!f->positioned || sample < f->next_sample ||
+	    sample - f->next_sample >= max_block) {
+		if (!fx_flac_mmap_seek(f, sample)) {
+			*ok = false;
+			return false;
+		}
+	}
+	const uint32_t cap = max_block * FLAC_MAX_CHANNEL_COUNT;
+	if (!f->frame_buf) {
+		f->frame_buf = (int32_t *)malloc(cap * sizeof(int32_t));
+		if (!f->frame_buf) {
+			*ok = false;
+			return false;
+		}
+	}
+
+	/* The frame buffer is overwritten below */
+	f->frame_len = 0U;
+
+	bool retried = false;
+	while (true) {
+		/* Decode the next frame. Samples concealing a gap in front of the
+		   frame are discarded along with the frame itself. */
+		fx_flac_state_t state;
+		uint32_t n_vals = 0U;
+		do {
+			const bool gap = fx_flac_get_state(f->flac) == FLAC_FRAME_CORRUPT;
+			const size_t rem = f->size - f->pos;
+			uint32_t in_len = (rem > UINT32_MAX) ? UINT32_MAX : (uint32_t)rem;
+			uint32_t n = cap - n_vals;
+			state = fx_flac_process(f->flac, f->data + f->pos, &in_len,
+			                        gap ? NULL : f->frame_buf + n_vals,
+			                        gap ? NULL : &n);
+			f->pos += in_len;
+			n_vals += gap ? 0U : n;
+			if ((state == FLAC_ERR) ||
+			    ((state != FLAC_END_OF_FRAME) && (in_len == 0U) &&
+			     (gap || n == 0U))) {
+				f->positioned = false;
+				*ok = state != FLAC_ERR;
+				return false; /* End of the stream */
+			}
+		} while (state != FLAC_END_OF_FRAME);
+		fx_flac_frame_info_t info;
+		fx_flac_get_frame_info(f->flac, &info);
+		f->next_sample = info.first_sample + info.n_samples;
+
+		/* If the frame containing the sample was discarded, decode it again
+		   without the preceding gap */
+		if ((n_vals == 0U) || (info.n_samples == 0U)) {
+			if (sample < f->next_sample) {
+				if (retried) {
+					return false;
+				}
+				if (!fx_flac_mmap_seek(f, sample)) {
+					*ok = false;
+					return false;
+				}
+				retried = true;
+			}
+			continue;
+		}
+		f->frame_first = info.first_sample;
+		f->frame_len = info.n_samples;
+		f->frame_channels = (uint8_t)(n_vals / info.n_samples);
+		if (f->cache) {
+			fx_flac_cache_insert(f->cache, f->frame_first, f->frame_len,
+			                     f->frame_channels, f->frame_buf);
+		}
+		if (sample < f->next_sample) {
+			return sample >= info.first_sample; /* Lost if in a gap */
+		}
+	}
+}
+
+/******************************************************************************
+ * PUBLIC API                                                                 *
+ ******************************************************************************/
+
+uint32_t fx_flac_pcm_format_size(fx_flac_pcm_format_t fmt) {
+	switch (fmt) {
+		case FLAC_PCM_S32:
+			return sizeof(int32_t);
+		case FLAC_PCM_S16:
+			return sizeof(int16_t);
+		case FLAC_PCM_F32:
+			return sizeof(float);
+	}
+	return 0U;
+}
+
+fx_flac_mmap_t *fx_flac_open_mmap(const char *path) {
+	fx_flac_mmap_t *f = (fx_flac_mmap_t *)malloc(sizeof(fx_flac_mmap_t));
+	if (!f) {
+		return NULL;
+	}
+	f->data = NULL;
+	f->size = 0U;
+	f->pos = 0U;
+	f->audio_start = 0U;
+	f->cache = NULL;
+	f->positioned = false;
+	f->random_access = false;
+	f->frame_buf = NULL;
+	f->frame_first = 0U;
+	f->frame_len = 0U;
+	f->flac = FX_FLAC_ALLOC_DEFAULT();
+	if (!f->flac) {
+		goto fail;
+	}
+
+	/* Open the file and map it into memory */
+	int fd = open(path, O_RDONLY);
+	if (fd < 0) {
+		goto fail;
+	}
+	struct stat st;
+	if (fstat(fd, &st) != 0) {
+		close(fd);
+		goto fail;
+	}
+	f->size = (size_t)st.st_size;
+	if (f->size > 0U) {
+		void *data = mmap(NULL, f->size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (data == MAP_FAILED) {
+			close(fd);
+			goto fail;
+		}
+		/* Unless the caller seeks, we read the file front to back exactly
+		   once; allow the kernel to read ahead aggressively and to drop
+		   pages behind us. See fx_flac_mmap_seek(). */
+		madvise(data, f->size, MADV_SEQUENTIAL);
+		f->data = (const uint8_t *)data;
+	}
+	close(fd); /* The mapping stays valid after closing the file */
+	return f;
+
+fail:
+	fx_flac_close_mmap(f);
+	return NULL;
+}
+
+void fx_flac_close_mmap(fx_flac_mmap_t *f) {
+	if (!f) {
+		return;
+	}
+	if (f->data) {
+		munmap((void *)f->data, f->size);
+	}
+	free(f->frame_buf);
+	free(f->flac);
+	free(f);
+}
+
+fx_flac_t *fx_flac_mmap_get_decoder(fx_flac_mmap_t *f) { return f->flac; }
+
+void fx_flac_mmap_set_cache(fx_flac_mmap_t *f, fx_flac_cache_t *cache) {
+	f->cache = cache;
+}
+
+fx_flac_state_t fx_flac_mmap_read(fx_flac_mmap_t *f, void *out,
+                                  uint32_t *out_len,
+                                  fx_flac_pcm_format_t fmt) {
+	const uint32_t smpl_size = fx_flac_pcm_format_size(fmt);
+	fx_flac_state_t state = fx_flac_get_state(f->flac);
+	uint32_t n_written = 0U;
+	f->positioned = false;
+	while (n_written < *out_len) {
+		/* Pass the remaining mapping to the decoder in a single span; the
+		   decoder interface is limited to 32-bit lengths. Decode as many
+		   frames as fit into the output buffer at once. */
+		const size_t rem = f->size - f->pos;
+		uint32_t in_len = (rem > UINT32_MAX) ? UINT32_MAX : (uint32_t)rem;
+
+		/* Decode directly into the target memory if no conversion is
+		   needed, otherwise use the conversion buffer */
+		uint32_t n_out = *out_len - n_written;
+		int32_t *tar = f->conv_buf;
+		if (fmt == FLAC_PCM_S32) {
+			tar = (int32_t *)out + n_written;
+		} else if (n_out > FX_FLAC_MMAP_CONV_BUF_SIZE) {
+			n_out = FX_FLAC_MMAP_CONV_BUF_SIZE;
+		}
+		state = fx_flac_process_batch(f->flac, f->data + f->pos, &in_len,
+		                              tar, &n_out, NULL);
+		f->pos += in_len;
+		if (fmt != FLAC_PCM_S32) {
+			_fx_flac_mmap_convert(
+			    tar, (uint8_t *)out + (size_t)n_written * smpl_size, n_out,
+			    fmt);
+		}
+		n_written += n_out;
+
+		/* Abort on error or once the end of the stream has been reached */
+		if ((state == FLAC_ERR) || ((in_len == 0U) && (n_out == 0U))) {
+			break;
+		}
+	}
+	*out_len = n_written;
+	return state;
+}
+
+bool fx_flac_mmap_seek(fx_flac_mmap_t *f, uint64_t sample) {
+	if (!_fx_flac_mmap_locate_audio(f) || !_fx_flac_mmap_read_metadata(f)) {
+		return false;
+	}
+
+	/* Seeking, e.g. when scrubbing using fx_flac_mmap_read_range(), revisits
+	   regions of the file; sequential read-ahead and dropping pages behind
+	   the read position would work against that */
+	if (!f->random_access) {
+		madvise((void *)f->data, f->size, MADV_NORMAL);
+		f->random_access = true;
+	}
+
+	/* Bisect the file; lo always points at a frame starting at or before the
+	   requested sample, frames at or after hi start after it */
+	size_t lo = f->audio_start, hi = f->size;
+	uint64_t lo_sample = 0U, first_sample;
+	while (hi - lo > FX_FLAC_MMAP_SEEK_SPAN) {
+		const size_t mid = lo + (hi - lo) / 2U;
+		const size_t pos =
+		    _fx_flac_mmap_find_frame(f, mid, hi, lo_sample, &first_sample);
+		if (pos < hi && first_sample <= sample) {
+			lo = pos;
+			lo_sample = first_sample;
+		} else {
+			hi = mid;
+		}
+	}
+
+	/* Scan the remaining frame headers */
+	while (true) {
+		const size_t pos = _fx_flac_mmap_find_frame(f, lo + 1U, f->size,
+		                                            lo_sample, &first_sample);
+		if (pos == f->size || first_sample > sample) {
+			break;
+		}
+		lo = pos;
+		lo_sample = first_sample;
+	}
+
+	/* Continue decoding at the frame */
+	fx_flac_flush(f->flac);
+	f->pos = lo;
+	f->next_sample = lo_sample;
+	f->positioned = true;
+	return true;
+}
+
+bool fx_flac_mmap_read_range(fx_flac_mmap_t *f, uint64_t sample, void *out,
+                             uint32_t *out_len, fx_flac_pcm_format_t fmt) {
+	const uint32_t smpl_size = fx_flac_pcm_format_size(fmt);
+	uint32_t n_written = 0U;
+	bool ok = _fx_flac_mmap_locate_audio(f) && _fx_flac_mmap_read_metadata(f);
+	while (ok && n_written < *out_len) {
+		uint8_t *tar = (uint8_t *)out + (size_t)n_written * smpl_size;
+
+		/* Serve the samples from the cache if possible */
+		if (f->cache) {
+			uint32_t n = *out_len - n_written;
+			int32_t *buf = f->conv_buf;
+			if (fmt == FLAC_PCM_S32) {
+				buf = (int32_t *)tar;
+			} else if (n > FX_FLAC_MMAP_CONV_BUF_SIZE) {
+				n = FX_FLAC_MMAP_CONV_BUF_SIZE;
+			}
+			uint8_t cc;
+			if (fx_flac_cache_read(f->cache, sample, buf, &n, &cc)) {
+				if (n == 0U) {
+					break; /* Not enough space for another sample */
+				}
+				if (fmt != FLAC_PCM_S32) {
+					_fx_flac_mmap_convert(buf, tar, n, fmt);
+				}
+				n_written += n;
+				sample += n / cc;
+				continue;
+			}
+		}
+
+		/* Otherwise decode the frame unless it is still in the frame buffer,
+		   e.g. because the last read ended within it, and copy the samples
+		   from there */
+		const bool buffered = (sample >= f->frame_first) &&
+		                      (sample - f->frame_first < f->frame_len);
+		if (!buffered && !_fx_flac_mmap_decode_frame(f, sample, &ok)) {
+			break;
+		}
+		const uint8_t cc = f->frame_channels;
+		const uint32_t offs = (uint32_t)(sample - f->frame_first);
+		uint32_t n = f->frame_len - offs;
+		if (n > (*out_len - n_written) / cc) {
+			n = (*out_len - n_written) / cc;
+		}
+		if (n == 0U) {
+			break;
+		}
+		_fx_flac_mmap_convert(f->frame_buf + (size_t)offs * cc, tar, n * cc,
+		                      fmt);
+		n_written += n * cc;
+		sample += n;
+	}
+	*out_len = n_written;
+	return ok;
+}
+
+bool fx_flac_decode_file(const char *path, fx_flac_pcm_format_t fmt,
+                         fx_flac_pcm_t *pcm) {
+	const uint32_t smpl_size = fx_flac_pcm_format_size(fmt);
+	pcm->data = NULL;
+	pcm->n_samples = 0U;
+	pcm->format = fmt;
+
+	fx_flac_mmap_t *f = fx_flac_open_mmap(path);
+	if (!f) {
+		return false;
+	}
+
+	/* Decode the metadata to find out how large the output buffer must be */
+	fx_flac_state_t state;
+	if (!_fx_flac_mmap_read_metadata(f)) {
+		goto fail;
+	}
+	pcm->sample_rate =
+	    (uint32_t)fx_flac_get_streaminfo(f->flac, FLAC_KEY_SAMPLE_RATE);
+	pcm->n_channels =
+	    (uint8_t)fx_flac_get_streaminfo(f->flac, FLAC_KEY_N_CHANNELS);
+	pcm->sample_size =
+	    (uint8_t)fx_flac_get_streaminfo(f->flac, FLAC_KEY_SAMPLE_SIZE);
+
+	/* The number of samples is optional in the STREAMINFO header; start with
+	   a reasonably sized buffer and grow it if necessary. */
+	uint64_t cap = (uint64_t)fx_flac_get_streaminfo(f->flac,
+	                                                FLAC_KEY_N_SAMPLES) *
+	               pcm->n_channels;
+	if (cap == 0U) {
+		cap = 1U << 20U;
+	}
+	uint64_t len = 0U;
+	while (true) {
+		if (len == cap) {
+			cap += cap / 4U + FX_FLAC_MMAP_CONV_BUF_SIZE;
+			void *data = realloc(pcm->data, cap * smpl_size);
+			if (!data) {
+				goto fail;
+			}
+			pcm->data = data;
+		} else if (!pcm->data) {
+			pcm->data = malloc(cap * smpl_size);
+			if (!pcm->data) {
+				goto fail;
+			}
+		}
+		const uint64_t rem = cap - len;
+		uint32_t n_out = (rem > UINT32_MAX) ? UINT32_MAX : (uint32_t)rem;
+		const uint32_t n_out_max = n_out;
+		state = fx_flac_mmap_read(
+		    f, (uint8_t *)pcm->data + (size_t)len * smpl_size, &n_out, fmt);
+		len += n_out;
+		if (state == FLAC_ERR) {
+			goto fail;
+		}
+		if (n_out < n_out_max) {
+			break; /* Reached the end of the file */
+		}
+	}
+	if (len < cap) { /* Release memory that was not needed */
+		void *data = realloc(pcm->data, (len > 0U ? len : 1U) * smpl_size);
+		if (data) {
+			pcm->data = data;
+		}
+	}
+	pcm->n_samples = pcm->n_channels ? (len / pcm->n_channels) : 0U;
+	fx_flac_close_mmap(f);
+	return true;
+
+fail:
+	free(pcm->data);
+	pcm->data = NULL;
+	fx_flac_close_mmap(f);
+	return false;
+}
+
+bool fx_flac_probe_file(const char *path, bool scan_tail,
+                        fx_flac_probe_t *info) {
+	int fd = open(path, O_RDONLY);
+	if (fd < 0) {
+		return false;
+	}
+
+	/* Read the beginning of the file; skip large ID3v2 tags by seeking */
+	uint8_t buf[FX_FLAC_MMAP_PROBE_SIZE];
+	off_t pos = 0;
+	bool ok = false;
+	while (true) {
+		const ssize_t n = pread(fd, buf, sizeof(buf), pos);
+		const uint32_t res =
+		    (n > 0) ? fx_flac_probe(buf, (uint32_t)n, info) : 0U;
+		if (res > 0U && res <= (uint32_t)n) {
+			ok = true;
+			break;
+		}
+		if (res == 0U || info->offset == 0U) {
+			break; /* Not a FLAC file, or the file is too short */
+		}
+		pos += info->offset;
+	}
+	info->offset = (uint32_t)pos + (ok ? info->offset : 0U);
+
+	/* Parse the last frame header if the number of samples is unknown */
+	struct stat st;
+	if (ok && scan_tail && info->n_samples == 0U && fstat(fd, &st) == 0) {
+		const off_t begin = (off_t)info->offset + 42;
+
+		/* Size the window from the tags following the last frame first;
+		   APEv2 tags in particular may be arbitrarily large */
+		uint8_t trailer[FLAC_PROBE_TRAILER_SIZE];
+		off_t len = (st.st_size - begin < (off_t)sizeof(trailer))
+		                ? st.st_size - begin
+		                : (off_t)sizeof(trailer);
+		uint64_t trailer_size = 0U;
+		if (len > 0 &&
+		    pread(fd, trailer, (size_t)len, st.st_size - len) == len) {
+			trailer_size = fx_flac_probe_trailer(trailer, (uint32_t)len);
+		}
+		len = (info->max_frame_size ? (off_t)info->max_frame_size
+		                            : FX_FLAC_MMAP_PROBE_TAIL_SIZE) +
+		      (off_t)trailer_size;
+		if (len > st.st_size - begin) {
+			len = st.st_size - begin;
+		}
+		if (len > (off_t)UINT32_MAX) {
+			len = (off_t)UINT32_MAX;
+		}
+		uint8_t *tail = (len > 0) ? (uint8_t *)malloc((size_t)len) : NULL;
+		if (tail && pread(fd, tail, (size_t)len, st.st_size - len) == len) {
+			fx_flac_probe_tail(tail, (uint32_t)len, info);
+		}
+		free(tail);
+	}
+	close(fd);
+	return ok;
+}
@@ -0,0 +1,232 @@
+/*
+ *  libfoxenflac -- Tiny FLAC Decoder Library
+ *  Copyright (C) 2018-2025  Andreas Stöckel
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file foxen-flac-mmap.h
+ *
+ * Optional helper for decoding local FLAC files. The file is memory-mapped and
+ * passed to the decoder as a single contiguous span. In contrast to the core
+ * decoder in foxen-flac.c this module depends on the C library and POSIX
+ * (mmap(), madvise(), malloc()).
+ *
+ * @author Andreas Stöckel
+ */
+
+#ifndef FOXEN_FLAC_MMAP_H
+#define FOXEN_FLAC_MMAP_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "foxen-flac-cache.h"
+#include "foxen-flac.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Opaque struct representing a memory-mapped FLAC file.
+ */
+struct fx_flac_mmap;
+
+/**
+ * Typedef for the fx_flac_mmap struct.
+ */
+typedef struct fx_flac_mmap fx_flac_mmap_t;
+
+/**
+ * Sample formats the helper functions can produce.
+ */
+typedef enum {
+	/**
+	 * Signed 32-bit integers. Same as the output of fx_flac_process(), i.e.
+	 * samples are shifted such that they use the entire 32-bit range.
+	 */
+	FLAC_PCM_S32 = 0,
+
+	/**
+	 * Signed 16-bit integers. Samples with a larger bit depth are truncated.
+	 */
+	FLAC_PCM_S16 = 1,
+
+	/**
+	 * 32-bit floating point numbers in the range [-1, 1).
+	 */
+	FLAC_PCM_F32 = 2
+} fx_flac_pcm_format_t;
+
+/**
+ * Structure describing an entire decoded file as returned by
+ * fx_flac_decode_file().
+ */
+typedef struct {
+	/**
+	 * Interleaved samples in the requested format. Must be freed by the caller
+	 * using free().
+	 */
+	void *data;
+
+	/**
+	 * Total number of samples per channel stored in data.
+	 */
+	uint64_t n_samples;
+
+	/**
+	 * Sample rate as stored in the STREAMINFO header.
+	 */
+	uint32_t sample_rate;
+
+	/**
+	 * Number of interleaved channels.
+	 */
+	uint8_t n_channels;
+
+	/**
+	 * Bit depth of the original stream.
+	 */
+	uint8_t sample_size;
+
+	/**
+	 * Format of the samples stored in data.
+	 */
+	fx_flac_pcm_format_t format;
+} fx_flac_pcm_t;
+
+/**
+ * Returns the size of a single sample in the given format in bytes.
+ */
+FX_EXPORT uint32_t fx_flac_pcm_format_size(fx_flac_pcm_format_t fmt);
+
+/**
+ * Maps the given file into memory and allocates a decoder that is able to
+ * decode any valid FLAC stream.
+ *
+ * @param path is the path of the file that should be opened.
+ * @return a pointer at the new instance or NULL if the file cannot be opened
+ * or mapped, or if memory allocation fails.
+ */
+FX_EXPORT fx_flac_mmap_t *fx_flac_open_mmap(const char *path);
+
+/**
+ * Unmaps the file and frees all memory associated with the given instance.
+ * Does nothing if f is NULL.
+ */
+FX_EXPORT void fx_flac_close_mmap(fx_flac_mmap_t *f);
+
+/**
+ * Returns the decoder instance used internally, for example to query the
+ * stream metadata using fx_flac_get_streaminfo().
+ */
+FX_EXPORT fx_flac_t *fx_flac_mmap_get_decoder(fx_flac_mmap_t *f);
+
+/**
+ * Decodes samples from the mapped file.
+ *
+ * @param f is the memory-mapped file instance.
+ * @param out is the memory region the samples are written to.
+ * @param out_len is a pointer at the number of samples (not bytes) that fit
+ * into out. After the function returns, contains the number of samples that
+ * have actually been written. This is only smaller than the original value
+ * if the end of the file has been reached.
+ * @param fmt is the format in which the samples should be written.
+ * @return the current state of the decoder. Returns FLAC_ERR if the stream
+ * is corrupt beyond repair.
+ */
+FX_EXPORT fx_flac_state_t fx_flac_mmap_read(fx_flac_mmap_t *f, void *out,
+                                            uint32_t *out_len,
+                                            fx_flac_pcm_format_t fmt);
+
+/**
+ * Seeks to the frame containing the given sample by bisecting the mapped
+ * file on the frame headers, without decoding the frames in between.
+ * Subsequent calls to fx_flac_mmap_read() start with the first sample of that
+ * frame; combine this with fx_flac_set_range() for sample-exact output, e.g.
+ * to extract a single track, see fx_flac_cuesheet_track_range(). The first
+ * call withdraws the advice to the kernel to read the file sequentially.
+ *
+ * @param f is the memory-mapped file instance.
+ * @param sample is the index of the sample (per channel) to seek to.
+ * @return false if the file is not a valid FLAC file.
+ */
+FX_EXPORT bool fx_flac_mmap_seek(fx_flac_mmap_t *f, uint64_t sample);
+
+/**
+ * Attaches a frame cache to the instance, see fx_flac_mmap_read_range(). The
+ * instance does not take ownership of the cache; pass NULL to detach it.
+ */
+FX_EXPORT void fx_flac_mmap_set_cache(fx_flac_mmap_t *f,
+                                      fx_flac_cache_t *cache);
+
+/**
+ * Decodes samples starting at the given sample, e.g. while scrubbing. Frames
+ * found in the cache attached using fx_flac_mmap_set_cache() are copied from
+ * there; all other frames are decoded as a whole and added to the cache.
+ * Consecutive reads continue decoding where the last read stopped, otherwise
+ * the file is bisected, see fx_flac_mmap_seek(). Must not be combined with
+ * fx_flac_set_range() on the underlying decoder.
+ *
+ * @param f is the memory-mapped file instance.
+ * @param sample is the index of the first sample (per channel) to read.
+ * @param out is the memory region the samples are written to.
+ * @param out_len is a pointer at the number of samples (not bytes) that fit
+ * into out. After the function returns, contains the number of samples that
+ * have actually been written. This is only smaller than the original value
+ * if the end of the file has been reached or the requested samples are lost
+ * because of a corrupt frame.
+ * @param fmt is the format in which the samples should be written.
+ * @return false if the file is not a valid FLAC file or memory allocation
+ * failed, true otherwise.
+ */
+FX_EXPORT bool fx_flac_mmap_read_range(fx_flac_mmap_t *f, uint64_t sample,
+                                       void *out, uint32_t *out_len,
+                                       fx_flac_pcm_format_t fmt);
+
+/**
+ * Decodes an entire file into a newly allocated buffer.
+ *
+ * @param path is the path of the FLAC file that should be decoded.
+ * @param fmt is the format the samples should be converted to.
+ * @param pcm is a pointer at the structure that receives the decoded data.
+ * pcm->data must be freed by the caller.
+ * @return true if the file was decoded successfully, false otherwise. In the
+ * latter case pcm->data is NULL.
+ */
+FX_EXPORT bool fx_flac_decode_file(const char *path, fx_flac_pcm_format_t fmt,
+                                   fx_flac_pcm_t *pcm);
+
+/**
+ * Reads the format and duration of a FLAC file without decoding it, see
+ * fx_flac_probe(). Only the first bytes of the file are read; if the
+ * STREAMINFO block does not state the number of samples and scan_tail is
+ * true, the end of the file is read as well, see fx_flac_probe_tail().
+ *
+ * @param path is the path of the FLAC file that should be probed.
+ * @param scan_tail if true, determines the number of samples from the last
+ * frame if necessary.
+ * @param info is a pointer at the structure receiving the stream format.
+ * info->offset is the offset of the stream within the file.
+ * @return true if the file is a FLAC file, false otherwise.
+ */
+FX_EXPORT bool fx_flac_probe_file(const char *path, bool scan_tail,
+                                  fx_flac_probe_t *info);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* FOXEN_FLAC_MMAP_H */
@@ -0,0 +1,482 @@
+/*
+ *  libfoxenflac -- Tiny FLAC Decoder Library
+ *  Copyright (C) 2018-2025  Andreas Stöckel
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "foxen-flac-ogg.h"
+
+/******************************************************************************
+ * Constants defined in the Ogg and FLAC-to-Ogg mapping specifications        *
+ ******************************************************************************/
+
+/**
+ * Size of the fixed part of the Ogg page header, including the capture
+ * pattern "OggS".
+ */
+#define OGG_HEADER_SIZE 27U
+
+/**
+ * Offset of the CRC checksum in the page header. The CRC is computed with
+ * these four bytes set to zero.
+ */
+#define OGG_HEADER_CRC_OFFS 22U
+
+/**
+ * Size of the header prepended to the first packet of an Ogg FLAC stream. The
+ * header consists of the byte 0x7F, the ASCII string "FLAC", a major and minor
+ * version number, and the number of header packets as 16-bit integer. It is
+ * followed by the native FLAC stream signature "fLaC" and the STREAMINFO
+ * metadata block.
+ */
+#define OGG_FLAC_MAPPING_SIZE 9U
+
+typedef enum {
+	OGG_HEADER_TYPE_CONTINUED = 0x01,
+	OGG_HEADER_TYPE_BOS = 0x02,
+	OGG_HEADER_TYPE_EOS = 0x04
+} fx_flac_ogg_header_type_t;
+
+/**
+ * CRC-32 lookup table for the polynomial 0x04C11DB7 used by Ogg.
+ */
+static const uint32_t fx_flac_ogg_crc32_table_[256] = {
+    0x00000000, 0x04c11db7, 0x09823b6e, 0x0d4326d9, 0x130476dc, 0x17c56b6b,
+    0x1a864db2, 0x1e475005, 0x2608edb8, 0x22c9f00f, 0x2f8ad6d6, 0x2b4bcb61,
+    0x350c9b64, 0x31cd86d3, 0x3c8ea00a, 0x384fbdbd, 0x4c11db70, 0x48d0c6c7,
+    0x4593e01e, 0x4152fda9, 0x5f15adac, 0x5bd4b01b, 0x569796c2, 0x52568b75,
+    0x6a1936c8, 0x6ed82b7f, 0x639b0da6, 0x675a1011, 0x791d4014, 0x7ddc5da3,
+    0x709f7b7a, 0x745e66cd, 0x9823b6e0, 0x9ce2ab57, 0x91a18d8e, 0x95609039,
+    0x8b27c03c, 0x8fe6dd8b, 0x82a5fb52, 0x8664e6e5, 0xbe2b5b58, 0xbaea46ef,
+    0xb7a96036, 0xb3687d81, 0xad2f2d84, 0xa9ee3033, 0xa4ad16ea, 0xa06c0b5d,
+    0xd4326d90, 0xd0f37027, 0xddb056fe, 0xd9714b49, 0xc7361b4c, 0xc3f706fb,
+    0xceb42022, 0xca753d95, 0xf23a8028, 0xf6fb9d9f, 0xfbb8bb46, 0xff79a6f1,
+    0xe13ef6f4, 0xe5ffeb43, 0xe8bccd9a, 0xec7dd02d, 0x34867077, 0x30476dc0,
+    0x3d044b19, 0x39c556ae, 0x278206ab, 0x23431b1c, 0x2e003dc5, 0x2ac12072,
+    0x128e9dcf, 0x164f8078, 0x1b0ca6a1, 0x1fcdbb16, 0x018aeb13, 0x054bf6a4,
+    0x0808d07d, 0x0cc9cdca, 0x7897ab07, 0x7c56b6b0, 0x71159069, 0x75d48dde,
+    0x6b93dddb, 0x6f52c06c, 0x6211e6b5, 0x66d0fb02, 0x5e9f46bf, 0x5a5e5b08,
+    0x571d7dd1, 0x53dc6066, 0x4d9b3063, 0x495a2dd4, 0x44190b0d, 0x40d816ba,
+    0xaca5c697, 0xa864db20, 0xa527fdf9, 0xa1e6e04e, 0xbfa1b04b, 0xbb60adfc,
+    0xb6238b25, 0xb2e29692, 0x8aad2b2f, 0x8e6c3698, 0x832f1041, 0x87ee0df6,
+    0x99a95df3, 0x9d684044, 0x902b669d, 0x94ea7b2a, 0xe0b41de7, 0xe4750050,
+    0xe9362689, 0xedf73b3e, 0xf3b06b3b, 0xf771768c, 0xfa325055, 0xfef34de2,
+    0xc6bcf05f, 0xc27dede8, 0xcf3ecb31, 0xcbffd686, 0xd5b88683, 0xd1799b34,
+    0xdc3abded, 0xd8fba05a, 0x690ce0ee, 0x6dcdfd59, 0x608edb80, 0x644fc637,
+    0x7a089632, 0x7ec98b85, 0x738aad5c, 0x774bb0eb, 0x4f040d56, 0x4bc510e1,
+    0x46863638, 0x42472b8f, 0x5c007b8a, 0x58c1663d, 0x558240e4, 0x51435d53,
+    0x251d3b9e, 0x21dc2629, 0x2c9f00f0, 0x285e1d47, 0x36194d42, 0x32d850f5,
+    0x3f9b762c, 0x3b5a6b9b, 0x0315d626, 0x07d4cb91, 0x0a97ed48, 0x0e56f0ff,
+    0x1011a0fa, 0x14d0bd4d, 0x19939b94, 0x1d528623, 0xf12f560e, 0xf5ee4bb9,
+    0xf8ad6d60, 0xfc6c70d7, 0xe22b20d2, 0xe6ea3d65, 0xeba91bbc, 0xef68060b,
+    0xd727bbb6, 0xd3e6a601, 0xdea580d8, 0xda649d6f, 0xc423cd6a, 0xc0e2d0dd,
+    0xcda1f604, 0xc960ebb3, 0xbd3e8d7e, 0xb9ff90c9, 0xb4bcb610, 0xb07daba7,
+    0xae3afba2, 0xaafbe615, 0xa7b8c0cc, 0xa379dd7b, 0x9b3660c6, 0x9ff77d71,
+    0x92b45ba8, 0x9675461f, 0x8832161a, 0x8cf30bad, 0x81b02d74, 0x857130c3,
+    0x5d8a9099, 0x594b8d2e, 0x5408abf7, 0x50c9b640, 0x4e8ee645, 0x4a4ffbf2,
+    0x470cdd2b, 0x43cdc09c, 0x7b827d21, 0x7f436096, 0x7200464f, 0x76c15bf8,
+    0x68860bfd, 0x6c47164a, 0x61043093, 0x65c52d24, 0x119b4be9, 0x155a565e,
+    0x18197087, 0x1cd86d30, 0x029f3d35, 0x065e2082, 0x0b1d065b, 0x0fdc1bec,
+    0x3793a651, 0x3352bbe6, 0x3e119d3f, 0x3ad08088, 0x2497d08d, 0x2056cd3a,
+    0x2d15ebe3, 0x29d4f654, 0xc5a92679, 0xc1683bce, 0xcc2b1d17, 0xc8ea00a0,
+    0xd6ad50a5, 0xd26c4d12, 0xdf2f6bcb, 0xdbee767c, 0xe3a1cbc1, 0xe760d676,
+    0xea23f0af, 0xeee2ed18, 0xf0a5bd1d, 0xf464a0aa, 0xf9278673, 0xfde69bc4,
+    0x89b8fd09, 0x8d79e0be, 0x803ac667, 0x84fbdbd0, 0x9abc8bd5, 0x9e7d9662,
+    0x933eb0bb, 0x97ffad0c, 0xafb010b1, 0xab710d06, 0xa6322bdf, 0xa2f33668,
+    0xbcb4666d, 0xb8757bda, 0xb5365d03, 0xb1f740b4};
+
+/******************************************************************************
+ * Internal state machine enums and structs                                   *
+ ******************************************************************************/
+
+typedef enum {
+	OGG_CAPTURE = 0,
+	OGG_HEADER = 1,
+	OGG_SEGMENTS = 2,
+	OGG_MAPPING = 3,
+	OGG_PAYLOAD = 4,
+	OGG_SKIP = 5
+} fx_flac_ogg_state_t;
+
+/**
+ * Private definition of the fx_flac_ogg structure.
+ */
+struct fx_flac_ogg {
+	/**
+	 * Decoder the payload is passed to.
+	 */
+	fx_flac_t *flac;
+
+	/**
+	 * Granule position of the last page belonging to the FLAC stream.
+	 */
+	int64_t granule;
+
+	/**
+	 * Running CRC of the current page.
+	 */
+	uint32_t crc;
+
+	/**
+	 * Serial number of the logical FLAC bitstream.
+	 */
+	uint32_t serial;
+
+	/**
+	 * Number of pages with invalid CRC.
+	 */
+	uint32_t n_crc_errors;
+
+	/**
+	 * Number of payload bytes remaining in the current page.
+	 */
+	uint32_t payload_rem;
+
+	/**
+	 * Current state of the page parser.
+	 */
+	fx_flac_ogg_state_t state;
+
+	/**
+	 * Set to true once the first page of the FLAC stream has been found.
+	 */
+	bool has_serial;
+
+	/**
+	 * Read cursor within hdr, segs or mapping.
+	 */
+	uint8_t cur;
+
+	/**
+	 * Copy of the current page header.
+	 */
+	uint8_t hdr[OGG_HEADER_SIZE];
+
+	/**
+	 * Copy of the mapping header at the beginning of the first packet.
+	 */
+	uint8_t mapping[OGG_FLAC_MAPPING_SIZE];
+};
+
+/******************************************************************************
+ * PRIVATE CODE                                                               *
+ ******************************************************************************/
+
+#define FX_FLAC_OGG_ALIGN 8U
+
+#define FX_FLAC_OGG_ALIGN_ADDR(P)                              \
+	((fx_flac_ogg_t *)(((uintptr_t)(P) + FX_FLAC_OGG_ALIGN - 1U) & \
+	                   (~(uintptr_t)(FX_FLAC_OGG_ALIGN - 1U))))
+
+static inline uint32_t _fx_flac_ogg_crc32(uint32_t crc, uint8_t byte) {
+	return (crc << 8U) ^ fx_flac_ogg_crc32_table_[((crc >> 24U) ^ byte) & 0xFF];
+}
+
+static inline uint32_t _fx_flac_ogg_read_le(const uint8_t *p, uint8_t n) {
+	uint32_t res = 0U;
+	for (uint8_t i = n; i > 0U; i--) {
+		res = (res << 8U) | p[i - 1U];
+	}
+	return res;
+}
+
+static inline int64_t _fx_flac_ogg_read_granule(const uint8_t *hdr) {
+	return (int64_t)(((uint64_t)_fx_flac_ogg_read_le(hdr + 10U, 4U) << 32U) |
+	                 _fx_flac_ogg_read_le(hdr + 6U, 4U));
+}
+
+/**
+ * Called once the fixed-size part of the page header has been read. Decides
+ * whether the page belongs to the FLAC stream.
+ */
+static void _fx_flac_ogg_handle_header(fx_flac_ogg_t *ogg) {
+	const uint8_t *hdr = ogg->hdr;
+	const uint32_t serial = _fx_flac_ogg_read_le(hdr + 14U, 4U);
+	ogg->cur = 0U;
+	ogg->payload_rem = 0U;
+	if (hdr[4] != 0U) { /* Unsupported stream structure version */
+		ogg->state = OGG_CAPTURE;
+		return;
+	}
+	ogg->state = (hdr[26] > 0U) ? OGG_SEGMENTS : OGG_SKIP;
+
+	/* Adopt the serial of the first logical stream that starts with the
+	   FLAC mapping header; this is checked in the OGG_MAPPING state. */
+	if (!ogg->has_serial && (hdr[5] & OGG_HEADER_TYPE_BOS)) {
+		ogg->serial = serial;
+	}
+}
+
+/**
+ * Called at the end of a page, checks the page CRC.
+ */
+static void _fx_flac_ogg_handle_page_end(fx_flac_ogg_t *ogg, bool is_flac) {
+	ogg->state = OGG_CAPTURE;
+	ogg->cur = 0U;
+	if (!is_flac) {
+		return;
+	}
+	if (ogg->crc != _fx_flac_ogg_read_le(ogg->hdr + OGG_HEADER_CRC_OFFS, 4U)) {
+		/* The payload has already been passed to the decoder; drop whatever
+		   frame it is currently working on. Frames completed on this page
+		   were checked against the FLAC frame CRC. */
+		ogg->n_crc_errors++;
+		fx_flac_flush(ogg->flac);
+		return;
+	}
+	const int64_t granule = _fx_flac_ogg_read_granule(ogg->hdr);
+	if (granule != FLAC_OGG_NO_GRANULE) {
+		ogg->granule = granule;
+	}
+	if (ogg->hdr[5] & OGG_HEADER_TYPE_EOS) {
+		ogg->has_serial = false; /* A chained stream may follow */
+	}
+}
+
+/******************************************************************************
+ * PUBLIC API                                                                 *
+ ******************************************************************************/
+
+uint32_t fx_flac_ogg_size(void) {
+	return sizeof(fx_flac_ogg_t) + FX_FLAC_OGG_ALIGN;
+}
+
+fx_flac_ogg_t *fx_flac_ogg_init(void *mem, fx_flac_t *flac) {
+	if (mem) {
+		fx_flac_ogg_t *ogg = FX_FLAC_OGG_ALIGN_ADDR(mem);
+		ogg->flac = flac;
+		ogg->has_serial = false;
+		fx_flac_ogg_seek_reset(ogg);
+		ogg->granule = FLAC_OGG_NO_GRANULE;
+		ogg->n_crc_errors = 0U;
+	}
+	return (fx_flac_ogg_t *)mem;
+}
+
+void fx_flac_ogg_reset(fx_flac_ogg_t *ogg) {
+	ogg = FX_FLAC_OGG_ALIGN_ADDR(ogg);
+	fx_flac_reset(ogg->flac);
+	fx_flac_ogg_init(ogg, ogg->flac);
+}
+
+void fx_flac_ogg_seek_reset(fx_flac_ogg_t *ogg) {
+	ogg = FX_FLAC_OGG_ALIGN_ADDR(ogg);
+	fx_flac_flush(ogg->flac);
+	ogg->state = OGG_CAPTURE;
+	ogg->cur = 0U;
+	ogg->crc = 0U;
+	ogg->payload_rem = 0U;
+}
+
+int64_t fx_flac_ogg_get_granule(const fx_flac_ogg_t *ogg) {
+	return FX_FLAC_OGG_ALIGN_ADDR(ogg)->granule;
+}
+
+uint32_t fx_flac_ogg_get_crc_errors(const fx_flac_ogg_t *ogg) {
+	return FX_FLAC_OGG_ALIGN_ADDR(ogg)->n_crc_errors;
+}
+
+fx_flac_state_t fx_flac_ogg_process(fx_flac_ogg_t *ogg, const uint8_t *in,
+                                    uint32_t *in_len, int32_t *out,
+                                    uint32_t *out_len) {
+	ogg = FX_FLAC_OGG_ALIGN_ADDR(ogg);
+
+	const uint8_t *src = in, *src_end = in + *in_len;
+	const uint32_t out_cap = out_len ? *out_len : 0U;
+	uint32_t out_cur = 0U;
+	fx_flac_state_t state = fx_flac_get_state(ogg->flac);
+	bool done = false;
+	while (!done) {
+		/* Let the decoder process the data it has buffered internally once we
+		   ran out of input */
+		if (src == src_end) {
+			uint32_t n_in = 0U, n_out = out_cap - out_cur;
+			state = fx_flac_process(ogg->flac, src, &n_in,
+			                        out ? out + out_cur : NULL,
+			                        out_len ? &n_out : NULL);
+			out_cur += out_len ? n_out : 0U;
+			break;
+		}
+
+		const bool is_flac =
+		    ogg->has_serial &&
+		    (_fx_flac_ogg_read_le(ogg->hdr + 14U, 4U) == ogg->serial);
+		switch (ogg->state) {
+			case OGG_CAPTURE: {
+				/* Search for the "OggS" capture pattern */
+				const uint8_t byte = *(src++);
+				if (byte == (uint8_t)("OggS"[ogg->cur])) {
+					ogg->hdr[ogg->cur++] = byte;
+					if (ogg->cur == 4U) {
+						ogg->state = OGG_HEADER;
+					}
+				} else {
+					ogg->cur = (byte == 'O') ? 1U : 0U;
+				}
+				break;
+			}
+			case OGG_HEADER:
+				ogg->hdr[ogg->cur++] = *(src++);
+				if (ogg->cur == OGG_HEADER_SIZE) {
+					/* Compute the CRC of the header with zeroed CRC field */
+					uint32_t crc = 0U;
+					for (uint8_t i = 0U; i < OGG_HEADER_SIZE; i++) {
+						const bool is_crc = (i >= OGG_HEADER_CRC_OFFS) &&
+						                    (i < OGG_HEADER_CRC_OFFS + 4U);
+						crc = _fx_flac_ogg_crc32(crc, is_crc ? 0U : ogg->hdr[i]);
+					}
+					ogg->crc = crc;
+					_fx_flac_ogg_handle_header(ogg);
+				}
+				break;
+			case OGG_SEGMENTS: {
+				/* The lacing values sum up to the payload size */
+				const uint8_t lacing = *(src++);
+				ogg->crc = _fx_flac_ogg_crc32(ogg->crc, lacing);
+				ogg->payload_rem += lacing;
+				if (++ogg->cur == ogg->hdr[26]) {
+					ogg->cur = 0U;
+					if (!ogg->has_serial &&
+					    (ogg->hdr[5] & OGG_HEADER_TYPE_BOS)) {
+						ogg->state = OGG_MAPPING;
+					} else {
+						ogg->state = is_flac ? OGG_PAYLOAD : OGG_SKIP;
+					}
+				}
+				break;
+			}
+			case OGG_MAPPING: {
+				/* Read and check the mapping header preceding the native FLAC
+				   stream signature in the first packet */
+				if (ogg->payload_rem == 0U) {
+					_fx_flac_ogg_handle_page_end(ogg, false);
+					break;
+				}
+				const uint8_t byte = *(src++);
+				ogg->crc = _fx_flac_ogg_crc32(ogg->crc, byte);
+				ogg->payload_rem--;
+				ogg->mapping[ogg->cur++] = byte;
+				if (ogg->cur == OGG_FLAC_MAPPING_SIZE) {
+					const uint8_t *m = ogg->mapping;
+					if (m[0] == 0x7FU && m[1] == 'F' && m[2] == 'L' &&
+					    m[3] == 'A' && m[4] == 'C' && m[5] == 1U) {
+						/* Start of a new (possibly chained) FLAC stream */
+						fx_flac_reset(ogg->flac);
+						state = fx_flac_get_state(ogg->flac);
+						ogg->has_serial = true;
+						ogg->state = OGG_PAYLOAD;
+					} else {
+						ogg->state = OGG_SKIP;
+					}
+				}
+				break;
+			}
+			case OGG_PAYLOAD: {
+				if (ogg->payload_rem == 0U) {
+					_fx_flac_ogg_handle_page_end(ogg, true);
+					break;
+				}
+
+				/* Pass as much of the payload to the decoder as possible;
+				   packet boundaries are not tracked, the decoder finds the
+				   frames by their sync code */
+				const uint32_t src_rem = src_end - src;
+				const uint32_t n_in_max =
+				    (src_rem < ogg->payload_rem) ? src_rem : ogg->payload_rem;
+				uint32_t n_in = n_in_max, n_out = out_cap - out_cur;
+				state = fx_flac_process(ogg->flac, src, &n_in,
+				                        out ? out + out_cur : NULL,
+				                        out_len ? &n_out : NULL);
+				out_cur += out_len ? n_out : 0U;
+				for (uint32_t i = 0U; i < n_in; i++) {
+					ogg->crc = _fx_flac_ogg_crc32(ogg->crc, src[i]);
+				}
+				src += n_in;
+				ogg->payload_rem -= n_in;
+				if (ogg->payload_rem == 0U) {
+					_fx_flac_ogg_handle_page_end(ogg, true);
+				}
+
+				/* Return to the caller whenever the decoder would */
+				done = (n_in < n_in_max) || (state == FLAC_ERR) ||
+				       (state == FLAC_END_OF_METADATA) ||
+				       (state == FLAC_END_OF_FRAME) ||
+				       (state == FLAC_FRAME_CORRUPT) ||
+				       (out_len && out_cur == out_cap);
+				break;
+			}
+			case OGG_SKIP: {
+				/* Skip pages belonging to other logical streams */
+				if (ogg->payload_rem == 0U) {
+					_fx_flac_ogg_handle_page_end(ogg, false);
+					break;
+				}
+				const uint32_t src_rem = src_end - src;
+				const uint32_t n =
+				    (src_rem < ogg->payload_rem) ? src_rem : ogg->payload_rem;
+				src += n;
+				ogg->payload_rem -= n;
+				break;
+			}
+		}
+	}
+
+	/* Report the number of bytes read and samples written */
+	*in_len = src - in;
+	if (out_len) {
+		*out_len = out_cur;
+	}
+	return state;
+}
+
+int32_t fx_flac_ogg_find_page(const uint8_t *buf, uint32_t len,
+                              int64_t *granule) {
+	for (uint32_t i = 0U; i + OGG_HEADER_SIZE <= len && i < INT32_MAX; i++) {
+		const uint8_t *hdr = buf + i;
+		if (hdr[0] != 'O' || hdr[1] != 'g' || hdr[2] != 'g' || hdr[3] != 'S' ||
+		    hdr[4] != 0U) {
+			continue;
+		}
+
+		/* Check the CRC if the entire page is available */
+		const uint32_t n_segs = hdr[26];
+		uint32_t size = OGG_HEADER_SIZE + n_segs;
+		if (i + size <= len) {
+			for (uint32_t j = 0U; j < n_segs; j++) {
+				size += hdr[OGG_HEADER_SIZE + j];
+			}
+		}
+		if (i + size <= len) {
+			uint32_t crc = 0U;
+			for (uint32_t j = 0U; j < size; j++) {
+				const bool is_crc = (j >= OGG_HEADER_CRC_OFFS) &&
+				                    (j < OGG_HEADER_CRC_OFFS + 4U);
+				crc = _fx_flac_ogg_crc32(crc, is_crc ? 0U : hdr[j]);
+			}
+			if (crc != _fx_flac_ogg_read_le(hdr + OGG_HEADER_CRC_OFFS, 4U)) {
+				continue; /* Not a valid page, just a spurious "OggS" */
+			}
+		}
+		if (granule) {
+			*granule = _fx_flac_ogg_read_granule(hdr);
+		}
+		return (int32_t)i;
+	}
+	return -1;
+}
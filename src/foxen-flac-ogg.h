@@ -0,0 +1,160 @@
+/*
+ *  libfoxenflac -- Tiny FLAC Decoder Library
+ *  Copyright (C) 2018-2025  Andreas Stöckel
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file foxen-flac-ogg.h
+ *
+ * Demultiplexer for Ogg-encapsulated FLAC streams (usually stored in files
+ * with the extension ".oga"). The demultiplexer parses the Ogg pages and
+ * passes the packet payloads to fx_flac_process() without copying them. Just
+ * like the decoder itself, this code does not depend on the C library.
+ *
+ * @author Andreas Stöckel
+ */
+
+#ifndef FOXEN_FLAC_OGG_H
+#define FOXEN_FLAC_OGG_H
+
+#include <stdint.h>
+
+#include "foxen-flac.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Value returned by fx_flac_ogg_get_granule() if no granule position is
+ * known.
+ */
+#define FLAC_OGG_NO_GRANULE (-1)
+
+/**
+ * Opaque struct representing an Ogg FLAC demultiplexer.
+ */
+struct fx_flac_ogg;
+
+/**
+ * Typedef for the fx_flac_ogg struct.
+ */
+typedef struct fx_flac_ogg fx_flac_ogg_t;
+
+/**
+ * Returns the size of the Ogg demultiplexer instance in bytes.
+ */
+FX_EXPORT uint32_t fx_flac_ogg_size(void);
+
+/**
+ * Initializes the Ogg demultiplexer at the given memory location.
+ *
+ * @param mem is a pointer at the memory region at which the demultiplexer
+ * should store its private data. Must be at least fx_flac_ogg_size() bytes
+ * large. May be NULL, in which case NULL is returned.
+ * @param flac is the FLAC decoder instance the packet payloads are passed to.
+ * The demultiplexer does not take ownership of the decoder.
+ * @return a pointer at the demultiplexer instance.
+ */
+FX_EXPORT fx_flac_ogg_t *fx_flac_ogg_init(void *mem, fx_flac_t *flac);
+
+/**
+ * Macro which calls malloc to allocate memory for a new fx_flac_ogg instance
+ * wrapping the given decoder. The returned pointer must be freed using free.
+ */
+#define FX_FLAC_OGG_ALLOC(flac) \
+	fx_flac_ogg_init(malloc(fx_flac_ogg_size()), (flac))
+
+/**
+ * Resets the demultiplexer and the underlying FLAC decoder.
+ */
+FX_EXPORT void fx_flac_ogg_reset(fx_flac_ogg_t *ogg);
+
+/**
+ * Prepares the demultiplexer for reading data from a new position within the
+ * same stream, for example after seeking to an offset determined using
+ * fx_flac_ogg_find_page(). The underlying decoder is flushed, see
+ * fx_flac_flush().
+ */
+FX_EXPORT void fx_flac_ogg_seek_reset(fx_flac_ogg_t *ogg);
+
+/**
+ * Returns the granule position of the last Ogg page belonging to the FLAC
+ * stream for which the header has been read. For FLAC, the granule position
+ * corresponds to the number of samples per channel up to and including the
+ * last frame completed on that page.
+ *
+ * @return the granule position or FLAC_OGG_NO_GRANULE if no page with a valid
+ * granule position has been read.
+ */
+FX_EXPORT int64_t fx_flac_ogg_get_granule(const fx_flac_ogg_t *ogg);
+
+/**
+ * Returns the number of pages that were discarded because their CRC checksum
+ * did not match.
+ */
+FX_EXPORT uint32_t fx_flac_ogg_get_crc_errors(const fx_flac_ogg_t *ogg);
+
+/**
+ * Decodes the given Ogg FLAC data. This function has the same semantics as
+ * fx_flac_process(); it returns whenever the underlying decoder transitions
+ * to a relevant state.
+ *
+ * The demultiplexer does not reassemble packets. Since the instance has a
+ * fixed size and frames may span several pages, the payloads of consecutive
+ * pages are concatenated and passed to the decoder as they arrive, which
+ * finds the frames by their sync code just like in a native FLAC stream.
+ * Consequently, audio data reaches the decoder before the CRC of the
+ * surrounding page can be checked. If the page CRC does not match, the
+ * decoder is flushed and resynchronises with the next frame; frames that
+ * ended on the damaged page have already been passed the FLAC frame CRC.
+ * Applications that must not output data from damaged pages should buffer
+ * complete pages, reassemble the packets themselves, and pass each of them to
+ * fx_flac_decode_packet() instead.
+ *
+ * @param ogg is the demultiplexer instance.
+ * @param in is a pointer at the encoded bytestream.
+ * @param in_len is a pointer at the number of valid bytes in "in". Contains
+ * the number of bytes that were actually read after the function returns.
+ * @param out is a pointer at the output buffer, see fx_flac_process().
+ * @param out_len is a pointer at the number of samples that fit into "out".
+ * Contains the number of samples written after the function returns.
+ * @return the current state of the underlying decoder.
+ */
+FX_EXPORT fx_flac_state_t fx_flac_ogg_process(fx_flac_ogg_t *ogg,
+                                              const uint8_t *in,
+                                              uint32_t *in_len, int32_t *out,
+                                              uint32_t *out_len);
+
+/**
+ * Searches the given buffer for the first Ogg page header. This can be used
+ * to implement bisection search on the granule position. If the buffer
+ * contains the entire page, the page CRC is checked as well.
+ *
+ * @param buf is the buffer that should be searched.
+ * @param len is the length of the buffer in bytes.
+ * @param granule is a pointer at a variable receiving the granule position of
+ * the page. May be NULL.
+ * @return the offset of the page header within buf, or -1 if no page header
+ * was found.
+ */
+FX_EXPORT int32_t fx_flac_ogg_find_page(const uint8_t *buf, uint32_t len,
+                                        int64_t *granule);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* FOXEN_FLAC_OGG_H */
@@ -25,10 +25,28 @@
 
 #if 0
 /* Set FX_FLAC_NO_CRC if you control the input data and already performed other
-   integrity checks. This makes the decoder significantly faster. */
+   integrity checks. This makes the decoder significantly faster. This only
+   changes the default CRC mode of new instances; the mode can still be
+   changed at runtime using fx_flac_set_crc_mode(). */
 #define FX_FLAC_NO_CRC
 #endif
 
+#if 0
+/* Set FX_FLAC_NO_SIMD to disable the SSE2/AVX2 kernels used for stereo
+   decorrelation and for interleaving stereo, 5.1 and 7.1 streams. The
+   portable C code is used in this case. */
+#define FX_FLAC_NO_SIMD
+#endif
+
+#if defined(__SSE2__) && !defined(FX_FLAC_NO_SIMD)
+#define FX_FLAC_SSE2
+#include <emmintrin.h>
+#endif
+#if defined(__AVX2__) && !defined(FX_FLAC_NO_SIMD)
+#define FX_FLAC_AVX2
+#include <immintrin.h>
+#endif
+
 /******************************************************************************
  * CODE MERGED FROM OTHER LIBFOXEN PROJECTS                                   *
  ******************************************************************************/
@@ -544,10 +562,10 @@ typedef enum {
 	SS_16BIT = 4,
 	SS_20BIT = 5,
 	SS_24BIT = 6,
-	SS_RESERVED_2 = 7
+	SS_32BIT = 7
 } fx_flac_sample_size_t;
 
-static const int8_t fx_flac_sample_sizes_[] = {0, 8, 12, -1, 16, 20, 24, -1};
+static const int8_t fx_flac_sample_sizes_[] = {0, 8, 12, -1, 16, 20, 24, 32};
 
 typedef enum {
 	SFT_CONSTANT,
@@ -563,6 +581,48 @@ typedef enum {
 	RES_RESERVED_2 = 3
 } fx_flac_residual_method_t;
 
+/**
+ * Speaker positions; used to compute the downmix presets.
+ */
+typedef enum {
+	SPK_MONO = 0,
+	SPK_FRONT_LEFT = 1,
+	SPK_FRONT_RIGHT = 2,
+	SPK_FRONT_CENTER = 3,
+	SPK_LFE = 4,
+	SPK_BACK_LEFT = 5,
+	SPK_BACK_RIGHT = 6,
+	SPK_BACK_CENTER = 7,
+	SPK_SIDE_LEFT = 8,
+	SPK_SIDE_RIGHT = 9
+} fx_flac_speaker_t;
+
+/**
+ * Speaker positions of the channels for each channel count, in the channel
+ * order defined by the FLAC specification.
+ */
+static const uint8_t fx_flac_channel_layouts_[8][8] = {
+    {SPK_MONO},
+    {SPK_FRONT_LEFT, SPK_FRONT_RIGHT},
+    {SPK_FRONT_LEFT, SPK_FRONT_RIGHT, SPK_FRONT_CENTER},
+    {SPK_FRONT_LEFT, SPK_FRONT_RIGHT, SPK_BACK_LEFT, SPK_BACK_RIGHT},
+    {SPK_FRONT_LEFT, SPK_FRONT_RIGHT, SPK_FRONT_CENTER, SPK_BACK_LEFT,
+     SPK_BACK_RIGHT},
+    {SPK_FRONT_LEFT, SPK_FRONT_RIGHT, SPK_FRONT_CENTER, SPK_LFE, SPK_BACK_LEFT,
+     SPK_BACK_RIGHT},
+    {SPK_FRONT_LEFT, SPK_FRONT_RIGHT, SPK_FRONT_CENTER, SPK_LFE,
+     SPK_BACK_CENTER, SPK_SIDE_LEFT, SPK_SIDE_RIGHT},
+    {SPK_FRONT_LEFT, SPK_FRONT_RIGHT, SPK_FRONT_CENTER, SPK_LFE, SPK_BACK_LEFT,
+     SPK_BACK_RIGHT, SPK_SIDE_LEFT, SPK_SIDE_RIGHT}};
+
+/**
+ * Gain of each speaker position in the left and right channel of the stereo
+ * downmix (ITU-R BS.775) in Q2.14 format; 11585 corresponds to -3 dB.
+ */
+static const int16_t fx_flac_stereo_gains_[10][2] = {
+    {16384, 16384}, {16384, 0}, {0, 16384}, {11585, 11585}, {0, 0},
+    {11585, 0},     {0, 11585}, {11585, 11585}, {11585, 0}, {0, 11585}};
+
 /******************************************************************************
  * Structs defined in the flac format specification                           *
  ******************************************************************************/
@@ -639,6 +699,25 @@ typedef struct {
 	 */
 	uint8_t wasted_bits;
 
+	/**
+	 * Number of bits per encoded sample. Computed once when reading the
+	 * subframe header from the sample size, the wasted bits and the channel
+	 * assignment.
+	 */
+	uint8_t bps;
+
+	/**
+	 * True if the decoded samples require 33 bits, i.e. this is the side
+	 * channel of a 32-bit stream.
+	 */
+	bool wide;
+
+	/**
+	 * True if this subframe is excluded by the channel mask and is only
+	 * parsed, but not reconstructed.
+	 */
+	bool skip;
+
 	/**
 	 * Number of bits used to encode the linear predictor coefficients.
 	 */
@@ -694,6 +773,7 @@ typedef enum {
 	FLAC_METADATA_HEADER = 200,
 	FLAC_METADATA_SKIP = 201,
 	FLAC_METADATA_SINFO = 202,
+	FLAC_METADATA_CUESHEET = 203,
 	FLAC_FRAME_SYNC = 300,
 	FLAC_FRAME_HEADER = 400,
 	FLAC_FRAME_HEADER_SYNC_INFO = 401,
@@ -716,10 +796,40 @@ typedef enum {
 	FLAC_SUBFRAME_FINALIZE = 515
 } fx_flac_private_state_t;
 
+/**
+ * Record of the CUESHEET metadata block that is currently being parsed.
+ */
+typedef enum {
+	FLAC_CUE_HEADER = 0,
+	FLAC_CUE_TRACK = 1,
+	FLAC_CUE_INDEX = 2,
+	FLAC_CUE_DONE = 3
+} fx_flac_cue_record_t;
+
+/**
+ * Sizes of the records in the CUESHEET metadata block in bytes.
+ */
+#define FX_FLAC_CUE_HEADER_SIZE 396U
+#define FX_FLAC_CUE_TRACK_SIZE 36U
+#define FX_FLAC_CUE_INDEX_SIZE 12U
+
 /******************************************************************************
  * Internal structs                                                           *
  ******************************************************************************/
 
+/**
+ * Function performing stereo decorrelation and output alignment for an entire
+ * decoded stereo block in a single pass.
+ */
+typedef void (*fx_flac_stereo_kernel_t)(int32_t *blk1, int32_t *blk2,
+                                        uint32_t blk_size);
+
+/**
+ * Number of samples per channel retained from the end of the last valid frame
+ * for the FLAC_CONCEAL_REPEAT policy.
+ */
+#define FX_FLAC_CONCEAL_TAIL 256U
+
 /**
  * Private definition of the fx_flac structure.
  */
@@ -772,7 +882,7 @@ struct fx_flac {
 	/**
 	 * Current rice partition unary quotient counter.
 	 */
-	uint16_t rice_unary_counter;
+	uint32_t rice_unary_counter;
 
 	/**
 	 * Current channel. This is reset at frame boundaries.
@@ -784,6 +894,231 @@ struct fx_flac {
 	 */
 	uint16_t blk_cur;
 
+	/**
+	 * Checksums that should be verified. This setting is retained when the
+	 * decoder is reset.
+	 */
+	fx_flac_crc_mode_t crc_mode;
+
+	/**
+	 * Checksums verified for the current frame; copied from crc_mode while
+	 * searching for the frame so that changes only affect the next frame.
+	 */
+	fx_flac_crc_mode_t frame_crc_mode;
+
+	/**
+	 * If true, frames are only checked for integrity but not reconstructed.
+	 * This setting is retained when the decoder is reset.
+	 */
+	bool verify_only;
+
+	/**
+	 * True while fx_flac_decode_packet() is decoding a packet. Errors then
+	 * fail the packet instead of triggering a search for the next frame.
+	 */
+	bool packet;
+
+	/**
+	 * If true, the decoder does not expect the "fLaC" marker and metadata,
+	 * but starts searching for frames right away. Fields that the frame
+	 * headers refer to the STREAMINFO block are taken from headerless_rate and
+	 * headerless_size. These settings are retained when the decoder is reset.
+	 */
+	bool headerless;
+	uint32_t headerless_rate;
+	uint8_t headerless_size;
+
+	/**
+	 * Downmix applied in the output stage. This setting is retained when the
+	 * decoder is reset.
+	 */
+	fx_flac_downmix_t downmix;
+
+	/**
+	 * Number of input channels of the downmix matrix. For the presets, this
+	 * is the channel count the matrix was computed for, or zero if the matrix
+	 * must be recomputed.
+	 */
+	uint8_t mix_n_in;
+
+	/**
+	 * Number of output channels of the downmix matrix.
+	 */
+	uint8_t mix_n_out;
+
+	/**
+	 * Row-major downmix matrix in Q2.14 format.
+	 */
+	int16_t mix[FLAC_MAX_CHANNEL_COUNT * FLAC_MAX_CHANNEL_COUNT];
+
+	/**
+	 * Channels that should be reconstructed and written to the output, one
+	 * bit per channel. This setting is retained when the decoder is reset.
+	 */
+	uint8_t channel_mask;
+
+	/**
+	 * Range of samples written to the output, see fx_flac_set_range(). This
+	 * setting is retained when the decoder is reset.
+	 */
+	uint64_t range_first;
+	uint64_t range_end;
+
+	/**
+	 * Gain applied in the output stage in Q16.16 format. This setting is
+	 * retained when the decoder is reset.
+	 */
+	int32_t gain;
+
+	/**
+	 * Number of least significant bits cleared when requantising the output,
+	 * i.e. 32 minus the target bit depth, or zero if the output is not
+	 * requantised. This setting is retained when the decoder is reset.
+	 */
+	uint8_t dither_shift;
+
+	/**
+	 * Dither applied when requantising the output. This setting is retained
+	 * when the decoder is reset.
+	 */
+	fx_flac_dither_t dither;
+
+	/**
+	 * State of the pseudo-random number generator used for dithering.
+	 */
+	uint32_t dither_rng;
+
+	/**
+	 * Quantisation error of the last sample written to each output channel;
+	 * used for noise shaping.
+	 */
+	int64_t dither_err[FLAC_MAX_CHANNEL_COUNT];
+
+	/**
+	 * Number of samples per channel in a peak bucket, or zero if the peak
+	 * mode is disabled. This setting is retained when the decoder is reset.
+	 */
+	uint32_t peak_bucket;
+
+	/**
+	 * Caller-owned array the peak buckets are written to, its length and the
+	 * number of entries written so far.
+	 */
+	fx_flac_peak_t *peaks;
+	uint32_t peaks_len;
+	uint32_t peaks_cnt;
+
+	/**
+	 * Peak bucket that is currently being accumulated and the number of
+	 * samples per channel added to it.
+	 */
+	fx_flac_peak_t peak_acc[FLAC_MAX_CHANNEL_COUNT];
+	uint32_t peak_n;
+
+	/**
+	 * Caller-owned structure the CUESHEET block is written to, or NULL if
+	 * the block should be skipped. This setting is retained when the decoder
+	 * is reset.
+	 */
+	fx_flac_cuesheet_t *cuesheet;
+
+	/**
+	 * State of the CUESHEET parser: the record that is currently being read,
+	 * the byte position within that record, an accumulator for big-endian
+	 * integers, the number of remaining tracks and index points of the
+	 * current track, and whether the current track is stored.
+	 */
+	fx_flac_cue_record_t cue_rec;
+	uint16_t cue_pos;
+	uint64_t cue_acc;
+	uint8_t cue_tracks_rem;
+	uint8_t cue_indices_rem;
+	bool cue_store;
+
+	/**
+	 * Number of bytes consumed from the input since the last reset, not
+	 * counting the current call to fx_flac_process().
+	 */
+	uint64_t n_bytes_consumed;
+
+	/**
+	 * Input buffer passed to the current call to fx_flac_process(). Used to
+	 * compute the current position within the stream.
+	 */
+	const uint8_t *src_start;
+
+	/**
+	 * Location of the current frame in the stream.
+	 */
+	fx_flac_frame_info_t frame_info;
+
+	/**
+	 * Location of the last corrupt frame or gap in the stream. Reported while
+	 * the decoder is in the FLAC_FRAME_CORRUPT state.
+	 */
+	fx_flac_frame_info_t corrupt_info;
+
+	/**
+	 * Sample index, frame number and stream offset directly following the
+	 * last frame that was verified. Used to detect frames that were skipped
+	 * entirely because of a corrupt header. Only valid if has_next_frame is
+	 * true; the frame number is only meaningful for streams with fixed block
+	 * size.
+	 */
+	uint64_t next_sample;
+	uint64_t next_frame;
+	uint64_t next_offset;
+	bool has_next_frame;
+
+	/**
+	 * Frame number (fixed block size) or sample index (variable block size)
+	 * directly following the last candidate that was rejected as
+	 * discontinuous, and the offset of that candidate. A candidate that
+	 * continues it re-anchors the continuity check. Only valid if has_resync
+	 * is true.
+	 */
+	uint64_t resync_next;
+	uint64_t resync_offset;
+	bool has_resync;
+
+	/**
+	 * Number of rejected frame candidates since the last reset.
+	 */
+	fx_flac_sync_stats_t sync_stats;
+
+	/**
+	 * Policy used to fill gaps left by corrupt frames.
+	 */
+	fx_flac_conceal_t conceal;
+
+	/**
+	 * Number of replacement samples that remain to be generated for the
+	 * current gap, and position of the next sample relative to the beginning
+	 * of the gap.
+	 */
+	uint64_t conceal_rem;
+	uint64_t conceal_pos;
+
+	/**
+	 * Number of samples over which the repeated signal is faded out.
+	 */
+	uint32_t conceal_fade;
+
+	/**
+	 * Range of samples of the frame following the gap, restored once all
+	 * replacement samples have been written.
+	 */
+	uint16_t conceal_blk_begin;
+	uint16_t conceal_blk_end;
+
+	/**
+	 * Last samples of the last valid frame, repeated by FLAC_CONCEAL_REPEAT.
+	 * Holds FX_FLAC_CONCEAL_TAIL samples per channel; NULL for instances
+	 * initialized using fx_flac_init_planar().
+	 */
+	uint16_t tail_len;
+	int32_t *tailbuf;
+
 	/**
 	 * Variable holding the checksum computed when reading the frame_header.
 	 */
@@ -822,9 +1157,68 @@ struct fx_flac {
 	int32_t *qbuf;
 
 	/**
-	 * Structure holding the temporary/output buffers for each channel.
+	 * Bit 32 of the samples in the side channel of a 32-bit stereo stream.
+	 * Side channels carry one more bit than the stream itself; for 32-bit
+	 * streams the lower 32 bits are stored in the block buffer and the
+	 * 33rd bit is stored in this bit field.
+	 */
+	uint32_t *widebuf;
+
+	/**
+	 * Specialised post-processing function for the current frame, selected
+	 * once after reading the frame header. NULL if the generic code path
+	 * should be used.
+	 */
+	fx_flac_stereo_kernel_t stereo_kernel;
+
+	/**
+	 * If true, the gain and requantisation are applied to the decoded
+	 * channels of the current frame.
+	 */
+	bool output_stage;
+
+	/**
+	 * Channels of the current frame coded as constant subframes and their
+	 * values. The block buffers of these channels are only filled if needed.
+	 */
+	uint8_t const_mask;
+	int32_t const_val[FLAC_MAX_CHANNEL_COUNT];
+
+	/**
+	 * If true, all channels of the current frame are constant; const_val
+	 * holds the decorrelated output values and the block buffers are unused.
+	 */
+	bool frame_const;
+
+	/**
+	 * Range of samples of the current frame written to the output.
+	 */
+	uint16_t blk_begin;
+	uint16_t blk_end;
+
+	/**
+	 * If true, the current frame lies before the selected range and is only
+	 * parsed.
+	 */
+	bool frame_skip;
+
+	/**
+	 * If true, the frames are decoded into caller-owned buffers registered
+	 * using fx_flac_set_planar_output() and the output stage is skipped.
+	 */
+	bool planar;
+
+	/**
+	 * Buffers the current frame is decoded into, one per channel. Either
+	 * points at the internal buffers or at the caller-owned planar output.
 	 */
 	int32_t *blkbuf[FLAC_MAX_CHANNEL_COUNT];
+
+	/**
+	 * Internal per-channel buffers. All NULL if the instance was initialized
+	 * using fx_flac_init_planar().
+	 */
+	int32_t *blkbuf_own[FLAC_MAX_CHANNEL_COUNT];
 };
 
 /******************************************************************************
@@ -893,12 +1287,16 @@ static bool _fx_flac_decode_channel_count(
  * Decoding functions                                                         *
  ******************************************************************************/
 
+/* Left/right side decorrelation is computed modulo 2^32. The result always
+   fits into 32 bits, so this is correct even if the side channel of a 32-bit
+   stream requires 33 bits. */
+
 static inline void _fx_flac_post_process_left_side(int32_t *blk1, int32_t *blk2,
                                                    uint32_t blk_size) {
 	blk1 = (int32_t *)FX_ASSUME_ALIGNED(blk1);
 	blk2 = (int32_t *)FX_ASSUME_ALIGNED(blk2);
 	for (uint32_t i = 0U; i < blk_size; i++) {
-		blk2[i] = blk1[i] - blk2[i];
+		blk2[i] = (int32_t)((uint32_t)blk1[i] - (uint32_t)blk2[i]);
 	}
 }
 
@@ -908,7 +1306,7 @@ static inline void _fx_flac_post_process_right_side(int32_t *blk1,
 	blk1 = (int32_t *)FX_ASSUME_ALIGNED(blk1);
 	blk2 = (int32_t *)FX_ASSUME_ALIGNED(blk2);
 	for (uint32_t i = 0U; i < blk_size; i++) {
-		blk1[i] = blk1[i] + blk2[i];
+		blk1[i] = (int32_t)((uint32_t)blk1[i] + (uint32_t)blk2[i]);
 	}
 }
 
@@ -944,89 +1342,632 @@ static inline void _fx_flac_restore_lpc_signal(int32_t *blk, uint32_t blk_size,
 }
 
 /******************************************************************************
- * Stream utility functions and macros                                        *
+ * 33-bit side channel support                                                *
  ******************************************************************************/
 
-/* http://graphics.stanford.edu/~seander/bithacks.html#FixedSignExtend */
-#define SIGN_EXTEND(x, b) \
-	(int64_t)((x) ^ (1LU << ((b)-1U))) - (int64_t)(1LU << ((b)-1U))
+/* The side channel of a 32-bit stream is the only subframe requiring more
+   than 32 bits per sample. These functions operate on samples split into the
+   lower 32 bits stored in the block buffer and the 33rd bit stored in the
+   "wide" bit field. They are only used for those subframes, all other
+   subframes use the plain 32-bit code paths. */
+
+static inline int64_t _fx_flac_wide_get(const int32_t *blk,
+                                        const uint32_t *wide, uint32_t i) {
+	const uint64_t hi = (wide[i >> 5U] >> (i & 31U)) & 1U;
+	const uint64_t v = (hi << 32U) | (uint32_t)blk[i];
+	return (int64_t)(v ^ (1ULL << 32U)) - (int64_t)(1ULL << 32U);
+}
 
-#define ENSURE_BITS(n)                                 \
-	if (!fx_bitstream_can_read(&inst->bitstream, n)) { \
-		return false; /* Need more data */             \
+static inline void _fx_flac_wide_set(int32_t *blk, uint32_t *wide, uint32_t i,
+                                     int64_t v) {
+	const uint32_t mask = 1UL << (i & 31U);
+	blk[i] = (int32_t)(uint32_t)(uint64_t)v;
+	if (((uint64_t)v >> 32U) & 1U) {
+		wide[i >> 5U] |= mask;
+	} else {
+		wide[i >> 5U] &= ~mask;
 	}
+}
 
-#define READ_BITS(n)                                         \
-	(tmp_ = fx_bitstream_try_read_msb(&inst->bitstream, n)); \
-	if (tmp_ < 0) {                                          \
-		return false; /* Need more data */                   \
+static void _fx_flac_post_process_mid_side_wide(int32_t *blk1, int32_t *blk2,
+                                                const uint32_t *wide,
+                                                uint32_t blk_size) {
+	for (uint32_t i = 0U; i < blk_size; i++) {
+		const int64_t side = _fx_flac_wide_get(blk2, wide, i);
+		const int64_t mid = ((int64_t)blk1[i] * 2) | (side & 1);
+		blk1[i] = (int32_t)((mid + side) >> 1);
+		blk2[i] = (int32_t)((mid - side) >> 1);
 	}
+}
 
-#define READ_BITS_FAST(n) (tmp_ = fx_bitstream_read_msb(&inst->bitstream, n));
+static void _fx_flac_restore_lpc_signal_wide(int32_t *blk, uint32_t *wide,
+                                             uint32_t blk_size,
+                                             const int32_t *lpc_coeffs,
+                                             uint8_t lpc_order,
+                                             int8_t lpc_shift) {
+	for (uint32_t i = lpc_order; i < blk_size; i++) {
+		int64_t accu = 0;
+		for (uint8_t j = 0; j < lpc_order; j++) {
+			accu += (int64_t)lpc_coeffs[j] *
+			        _fx_flac_wide_get(blk, wide, i - j - 1);
+		}
+		_fx_flac_wide_set(blk, wide, i, (int64_t)blk[i] + (accu >> lpc_shift));
+	}
+}
 
-#define PEEK_BITS(n)                                         \
-	(tmp_ = fx_bitstream_try_peek_msb(&inst->bitstream, n)); \
-	if (tmp_ < 0) {                                          \
-		return false; /* Need more data */                   \
+static void _fx_flac_shift_wide(int32_t *blk, uint32_t *wide,
+                                uint32_t blk_size, uint8_t shift) {
+	for (uint32_t i = 0U; i < blk_size; i++) {
+		const int64_t v = _fx_flac_wide_get(blk, wide, i);
+		_fx_flac_wide_set(blk, wide, i, (int64_t)((uint64_t)v << shift));
+	}
+}
+
+/******************************************************************************
+ * Vector kernels                                                             *
+ ******************************************************************************/
+
+/* Thin abstraction over the widest available integer vector type. The macros
+   are only defined if SIMD support is enabled; all kernels fall back to plain
+   C loops for the remaining samples or if there is no SIMD support. */
+
+#if defined(FX_FLAC_AVX2)
+typedef __m256i fx_flac_vec_t;
+#define FX_FLAC_VEC_WIDTH 8U
+#define FX_FLAC_VEC(OP) _mm256_##OP
+#define FX_FLAC_VEC_LOAD(P) _mm256_loadu_si256((const __m256i *)(P))
+#define FX_FLAC_VEC_STORE(P, X) _mm256_storeu_si256((__m256i *)(P), X)
+#define FX_FLAC_VEC_AND(X, Y) _mm256_and_si256(X, Y)
+#define FX_FLAC_VEC_OR(X, Y) _mm256_or_si256(X, Y)
+#elif defined(FX_FLAC_SSE2)
+typedef __m128i fx_flac_vec_t;
+#define FX_FLAC_VEC_WIDTH 4U
+#define FX_FLAC_VEC(OP) _mm_##OP
+#define FX_FLAC_VEC_LOAD(P) _mm_loadu_si128((const __m128i *)(P))
+#define FX_FLAC_VEC_STORE(P, X) _mm_storeu_si128((__m128i *)(P), X)
+#define FX_FLAC_VEC_AND(X, Y) _mm_and_si128(X, Y)
+#define FX_FLAC_VEC_OR(X, Y) _mm_or_si128(X, Y)
+#endif
+
+#ifdef FX_FLAC_SSE2
+#define FX_FLAC_LOAD_128(P) _mm_loadu_si128((const __m128i *)(P))
+#define FX_FLAC_STORE_128(P, X) _mm_storeu_si128((__m128i *)(P), X)
+
+/**
+ * Transposes the 4x4 matrix of 32-bit integers stored in r, i.e. turns four
+ * vectors holding four samples of one channel each into four vectors holding
+ * one sample of four channels each.
+ */
+static inline void _fx_flac_transpose_4x4(__m128i *r) {
+	const __m128i t0 = _mm_unpacklo_epi32(r[0], r[1]); /* a0 b0 a1 b1 */
+	const __m128i t1 = _mm_unpacklo_epi32(r[2], r[3]); /* c0 d0 c1 d1 */
+	const __m128i t2 = _mm_unpackhi_epi32(r[0], r[1]); /* a2 b2 a3 b3 */
+	const __m128i t3 = _mm_unpackhi_epi32(r[2], r[3]); /* c2 d2 c3 d3 */
+	r[0] = _mm_unpacklo_epi64(t0, t1);                 /* a0 b0 c0 d0 */
+	r[1] = _mm_unpackhi_epi64(t0, t1);                 /* a1 b1 c1 d1 */
+	r[2] = _mm_unpacklo_epi64(t2, t3);                 /* a2 b2 c2 d2 */
+	r[3] = _mm_unpackhi_epi64(t2, t3);                 /* a3 b3 c3 d3 */
+}
+#endif /* FX_FLAC_SSE2 */
+
+/**
+ * Interleaves n samples of the two given channels into out.
+ */
+static inline void _fx_flac_interleave_2(int32_t *out, const int32_t *c1,
+                                         const int32_t *c2, uint32_t n) {
+	uint32_t i = 0U;
+#ifdef FX_FLAC_AVX2
+	for (; i + 8U <= n; i += 8U) {
+		/* Unpacking operates on the two 128-bit lanes independently */
+		const __m256i a = _mm256_loadu_si256((const __m256i *)(c1 + i));
+		const __m256i b = _mm256_loadu_si256((const __m256i *)(c2 + i));
+		const __m256i lo = _mm256_unpacklo_epi32(a, b);
+		const __m256i hi = _mm256_unpackhi_epi32(a, b);
+		_mm256_storeu_si256((__m256i *)(out + 2U * i),
+		                    _mm256_permute2x128_si256(lo, hi, 0x20));
+		_mm256_storeu_si256((__m256i *)(out + 2U * i + 8U),
+		                    _mm256_permute2x128_si256(lo, hi, 0x31));
+	}
+#endif
+#ifdef FX_FLAC_SSE2
+	for (; i + 4U <= n; i += 4U) {
+		const __m128i a = FX_FLAC_LOAD_128(c1 + i);
+		const __m128i b = FX_FLAC_LOAD_128(c2 + i);
+		FX_FLAC_STORE_128(out + 2U * i, _mm_unpacklo_epi32(a, b));
+		FX_FLAC_STORE_128(out + 2U * i + 4U, _mm_unpackhi_epi32(a, b));
 	}
+#endif
+	for (; i < n; i++) {
+		out[2U * i + 0U] = c1[i];
+		out[2U * i + 1U] = c2[i];
+	}
+}
 
-#define SYNC_BYTESTREAM()                        \
-	{                                            \
-		uint8_t n_ = inst->bitstream.pos & 0x07; \
-		if (n_) {                                \
-			READ_BITS(8U - n_);                  \
-		}                                        \
+/**
+ * Interleaves n samples of six channels (5.1 surround) into out, starting at
+ * sample offs of each channel.
+ */
+static inline void _fx_flac_interleave_6(int32_t *out, int32_t *const *blk,
+                                         uint32_t offs, uint32_t n) {
+	uint32_t i = 0U;
+#ifdef FX_FLAC_SSE2
+	for (; i + 4U <= n; i += 4U) {
+		/* Transpose the first four channels, pair the last two and merge the
+		   64-bit halves into the output */
+		__m128i r[4];
+		for (uint8_t c = 0U; c < 4U; c++) {
+			r[c] = FX_FLAC_LOAD_128(blk[c] + offs + i);
+		}
+		_fx_flac_transpose_4x4(r);
+		const __m128i e = FX_FLAC_LOAD_128(blk[4] + offs + i);
+		const __m128i f = FX_FLAC_LOAD_128(blk[5] + offs + i);
+		const __m128i ef01 = _mm_unpacklo_epi32(e, f); /* e0 f0 e1 f1 */
+		const __m128i ef23 = _mm_unpackhi_epi32(e, f); /* e2 f2 e3 f3 */
+		int32_t *o = out + 6U * i;
+		FX_FLAC_STORE_128(o + 0U, r[0]);
+		FX_FLAC_STORE_128(o + 4U, _mm_unpacklo_epi64(ef01, r[1]));
+		FX_FLAC_STORE_128(o + 8U, _mm_unpackhi_epi64(r[1], ef01));
+		FX_FLAC_STORE_128(o + 12U, r[2]);
+		FX_FLAC_STORE_128(o + 16U, _mm_unpacklo_epi64(ef23, r[3]));
+		FX_FLAC_STORE_128(o + 20U, _mm_unpackhi_epi64(r[3], ef23));
+	}
+#endif
+	for (; i < n; i++) {
+		for (uint8_t c = 0U; c < 6U; c++) {
+			out[6U * i + c] = blk[c][offs + i];
+		}
+	}
+}
+
+/**
+ * Interleaves n samples of eight channels (7.1 surround) into out, starting at
+ * sample offs of each channel.
+ */
+static inline void _fx_flac_interleave_8(int32_t *out, int32_t *const *blk,
+                                         uint32_t offs, uint32_t n) {
+	uint32_t i = 0U;
+#ifdef FX_FLAC_SSE2
+	for (; i + 4U <= n; i += 4U) {
+		__m128i r[4], q[4];
+		for (uint8_t c = 0U; c < 4U; c++) {
+			r[c] = FX_FLAC_LOAD_128(blk[c] + offs + i);
+			q[c] = FX_FLAC_LOAD_128(blk[c + 4U] + offs + i);
+		}
+		_fx_flac_transpose_4x4(r);
+		_fx_flac_transpose_4x4(q);
+		int32_t *o = out + 8U * i;
+		for (uint8_t j = 0U; j < 4U; j++) {
+			FX_FLAC_STORE_128(o + 8U * j, r[j]);
+			FX_FLAC_STORE_128(o + 8U * j + 4U, q[j]);
+		}
+	}
+#endif
+	for (; i < n; i++) {
+		for (uint8_t c = 0U; c < 8U; c++) {
+			out[8U * i + c] = blk[c][offs + i];
+		}
 	}
+}
 
-#ifdef FX_FLAC_NO_CRC
+/******************************************************************************
+ * Specialised stereo kernels                                                 *
+ ******************************************************************************/
 
-/* Just alias the CRC versions of the READ macros to the read macros
-   themselves */
-#define READ_BITS_CRC(n) READ_BITS(n)
-#define READ_BITS_FAST_CRC(n) READ_BITS_FAST(n)
-#define READ_BITS_DCRC(n) READ_BITS(n)
-#define READ_BITS_FAST_DCRC(n) READ_BITS_FAST(n)
-#define SYNC_BYTESTREAM_CRC() SYNC_BYTESTREAM()
+/* 16-bit and 24-bit stereo streams make up the vast majority of FLAC files.
+   For these, decorrelation and the shift aligning the output to 32 bits are
+   fused into a single pass with the shift being a compile-time constant. All
+   other configurations use the generic code path. */
 
-#else /* FX_FLAC_NO_CRC */
+#define FX_FLAC_DECORRELATE_INDEPENDENT(a, b, l, r) \
+	l = (uint32_t)(a);                              \
+	r = (uint32_t)(b);
 
-/* Update the frame checksum while reading data */
+#define FX_FLAC_DECORRELATE_LEFT_SIDE(a, b, l, r) \
+	l = (uint32_t)(a);                            \
+	r = (uint32_t)(a) - (uint32_t)(b);
 
-#define READ_BITS_CRC(n)                                                       \
-	(tmp_ = fx_bitstream_try_read_msb_ex(&inst->bitstream, n, _fx_flac_crc16_, \
-	                                     inst));                               \
-	if (tmp_ < 0) {                                                            \
-		return false; /* Need more data */                                     \
+#define FX_FLAC_DECORRELATE_RIGHT_SIDE(a, b, l, r) \
+	l = (uint32_t)(a) + (uint32_t)(b);             \
+	r = (uint32_t)(b);
+
+#define FX_FLAC_DECORRELATE_MID_SIDE(a, b, l, r)                      \
+	{                                                                 \
+		const int32_t mid_ = (int32_t)((uint32_t)(a) << 1) | ((b)&1); \
+		l = (uint32_t)((mid_ + (b)) >> 1);                            \
+		r = (uint32_t)((mid_ - (b)) >> 1);                            \
 	}
 
-#define READ_BITS_FAST_CRC(n)                                              \
-	(tmp_ = fx_bitstream_read_msb_ex(&inst->bitstream, n, _fx_flac_crc16_, \
-	                                 inst));
+/* Vectorised versions of the above, operating on fx_flac_vec_t */
 
-/* DCRC -> Dual CRC, update both the header and the frame checksum */
+#define FX_FLAC_DECORRELATE_INDEPENDENT_VEC(a, b, l, r) \
+	l = (a);                                            \
+	r = (b);
 
-#define READ_BITS_DCRC(n)                                              \
-	(tmp_ = fx_bitstream_try_read_msb_ex(&inst->bitstream, n,          \
-	                                     _fx_flac_double_crc_, inst)); \
-	if (tmp_ < 0) {                                                    \
-		return false; /* Need more data */                             \
+#define FX_FLAC_DECORRELATE_LEFT_SIDE_VEC(a, b, l, r) \
+	l = (a);                                          \
+	r = FX_FLAC_VEC(sub_epi32)(a, b);
+
+#define FX_FLAC_DECORRELATE_RIGHT_SIDE_VEC(a, b, l, r) \
+	l = FX_FLAC_VEC(add_epi32)(a, b);                  \
+	r = (b);
+
+#define FX_FLAC_DECORRELATE_MID_SIDE_VEC(a, b, l, r)                        \
+	{                                                                       \
+		const fx_flac_vec_t mid_ =                                          \
+		    FX_FLAC_VEC_OR(FX_FLAC_VEC(slli_epi32)(a, 1),                   \
+		                   FX_FLAC_VEC_AND(b, FX_FLAC_VEC(set1_epi32)(1))); \
+		l = FX_FLAC_VEC(srai_epi32)(FX_FLAC_VEC(add_epi32)(mid_, b), 1);    \
+		r = FX_FLAC_VEC(srai_epi32)(FX_FLAC_VEC(sub_epi32)(mid_, b), 1);    \
 	}
 
-#define READ_BITS_FAST_DCRC(n)                            \
-	(tmp_ = fx_bitstream_read_msb_ex(&inst->bitstream, n, \
-	                                 _fx_flac_double_crc_, inst));
+#ifdef FX_FLAC_VEC_WIDTH
+#define FX_FLAC_STEREO_KERNEL_VEC_LOOP(SHIFT, DECORRELATE)                \
+	for (; i + FX_FLAC_VEC_WIDTH <= blk_size; i += FX_FLAC_VEC_WIDTH) {   \
+		const fx_flac_vec_t a = FX_FLAC_VEC_LOAD(blk1 + i);               \
+		const fx_flac_vec_t b = FX_FLAC_VEC_LOAD(blk2 + i);               \
+		fx_flac_vec_t l, r;                                               \
+		DECORRELATE##_VEC(a, b, l, r)                                     \
+		FX_FLAC_VEC_STORE(blk1 + i, FX_FLAC_VEC(slli_epi32)(l, (SHIFT))); \
+		FX_FLAC_VEC_STORE(blk2 + i, FX_FLAC_VEC(slli_epi32)(r, (SHIFT))); \
+	}
+#else
+#define FX_FLAC_STEREO_KERNEL_VEC_LOOP(SHIFT, DECORRELATE)
+#endif
 
-#define SYNC_BYTESTREAM_CRC()                    \
-	{                                            \
-		uint8_t n_ = inst->bitstream.pos & 0x07; \
-		if (n_) {                                \
-			READ_BITS_CRC(8U - n_);              \
-		}                                        \
+#define FX_FLAC_DEFINE_STEREO_KERNEL(NAME, SHIFT, DECORRELATE)          \
+	static void NAME(int32_t *blk1, int32_t *blk2, uint32_t blk_size) { \
+		blk1 = (int32_t *)FX_ASSUME_ALIGNED(blk1);                      \
+		blk2 = (int32_t *)FX_ASSUME_ALIGNED(blk2);                      \
+		uint32_t i = 0U;                                                \
+		FX_FLAC_STEREO_KERNEL_VEC_LOOP(SHIFT, DECORRELATE)              \
+		for (; i < blk_size; i++) {                                     \
+			uint32_t l, r;                                              \
+			DECORRELATE(blk1[i], blk2[i], l, r)                         \
+			blk1[i] = (int32_t)(l << (SHIFT));                          \
+			blk2[i] = (int32_t)(r << (SHIFT));                          \
+		}                                                               \
 	}
 
-static const uint8_t fx_flac_crc8_table_[256] = {
-    0x00, 0x07, 0x0e, 0x09, 0x1c, 0x1b, 0x12, 0x15, 0x38, 0x3f, 0x36, 0x31,
-    0x24, 0x23, 0x2a, 0x2d, 0x70, 0x77, 0x7e, 0x79, 0x6c, 0x6b, 0x62, 0x65,
+FX_FLAC_DEFINE_STEREO_KERNEL(_fx_flac_stereo_16_independent, 16U,
+                             FX_FLAC_DECORRELATE_INDEPENDENT)
+FX_FLAC_DEFINE_STEREO_KERNEL(_fx_flac_stereo_16_left_side, 16U,
+                             FX_FLAC_DECORRELATE_LEFT_SIDE)
+FX_FLAC_DEFINE_STEREO_KERNEL(_fx_flac_stereo_16_right_side, 16U,
+                             FX_FLAC_DECORRELATE_RIGHT_SIDE)
+FX_FLAC_DEFINE_STEREO_KERNEL(_fx_flac_stereo_16_mid_side, 16U,
+                             FX_FLAC_DECORRELATE_MID_SIDE)
+FX_FLAC_DEFINE_STEREO_KERNEL(_fx_flac_stereo_24_independent, 8U,
+                             FX_FLAC_DECORRELATE_INDEPENDENT)
+FX_FLAC_DEFINE_STEREO_KERNEL(_fx_flac_stereo_24_left_side, 8U,
+                             FX_FLAC_DECORRELATE_LEFT_SIDE)
+FX_FLAC_DEFINE_STEREO_KERNEL(_fx_flac_stereo_24_right_side, 8U,
+                             FX_FLAC_DECORRELATE_RIGHT_SIDE)
+FX_FLAC_DEFINE_STEREO_KERNEL(_fx_flac_stereo_24_mid_side, 8U,
+                             FX_FLAC_DECORRELATE_MID_SIDE)
+
+/**
+ * Table containing the specialised kernels, indexed by bit depth (16, 24) and
+ * channel assignment (independent, left-side, right-side, mid-side).
+ */
+static const fx_flac_stereo_kernel_t _fx_flac_stereo_kernels[2][4] = {
+    {_fx_flac_stereo_16_independent, _fx_flac_stereo_16_left_side,
+     _fx_flac_stereo_16_right_side, _fx_flac_stereo_16_mid_side},
+    {_fx_flac_stereo_24_independent, _fx_flac_stereo_24_left_side,
+     _fx_flac_stereo_24_right_side, _fx_flac_stereo_24_mid_side}};
+
+/**
+ * Returns the specialised kernel for the given frame or NULL if the generic
+ * code path must be used.
+ */
+static fx_flac_stereo_kernel_t _fx_flac_select_stereo_kernel(
+    const fx_flac_frame_header_t *fh) {
+	if (fh->channel_count != 2U) {
+		return NULL;
+	}
+	const uint8_t ca = (fh->channel_assignment == INDEPENDENT_STEREO)
+	                       ? 0U
+	                       : (uint8_t)fh->channel_assignment - 7U;
+	switch (fh->sample_size) {
+		case 16U:
+			return _fx_flac_stereo_kernels[0][ca];
+		case 24U:
+			return _fx_flac_stereo_kernels[1][ca];
+		default:
+			return NULL;
+	}
+}
+
+/******************************************************************************
+ * Output stage                                                               *
+ ******************************************************************************/
+
+/**
+ * Computes the matrix for the current downmix preset and the given number of
+ * input channels. Rows with a total gain above one are scaled down such that
+ * the output cannot clip.
+ */
+static void _fx_flac_compute_downmix(fx_flac_t *inst, uint8_t cc) {
+	const uint8_t *layout = fx_flac_channel_layouts_[(cc - 1U) % 8U];
+	int32_t rows[2][FLAC_MAX_CHANNEL_COUNT];
+	for (uint8_t r = 0U; r < 2U; r++) {
+		int32_t sum = 0;
+		for (uint8_t c = 0U; c < cc; c++) {
+			rows[r][c] = fx_flac_stereo_gains_[layout[c]][r];
+			sum += rows[r][c];
+		}
+		for (uint8_t c = 0U; sum > FLAC_DOWNMIX_UNITY && c < cc; c++) {
+			rows[r][c] = rows[r][c] * FLAC_DOWNMIX_UNITY / sum;
+		}
+	}
+	if (inst->downmix == FLAC_DOWNMIX_MONO) {
+		for (uint8_t c = 0U; c < cc; c++) {
+			inst->mix[c] = (int16_t)((rows[0][c] + rows[1][c]) / 2);
+		}
+		inst->mix_n_out = 1U;
+	} else {
+		for (uint8_t c = 0U; c < cc; c++) {
+			inst->mix[c] = (int16_t)rows[0][c];
+			inst->mix[cc + c] = (int16_t)rows[1][c];
+		}
+		inst->mix_n_out = 2U;
+	}
+	inst->mix_n_in = cc;
+}
+
+/**
+ * Returns true if the output of a frame with the given number of channels
+ * must be mixed, computing the preset matrix if necessary.
+ */
+static bool _fx_flac_prepare_downmix(fx_flac_t *inst, uint8_t cc) {
+	const uint8_t all = (uint8_t)((1U << cc) - 1U);
+	switch (inst->downmix) {
+		case FLAC_DOWNMIX_STEREO:
+		case FLAC_DOWNMIX_MONO:
+			if ((cc == ((inst->downmix == FLAC_DOWNMIX_MONO) ? 1U : 2U)) &&
+			    ((inst->channel_mask & all) == all)) {
+				return false; /* Nothing to do */
+			}
+			if (inst->mix_n_in != cc) {
+				_fx_flac_compute_downmix(inst, cc);
+			}
+			return true;
+		case FLAC_DOWNMIX_CUSTOM:
+			return inst->mix_n_in == cc;
+		default:
+			return false;
+	}
+}
+
+/**
+ * Returns true if the gain and requantisation must be applied to the decoded
+ * channels of the given frame. Mixed frames are requantised while mixing.
+ */
+static bool _fx_flac_has_output_stage(fx_flac_t *inst,
+                                      const fx_flac_frame_header_t *fh) {
+	if (!inst->planar && _fx_flac_prepare_downmix(inst, fh->channel_count)) {
+		return false;
+	}
+	return (inst->gain != FLAC_GAIN_UNITY) ||
+	       (inst->dither_shift > 32U - fh->sample_size);
+}
+
+/**
+ * Advances the xorshift pseudo-random number generator used for dithering.
+ */
+static inline uint32_t _fx_flac_random(fx_flac_t *inst) {
+	uint32_t x = inst->dither_rng;
+	x ^= x << 13U;
+	x ^= x >> 17U;
+	x ^= x << 5U;
+	return inst->dither_rng = x;
+}
+
+/**
+ * Applies the gain to a single sample scaled to the 32-bit range (possibly
+ * with additional fractional bits from mixing), requantises it to the target
+ * bit depth and saturates the result. c is the output channel.
+ */
+static inline int32_t _fx_flac_output_sample(fx_flac_t *inst, int64_t v,
+                                             uint8_t c) {
+	v = (v * inst->gain) >> 16;
+	int64_t hi = INT32_MAX;
+	if (inst->dither_shift) {
+		const int64_t lsb = (int64_t)1 << inst->dither_shift;
+		int64_t d = lsb / 2; /* Round to nearest */
+		if (inst->dither == FLAC_DITHER_SHAPED) {
+			v -= inst->dither_err[c];
+		}
+		if (inst->dither != FLAC_DITHER_NONE) {
+			const uint32_t m = (uint32_t)(lsb - 1);
+			d += (int64_t)(_fx_flac_random(inst) & m) -
+			     (int64_t)(_fx_flac_random(inst) & m);
+		}
+		const int64_t q = (v + d) & -lsb;
+		if (inst->dither == FLAC_DITHER_SHAPED) {
+			inst->dither_err[c] = q - v;
+		}
+		v = q;
+		hi = ((int64_t)INT32_MAX + 1) - lsb;
+	}
+	return (v > hi) ? (int32_t)hi : (v < INT32_MIN) ? INT32_MIN : (int32_t)v;
+}
+
+/**
+ * Shifts the given decoded channel to the 32-bit range and applies the output
+ * stage. The common case of a plain gain is handled in a tight loop.
+ */
+static void _fx_flac_output_stage(fx_flac_t *inst, int32_t *blk, uint32_t n,
+                                  uint8_t shift, uint8_t c) {
+	if (!inst->dither_shift) {
+		const int64_t gain = inst->gain;
+		for (uint32_t i = 0U; i < n; i++) {
+			const int64_t v =
+			    ((int64_t)(int32_t)((uint32_t)blk[i] << shift) * gain) >> 16;
+			blk[i] = (v > INT32_MAX)   ? INT32_MAX
+			         : (v < INT32_MIN) ? INT32_MIN
+			                           : (int32_t)v;
+		}
+		return;
+	}
+	for (uint32_t i = 0U; i < n; i++) {
+		blk[i] = _fx_flac_output_sample(
+		    inst, (int32_t)((uint32_t)blk[i] << shift), c);
+	}
+}
+
+/**
+ * Called once all subframes of a frame with constant subframes have been
+ * read. If all channels needed for the output are constant, decorrelates the
+ * constant values, applies the output scaling to them and returns true; the
+ * output is then written without touching the block buffers. Otherwise fills
+ * the block buffers of the constant channels and returns false. Planar and
+ * mixed output, as well as dither, always require the block buffers.
+ */
+static bool _fx_flac_finalize_const(fx_flac_t *inst) {
+	const fx_flac_frame_header_t *fh = inst->frame_header;
+	const uint8_t cc = fh->channel_count;
+	uint8_t needed = inst->channel_mask & (uint8_t)((1U << cc) - 1U);
+	if (fh->channel_assignment >= LEFT_SIDE_STEREO && needed) {
+		needed = 0x03U;
+	}
+	int32_t *v = inst->const_val;
+
+	if (((inst->const_mask & needed) == needed) && !inst->planar &&
+	    !(inst->output_stage && inst->dither_shift &&
+	      inst->dither != FLAC_DITHER_NONE) &&
+	    !_fx_flac_prepare_downmix(inst, cc)) {
+		switch (fh->channel_assignment) {
+			case LEFT_SIDE_STEREO:
+				v[1] = (int32_t)((uint32_t)v[0] - (uint32_t)v[1]);
+				break;
+			case RIGHT_SIDE_STEREO:
+				v[0] = (int32_t)((uint32_t)v[0] + (uint32_t)v[1]);
+				break;
+			case MID_SIDE_STEREO: {
+				int32_t mid = (int32_t)((uint32_t)v[0] << 1);
+				mid |= (v[1] & 1); /* Round correctly */
+				v[0] = (mid + v[1]) >> 1;
+				v[1] = (mid - v[1]) >> 1;
+				break;
+			}
+			default:
+				break;
+		}
+		const uint8_t shift = 32U - fh->sample_size;
+		for (uint8_t c = 0U; c < cc; c++) {
+			v[c] = (int32_t)((uint32_t)v[c] << shift);
+			if (inst->output_stage) {
+				v[c] = _fx_flac_output_sample(inst, v[c], c);
+			}
+		}
+		inst->frame_const = true;
+		return true;
+	}
+
+	const uint8_t fill = inst->const_mask & needed;
+	for (uint8_t c = 0U; c < cc; c++) {
+		if (fill & (1U << c)) {
+			int32_t *blk = inst->blkbuf[c];
+			for (uint32_t i = 0U; i < fh->block_size; i++) {
+				blk[i] = v[c];
+			}
+		}
+	}
+	return false;
+}
+
+/******************************************************************************
+ * Stream utility functions and macros                                        *
+ ******************************************************************************/
+
+/* http://graphics.stanford.edu/~seander/bithacks.html#FixedSignExtend */
+#define SIGN_EXTEND(x, b) \
+	(int64_t)((x) ^ (1ULL << ((b)-1U))) - (int64_t)(1ULL << ((b)-1U))
+
+#define ENSURE_BITS(n)                                 \
+	if (!fx_bitstream_can_read(&inst->bitstream, n)) { \
+		return false; /* Need more data */             \
+	}
+
+#define READ_BITS(n)                                         \
+	(tmp_ = fx_bitstream_try_read_msb(&inst->bitstream, n)); \
+	if (tmp_ < 0) {                                          \
+		return false; /* Need more data */                   \
+	}
+
+#define READ_BITS_FAST(n) (tmp_ = fx_bitstream_read_msb(&inst->bitstream, n));
+
+#define PEEK_BITS(n)                                         \
+	(tmp_ = fx_bitstream_try_peek_msb(&inst->bitstream, n)); \
+	if (tmp_ < 0) {                                          \
+		return false; /* Need more data */                   \
+	}
+
+#define SYNC_BYTESTREAM()                        \
+	{                                            \
+		uint8_t n_ = inst->bitstream.pos & 0x07; \
+		if (n_) {                                \
+			READ_BITS(8U - n_);                  \
+		}                                        \
+	}
+
+/* The CRC versions of the READ macros expect two boolean constants "crc8_"
+   and "crc16_" in the enclosing scope selecting which checksums to update.
+   If these are compile-time constants (see FX_FLAC_ALWAYS_INLINE), the
+   compiler removes the checksum code entirely instead of checking a flag
+   for every byte. */
+
+#define FX_FLAC_CRC16_CB (crc16_ ? _fx_flac_crc16_ : NULL)
+
+#define FX_FLAC_DCRC_CB                                        \
+	(crc16_ ? (crc8_ ? _fx_flac_double_crc_ : _fx_flac_crc16_) \
+	        : (crc8_ ? _fx_flac_crc8_ : NULL))
+
+/* Update the frame checksum while reading data */
+
+#define READ_BITS_CRC(n)                                            \
+	(tmp_ = fx_bitstream_try_read_msb_ex(&inst->bitstream, n,       \
+	                                     FX_FLAC_CRC16_CB, inst)); \
+	if (tmp_ < 0) {                                                 \
+		return false; /* Need more data */                          \
+	}
+
+#define READ_BITS_FAST_CRC(n)                             \
+	(tmp_ = fx_bitstream_read_msb_ex(&inst->bitstream, n, \
+	                                 FX_FLAC_CRC16_CB, inst));
+
+/* DCRC -> Dual CRC, update both the header and the frame checksum */
+
+#define READ_BITS_DCRC(n)                                          \
+	(tmp_ = fx_bitstream_try_read_msb_ex(&inst->bitstream, n,      \
+	                                     FX_FLAC_DCRC_CB, inst)); \
+	if (tmp_ < 0) {                                                \
+		return false; /* Need more data */                         \
+	}
+
+#define READ_BITS_FAST_DCRC(n)                            \
+	(tmp_ = fx_bitstream_read_msb_ex(&inst->bitstream, n, \
+	                                 FX_FLAC_DCRC_CB, inst));
+
+#define SYNC_BYTESTREAM_CRC()                    \
+	{                                            \
+		uint8_t n_ = inst->bitstream.pos & 0x07; \
+		if (n_) {                                \
+			READ_BITS_CRC(8U - n_);              \
+		}                                        \
+	}
+
+/* Forces the compiler to inline a function. Used to generate copies of the
+   frame decoder specialised for a particular CRC mode. */
+#ifdef __GNUC__
+#define FX_FLAC_ALWAYS_INLINE inline __attribute__((always_inline))
+#else
+#define FX_FLAC_ALWAYS_INLINE inline
+#endif
+
+static const uint8_t fx_flac_crc8_table_[256] = {
+    0x00, 0x07, 0x0e, 0x09, 0x1c, 0x1b, 0x12, 0x15, 0x38, 0x3f, 0x36, 0x31,
+    0x24, 0x23, 0x2a, 0x2d, 0x70, 0x77, 0x7e, 0x79, 0x6c, 0x6b, 0x62, 0x65,
     0x48, 0x4f, 0x46, 0x41, 0x54, 0x53, 0x5a, 0x5d, 0xe0, 0xe7, 0xee, 0xe9,
     0xfc, 0xfb, 0xf2, 0xf5, 0xd8, 0xdf, 0xd6, 0xd1, 0xc4, 0xc3, 0xca, 0xcd,
     0x90, 0x97, 0x9e, 0x99, 0x8c, 0x8b, 0x82, 0x85, 0xa8, 0xaf, 0xa6, 0xa1,
@@ -1094,11 +2035,13 @@ static inline void _fx_flac_double_crc_(uint8_t byte, void *data) {
 	_fx_flac_crc8_(byte, data);
 	_fx_flac_crc16_(byte, data);
 }
-#endif /* FX_FLAC_NO_CRC */
 
 static bool _fx_flac_reader_utf8_coded_int(fx_flac_t *inst, uint8_t max_n,
                                            uint64_t *tar) {
 	int64_t tmp_; /* Used by the READ_BITS macro */
+	const fx_flac_crc_mode_t crc_mode = inst->frame_crc_mode;
+	const bool crc8_ = inst->verify_only || crc_mode != FLAC_CRC_NONE;
+	const bool crc16_ = inst->verify_only || crc_mode == FLAC_CRC_FULL;
 
 	ENSURE_BITS(max_n * 8U);
 	/* Read the first byte */
@@ -1133,6 +2076,131 @@ static bool _fx_flac_reader_utf8_coded_int(fx_flac_t *inst, uint8_t max_n,
 	return true;
 }
 
+/**
+ * Returns the offset of the next byte in the stream that has not been read
+ * from the bitstream reader, relative to the first byte passed to the decoder
+ * after the last reset.
+ */
+static uint64_t _fx_flac_stream_pos(const fx_flac_t *inst) {
+	const fx_bitstream_t *bs = &inst->bitstream;
+	const uint32_t n_buffered = (BUFSIZE - bs->pos + 7U) / 8U;
+	return inst->n_bytes_consumed + (uint64_t)(bs->src - inst->src_start) -
+	       n_buffered;
+}
+
+/**
+ * Lower bound for the size of a frame in bytes: frame header, a single
+ * constant subframe and the CRC-16 checksum. Used to bound the number of
+ * frames that may have been lost between two valid frames.
+ */
+#define FX_FLAC_MIN_FRAME_SIZE 9U
+
+/**
+ * Returns true if the frame header that has just been read may follow a frame
+ * ending at the given offset, i.e. if its frame number (fixed block size) or
+ * first sample (variable block size) is at least next and skips no more
+ * frames than fit into the bytes in between; each lost frame occupies at
+ * least the minimum frame size.
+ */
+static bool _fx_flac_candidate_follows(const fx_flac_t *inst, uint64_t next,
+                                       uint64_t offset) {
+	const fx_flac_frame_header_t *fh = inst->frame_header;
+	const fx_flac_streaminfo_t *si = inst->streaminfo;
+	const fx_flac_frame_info_t *fi = &inst->frame_info;
+	const bool fixed = fh->blocking_strategy == BLK_FIXED;
+	const uint64_t pos = fixed ? fh->sync_info : fi->first_sample;
+	const uint32_t min_size = (si->min_frame_size > FX_FLAC_MIN_FRAME_SIZE)
+	                              ? si->min_frame_size
+	                              : FX_FLAC_MIN_FRAME_SIZE;
+	const uint32_t max_block = si->max_block_size ? si->max_block_size
+	                                              : inst->max_block_size;
+	const uint64_t n_bytes = (fi->offset > offset) ? fi->offset - offset : 0U;
+	const uint64_t n_lost = n_bytes / min_size + 1U;
+	return (pos >= next) && (pos - next <= n_lost * (fixed ? 1U : max_block));
+}
+
+/**
+ * Checks whether the frame header that has just been read is plausible, i.e.
+ * whether it is consistent with the STREAMINFO block and with the last valid
+ * frame. Updates the rejection counters.
+ */
+static bool _fx_flac_check_candidate(fx_flac_t *inst) {
+	const fx_flac_frame_header_t *fh = inst->frame_header;
+	const fx_flac_streaminfo_t *si = inst->streaminfo;
+	const fx_flac_frame_info_t *fi = &inst->frame_info;
+
+	/* Fields that are coded in the frame header must match the STREAMINFO */
+	if ((si->sample_rate && fh->sample_rate != si->sample_rate) ||
+	    (si->sample_size && fh->sample_size != si->sample_size) ||
+	    (si->n_channels && fh->channel_count != si->n_channels) ||
+	    (si->max_block_size && fh->block_size > si->max_block_size)) {
+		inst->sync_stats.n_inconsistent++;
+		return false;
+	}
+
+	/* The frame should follow the last valid frame. Packets are framed by
+	   the container, which may also seek between them. */
+	if (inst->has_next_frame && !inst->packet) {
+		const bool fixed = fh->blocking_strategy == BLK_FIXED;
+		const uint64_t next = fixed ? inst->next_frame : inst->next_sample;
+		const uint64_t pos = fixed ? fh->sync_info : fi->first_sample;
+		if (_fx_flac_candidate_follows(inst, next, inst->next_offset)) {
+			inst->has_resync = false;
+		} else if ((fi->offset == inst->next_offset) && (pos > next)) {
+			/* Nothing was skipped, the application jumped forward; this is
+			   not a gap */
+			inst->has_next_frame = false;
+			inst->has_resync = false;
+		} else if (inst->has_resync &&
+		           _fx_flac_candidate_follows(inst, inst->resync_next,
+		                                      inst->resync_offset)) {
+			/* The candidate continues the last rejected one, so the stream
+			   really continues at a different position; re-anchor */
+			inst->has_next_frame = false;
+			inst->has_resync = false;
+		} else {
+			/* Discontinuities usually are false positives within the audio
+			   data; remember the candidate in case the stream continues */
+			inst->resync_next = pos + (fixed ? 1U : fh->block_size);
+			inst->resync_offset = fi->offset;
+			inst->has_resync = true;
+			inst->sync_stats.n_discontinuous++;
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+ * Returns true if the current frame already is larger than the maximum frame
+ * size announced in the STREAMINFO block.
+ */
+static inline bool _fx_flac_frame_oversized(fx_flac_t *inst) {
+	const uint32_t max_size = inst->streaminfo->max_frame_size;
+	if (max_size &&
+	    (_fx_flac_stream_pos(inst) - inst->frame_info.offset > max_size)) {
+		inst->sync_stats.n_oversized++;
+		return true;
+	}
+	return false;
+}
+
+/**
+ * Counts the number of leading zeros in a non-zero 64-bit integer.
+ */
+static inline uint8_t _fx_flac_clz64(uint64_t x) {
+#ifdef __GNUC__
+	return (uint8_t)__builtin_clzll(x);
+#else
+	uint8_t n = 0U;
+	while (!(x & (1ULL << 63U))) {
+		x <<= 1U;
+		n++;
+	}
+	return n;
+#endif
+}
+
 /******************************************************************************
  * Private decoder state machine                                              *
  ******************************************************************************/
@@ -1145,8 +2213,88 @@ static bool _fx_flac_reader_utf8_coded_int(fx_flac_t *inst, uint8_t max_n,
  * is what inst->state == FLAC_ERR is for.
  */
 
+/**
+ * Called once a gap has been found in front of the current frame. Clips the
+ * gap to the selected range of samples and sets up writing the replacement
+ * samples before the frame itself is decoded.
+ */
+static void _fx_flac_prepare_gap(fx_flac_t *inst) {
+	const fx_flac_frame_info_t *fi = &inst->frame_info;
+	const uint64_t begin = (inst->next_sample > inst->range_first)
+	                           ? inst->next_sample
+	                           : inst->range_first;
+	const uint64_t end = (fi->first_sample < inst->range_end)
+	                         ? fi->first_sample
+	                         : inst->range_end;
+	inst->conceal_rem = 0U;
+	if (!inst->planar && (end > begin)) {
+		inst->conceal_rem = end - begin;
+	}
+	inst->conceal_pos = begin - inst->next_sample;
+	inst->conceal_fade = inst->frame_header->block_size;
+	inst->conceal_blk_begin = inst->blk_begin;
+	inst->conceal_blk_end = inst->blk_end;
+	inst->blk_cur = 0U;
+	inst->blk_end = 0U;
+}
+
+/**
+ * Fills the block buffers with the next chunk of replacement samples.
+ */
+static void _fx_flac_fill_gap(fx_flac_t *inst) {
+	const uint8_t cc = inst->frame_header->channel_count;
+	const bool repeat = (inst->conceal == FLAC_CONCEAL_REPEAT) &&
+	                    (inst->tail_len > 0U);
+	const uint64_t fade = inst->conceal_fade;
+	uint32_t n = inst->max_block_size;
+	if (n > inst->conceal_rem) {
+		n = (uint32_t)inst->conceal_rem;
+	}
+	for (uint8_t c = 0U; c < cc; c++) {
+		int32_t *blk = inst->blkbuf[c];
+		for (uint32_t i = 0U; i < n; i++) {
+			const uint64_t pos = inst->conceal_pos + i;
+			blk[i] = 0;
+			if (repeat && pos < fade) {
+				const int64_t x =
+				    inst->tailbuf[c * FX_FLAC_CONCEAL_TAIL +
+				                  pos % inst->tail_len];
+				blk[i] = (int32_t)(x * (int64_t)(fade - pos) / (int64_t)fade);
+			}
+		}
+	}
+	inst->conceal_rem -= n;
+	inst->conceal_pos += n;
+	inst->blk_begin = 0U;
+	inst->blk_end = (uint16_t)n;
+	inst->blk_cur = 0U;
+	inst->chan_cur = 0U;
+}
+
+/**
+ * Retains the last samples of the frame that was just written for the
+ * FLAC_CONCEAL_REPEAT policy.
+ */
+static void _fx_flac_store_tail(fx_flac_t *inst) {
+	const uint8_t cc = inst->frame_header->channel_count;
+	uint32_t n = inst->blk_end - inst->blk_begin;
+	if (n > FX_FLAC_CONCEAL_TAIL) {
+		n = FX_FLAC_CONCEAL_TAIL;
+	}
+	const uint32_t i0 = inst->blk_end - n;
+	for (uint8_t c = 0U; c < cc; c++) {
+		int32_t *tail = inst->tailbuf + c * FX_FLAC_CONCEAL_TAIL;
+		for (uint32_t i = 0U; i < n; i++) {
+			tail[i] = inst->frame_const ? inst->const_val[c]
+			                            : inst->blkbuf[c][i0 + i];
+		}
+	}
+	inst->tail_len = (uint16_t)n;
+}
+
 static bool _fx_flac_handle_err(fx_flac_t *inst) {
-	/* TODO: Add flags to fx_flac_t which control this behaviour */
+	/* Samples lost because of the error are replaced once the next valid
+	   frame has been found, see fx_flac_set_concealment() */
 
 	/* If an error happens while searching for metadata, this is fatal. */
 	if (inst->state < FLAC_END_OF_METADATA) {
@@ -1154,6 +2302,34 @@ static bool _fx_flac_handle_err(fx_flac_t *inst) {
 		return false;
 	}
 
+	/* In packet mode, fail the entire packet. The frame info is only valid if
+	   the frame header has been read. */
+	if (inst->packet) {
+		fx_flac_frame_info_t *ci = &inst->corrupt_info;
+		*ci = inst->frame_info;
+		if (inst->state != FLAC_IN_FRAME) {
+			ci->first_sample = inst->has_next_frame ? inst->next_sample : 0U;
+			ci->n_samples = 0U;
+		}
+		inst->state = FLAC_FRAME_CORRUPT;
+		inst->priv_state = FLAC_FRAME_SYNC;
+		return false;
+	}
+
+	/* In verify-only mode, report frames that turned out to be corrupt after
+	   their header has been read. */
+	if (inst->verify_only && inst->state == FLAC_IN_FRAME) {
+		const fx_flac_frame_info_t *fi = &inst->frame_info;
+		inst->corrupt_info = *fi;
+		inst->next_sample = fi->first_sample + fi->n_samples;
+		inst->next_frame = inst->frame_header->sync_info + 1U;
+		inst->next_offset = _fx_flac_stream_pos(inst);
+		inst->has_next_frame = true;
+		inst->state = FLAC_FRAME_CORRUPT;
+		inst->priv_state = FLAC_FRAME_SYNC;
+		return true;
+	}
+
 	/* Otherwise just try to re-synchronise with the stream by searching for the
 	   next frame */
 	inst->state = FLAC_SEARCH_FRAME;
@@ -1203,6 +2379,111 @@ static bool _fx_flac_process_init(fx_flac_t *inst) {
 	return true;
 }
 
+static void _fx_flac_clear_cuesheet(fx_flac_cuesheet_t *cs) {
+	cs->valid = false;
+	cs->is_cd = false;
+	for (uint32_t i = 0U; i < sizeof(cs->catalog); i++) {
+		cs->catalog[i] = 0;
+	}
+	cs->lead_in = 0U;
+	cs->n_tracks = 0U;
+	cs->n_indices = 0U;
+}
+
+/**
+ * Advances to the next record of the CUESHEET metadata block once the current
+ * record has been read: index points follow their track.
+ */
+static void _fx_flac_cue_next_record(fx_flac_t *inst) {
+	if (inst->cue_indices_rem) {
+		inst->cue_rec = FLAC_CUE_INDEX;
+	} else if (inst->cue_tracks_rem) {
+		inst->cue_rec = FLAC_CUE_TRACK;
+	} else {
+		inst->cue_rec = FLAC_CUE_DONE;
+	}
+	inst->cue_pos = 0U;
+}
+
+/**
+ * Parses a single byte of the CUESHEET metadata block. The tracks are
+ * written to the caller-provided array as they are read; tracks that do not
+ * fit are skipped along with their index points.
+ */
+static void _fx_flac_process_cuesheet_byte(fx_flac_t *inst, uint8_t byte) {
+	fx_flac_cuesheet_t *cs = inst->cuesheet;
+	const uint16_t pos = inst->cue_pos++;
+	inst->cue_acc = (inst->cue_acc << 8U) | byte; /* 64-bit offsets */
+	switch (inst->cue_rec) {
+		case FLAC_CUE_HEADER:
+			if (pos < 128U) {
+				cs->catalog[pos] = (char)byte;
+			} else if (pos == 135U) {
+				cs->lead_in = inst->cue_acc;
+			} else if (pos == 136U) {
+				cs->is_cd = byte & 0x80U;
+			} else if (pos == FX_FLAC_CUE_HEADER_SIZE - 1U) {
+				inst->cue_tracks_rem = byte;
+				inst->cue_indices_rem = 0U;
+				_fx_flac_cue_next_record(inst);
+			}
+			break;
+		case FLAC_CUE_TRACK: {
+			if (pos == 0U) {
+				inst->cue_store = cs->n_tracks < cs->max_tracks;
+			}
+			if (!inst->cue_store) {
+				if (pos == FX_FLAC_CUE_TRACK_SIZE - 1U) {
+					inst->cue_indices_rem = byte;
+				}
+			} else {
+				fx_flac_cue_track_t *track = &cs->tracks[cs->n_tracks];
+				if (pos == 7U) {
+					track->offset = inst->cue_acc;
+				} else if (pos == 8U) {
+					track->number = byte;
+					track->isrc[12] = 0;
+				} else if (pos >= 9U && pos < 21U) {
+					track->isrc[pos - 9U] = (char)byte;
+				} else if (pos == 21U) {
+					track->audio = !(byte & 0x80U);
+					track->pre_emphasis = byte & 0x40U;
+				} else if (pos == FX_FLAC_CUE_TRACK_SIZE - 1U) {
+					track->n_indices = 0U;
+					track->first_index = cs->n_indices;
+					inst->cue_indices_rem = byte;
+					cs->n_tracks++;
+				}
+			}
+			if (pos == FX_FLAC_CUE_TRACK_SIZE - 1U) {
+				inst->cue_tracks_rem--;
+				_fx_flac_cue_next_record(inst);
+			}
+			break;
+		}
+		case FLAC_CUE_INDEX: {
+			const bool store =
+			    inst->cue_store && cs->n_indices < cs->max_indices;
+			fx_flac_cue_index_t *index = &cs->indices[cs->n_indices];
+			if (store && pos == 7U) {
+				index->offset = inst->cue_acc;
+			} else if (store && pos == 8U) {
+				index->number = byte;
+			} else if (pos == FX_FLAC_CUE_INDEX_SIZE - 1U) {
+				if (store) {
+					cs->n_indices++;
+					cs->tracks[cs->n_tracks - 1U].n_indices++;
+				}
+				inst->cue_indices_rem--;
+				_fx_flac_cue_next_record(inst);
+			}
+			break;
+		}
+		case FLAC_CUE_DONE:
+			break;
+	}
+}
+
 static bool _fx_flac_process_in_metadata(fx_flac_t *inst) {
 	int64_t tmp_; /* Used by the READ_BITS macro */
 	switch (inst->priv_state) {
@@ -1220,10 +2501,28 @@ static bool _fx_flac_process_in_metadata(fx_flac_t *inst) {
 				if (inst->metadata->length != 34U) {
 					return _fx_flac_handle_err(inst);
 				}
+			} else if (inst->metadata->type == META_TYPE_CUESHEET &&
+			           inst->cuesheet) {
+				_fx_flac_clear_cuesheet(inst->cuesheet);
+				inst->priv_state = FLAC_METADATA_CUESHEET;
+				inst->cue_rec = FLAC_CUE_HEADER;
+				inst->cue_pos = 0U;
+				inst->cue_acc = 0U;
 			} else {
 				inst->priv_state = FLAC_METADATA_SKIP;
 			}
 			break;
+		case FLAC_METADATA_CUESHEET:
+			if (inst->n_bytes_rem == 0U) {
+				/* Only mark the cue sheet as valid if it is complete */
+				inst->cuesheet->valid = inst->cue_rec == FLAC_CUE_DONE;
+				inst->priv_state = FLAC_METADATA_SKIP;
+				break;
+			}
+			READ_BITS(8U);
+			_fx_flac_process_cuesheet_byte(inst, (uint8_t)tmp_);
+			inst->n_bytes_rem -= 1U;
+			break;
 		case FLAC_METADATA_SINFO:
 			switch (inst->n_bytes_rem) {
 				case 34U:
@@ -1306,6 +2605,12 @@ static bool _fx_flac_process_in_metadata(fx_flac_t *inst) {
 
 static bool _fx_flac_process_search_frame(fx_flac_t *inst) {
 	int64_t tmp_; /* Used by the READ_BITS macro */
+	if (inst->priv_state == FLAC_FRAME_SYNC) {
+		inst->frame_crc_mode = inst->crc_mode; /* Fixed for the next frame */
+	}
+	const fx_flac_crc_mode_t crc_mode = inst->frame_crc_mode;
+	const bool crc8_ = inst->verify_only || crc_mode != FLAC_CRC_NONE;
+	const bool crc16_ = inst->verify_only || crc_mode == FLAC_CRC_FULL;
 	fx_flac_frame_header_t *fh = inst->frame_header;
 	fx_flac_streaminfo_t *si = inst->streaminfo;
 	switch (inst->priv_state) {
@@ -1316,11 +2621,22 @@ static bool _fx_flac_process_search_frame(fx_flac_t *inst) {
 			ENSURE_BITS(15U);
 			uint16_t sync_code = PEEK_BITS(15U);
 			if (sync_code != 0x7FFCU) {
+				if (inst->packet) {
+					return _fx_flac_handle_err(inst); /* Do not search */
+				}
+
+				/* Another stream was appended; its frames start anew */
+				ENSURE_BITS(32U);
+				if (fx_bitstream_peek_msb(&inst->bitstream, 32U) ==
+				    0x664C6143U) {
+					inst->has_next_frame = false;
+				}
 				READ_BITS(8U); /* Next byte (assume frames are byte aligned). */
 				return true;
 			} else {
 				inst->crc8 = 0U; /* Reset the checksums */
 				inst->crc16 = 0U;
+				inst->frame_info.offset = _fx_flac_stream_pos(inst);
 				inst->priv_state = FLAC_FRAME_HEADER;
 				READ_BITS_FAST_DCRC(15U);
 			}
@@ -1359,6 +2675,12 @@ static bool _fx_flac_process_search_frame(fx_flac_t *inst) {
 				inst->priv_state = FLAC_FRAME_SYNC; /* Got invalid value */
 				break;
 			}
+
+			/* Without STREAMINFO, the sample size may be unknown */
+			if (fh->sample_size == 0U) {
+				inst->priv_state = FLAC_FRAME_SYNC;
+				break;
+			}
 			inst->priv_state = FLAC_FRAME_HEADER_SYNC_INFO;
 			break;
 		case FLAC_FRAME_HEADER_SYNC_INFO:
@@ -1403,22 +2725,96 @@ static bool _fx_flac_process_search_frame(fx_flac_t *inst) {
 			   to the header. If not, this is not a valid header. Continue
 			   searching. */
 			fh->crc8 = READ_BITS_CRC(8U);
-#ifndef FX_FLAC_NO_CRC
-			if (fh->crc8 != inst->crc8) {
+			if (crc8_ && (fh->crc8 != inst->crc8)) {
+				inst->sync_stats.n_header_crc++;
 				return _fx_flac_handle_err(inst);
 			}
-#endif
 
-			/* Make sure the decode has enough space */
+			/* Make sure the decode has enough space and that there are
+			   buffers to decode into */
 			if ((fh->block_size > inst->max_block_size) ||
-			    (fh->channel_count > inst->max_channels)) {
+			    (fh->channel_count > inst->max_channels) ||
+			    !inst->blkbuf[0]) {
 				return _fx_flac_handle_err(inst);
 			}
 
+			/* Select the post-processing code path for this frame; the
+			   kernels do not implement the output stage */
+			inst->output_stage = _fx_flac_has_output_stage(inst, fh);
+			inst->stereo_kernel = inst->output_stage
+			                          ? NULL
+			                          : _fx_flac_select_stereo_kernel(fh);
+
+			/* Compute the index of the first sample in this frame. For
+			   streams with fixed block size the header stores the frame
+			   number; all but the last frame have the nominal, i.e. the
+			   maximum block size. Without STREAMINFO, continue after the
+			   last frame. */
+			fx_flac_frame_info_t *fi = &inst->frame_info;
+			fi->n_samples = fh->block_size;
+			fi->silent = false;
+			inst->const_mask = 0U;
+			inst->frame_const = false;
+			if (fh->blocking_strategy == BLK_VARIABLE) {
+				fi->first_sample = fh->sync_info;
+			} else if (si->max_block_size > 0U) {
+				fi->first_sample = fh->sync_info * si->max_block_size;
+			} else if (inst->has_next_frame &&
+			           (fh->sync_info == inst->next_frame)) {
+				fi->first_sample = inst->next_sample;
+			} else {
+				fi->first_sample = fh->sync_info * fh->block_size;
+			}
+
+			/* Reject implausible frame candidates before decoding them */
+			if (!_fx_flac_check_candidate(inst)) {
+				return _fx_flac_handle_err(inst);
+			}
+
+			/* Trim the frame to the selected range of samples, only parse
+			   frames before the range. Frames after the range end it, but
+			   a gap in front of them may still reach into the range. */
+			const uint64_t frame_end = fi->first_sample + fh->block_size;
+			const bool past_range =
+			    !inst->verify_only && (fi->first_sample >= inst->range_end);
+			inst->blk_begin = 0U;
+			inst->blk_end = fh->block_size;
+			inst->frame_skip = false;
+			if (!inst->verify_only && !past_range) {
+				if (frame_end <= inst->range_first) {
+					inst->frame_skip = true;
+				} else if (fi->first_sample < inst->range_first) {
+					inst->blk_begin =
+					    (uint16_t)(inst->range_first - fi->first_sample);
+				}
+				if (frame_end > inst->range_end) {
+					inst->blk_end =
+					    (uint16_t)(inst->range_end - fi->first_sample);
+				}
+			}
+
 			/* Decode the subframes */
-			inst->state = FLAC_IN_FRAME;
+			inst->state = past_range ? FLAC_END_OF_RANGE : FLAC_IN_FRAME;
 			inst->priv_state = FLAC_SUBFRAME_HEADER;
 			inst->chan_cur = 0U; /* Start with the first channel */
+
+			/* In verify-only mode or if a concealment policy is active,
+			   report frames that were skipped */
+			if ((inst->verify_only ||
+			     (inst->conceal != FLAC_CONCEAL_DROP && !inst->packet)) &&
+			    inst->has_next_frame &&
+			    fi->first_sample > inst->next_sample &&
+			    (!past_range || inst->next_sample < inst->range_end)) {
+				fx_flac_frame_info_t *ci = &inst->corrupt_info;
+				ci->offset = inst->next_offset;
+				ci->first_sample = inst->next_sample;
+				ci->n_samples =
+				    (uint32_t)(fi->first_sample - inst->next_sample);
+				inst->state = FLAC_FRAME_CORRUPT;
+				if (!inst->verify_only) {
+					_fx_flac_prepare_gap(inst);
+				}
+			}
 			break;
 		default:
 			return _fx_flac_handle_err(inst);
@@ -1426,32 +2822,30 @@ static bool _fx_flac_process_search_frame(fx_flac_t *inst) {
 	return true;
 }
 
-static bool _fx_flac_process_in_frame(fx_flac_t *inst) {
+static FX_FLAC_ALWAYS_INLINE bool _fx_flac_process_in_frame_ex(
+    fx_flac_t *inst, const bool crc16_, const bool verify_) {
 	int64_t tmp_; /* Used by the READ_BITS macro */
 	fx_flac_frame_header_t *fh = inst->frame_header;
 	fx_flac_subframe_header_t *sfh = inst->subframe_header;
 	int32_t *blk = inst->blkbuf[inst->chan_cur % FLAC_MAX_CHANNEL_COUNT];
 	const uint32_t blk_n = fh->block_size;
 
-	/* Figure out the number of bits to read for sample. This depends on the
-	   channel assignment. */
-	uint8_t bps = fh->sample_size - sfh->wasted_bits;
-	if ((fh->channel_assignment == LEFT_SIDE_STEREO && inst->chan_cur == 1) ||
-	    (fh->channel_assignment == RIGHT_SIDE_STEREO && inst->chan_cur == 0) ||
-	    (fh->channel_assignment == MID_SIDE_STEREO && inst->chan_cur == 1)) {
-		bps++;
-	}
+	/* Number of bits per sample, computed when reading the subframe header */
+	const uint8_t bps = sfh->bps;
+	const bool wide = sfh->wide;
 
-	/* Discard frames with invalid bits per sample values */
-	if (bps == 0U || bps > 32U) {
-		return _fx_flac_handle_err(inst);
-	}
+	/* Only parse the subframe in verify-only mode or if the channel is not
+	   needed */
+	const bool skip_ = verify_ || sfh->skip;
 
 	/* This flag is set to false whenever a state in the state machine
 	   encounters and error. */
 	switch (inst->priv_state) {
 		case FLAC_SUBFRAME_HEADER: {
 			ENSURE_BITS(40U);
+			if (_fx_flac_frame_oversized(inst)) {
+				return _fx_flac_handle_err(inst);
+			}
 
 			/* Reset the block write cursor, make sure initial blk sample is set
 			   to zero for zero-order fixed LPC */
@@ -1505,6 +2899,25 @@ static bool _fx_flac_process_in_frame(fx_flac_t *inst) {
 				        (sfh->wasted_bits < fh->sample_size);
 			}
 
+			/* Figure out the number of bits to read per sample. This depends
+			   on the channel assignment; side channels carry an additional
+			   bit. For 32-bit streams this results in 33-bit samples. */
+			const fx_flac_channel_assignment_t ca = fh->channel_assignment;
+			sfh->bps = fh->sample_size - sfh->wasted_bits;
+			if ((ca == LEFT_SIDE_STEREO && inst->chan_cur == 1) ||
+			    (ca == RIGHT_SIDE_STEREO && inst->chan_cur == 0) ||
+			    (ca == MID_SIDE_STEREO && inst->chan_cur == 1)) {
+				sfh->bps++;
+			}
+			sfh->wide = (sfh->bps + sfh->wasted_bits) > 32U;
+
+			/* Skip channels excluded by the channel mask, unless they are
+			   required to decorrelate the other channel of a stereo pair */
+			const uint8_t needed = (ca >= LEFT_SIDE_STEREO)
+			                           ? 0x03U
+			                           : (uint8_t)(1U << inst->chan_cur);
+			sfh->skip = inst->frame_skip || !(inst->channel_mask & needed);
+
 			/* Make sure the block is large enough for the initial samples */
 			valid = valid && (blk_n >= sfh->order);
 			if (!valid) {
@@ -1513,13 +2926,22 @@ static bool _fx_flac_process_in_frame(fx_flac_t *inst) {
 			break;
 		}
 		case FLAC_SUBFRAME_CONSTANT: {
-			/* Read a single sample value and spread it over the entire block
-			   buffer for this subframe. */
-			blk[0U] = READ_BITS_CRC(bps);
-			blk[0U] = SIGN_EXTEND(blk[0U], bps);
-			for (uint16_t i = 1U; i < blk_n; i++) {
-				blk[i] = blk[0U];
+			/* Read a single sample value; 33-bit values are spread over the
+			   entire block buffer right away. */
+			READ_BITS_CRC(bps);
+			const int64_t value = SIGN_EXTEND(tmp_, bps);
+			if (wide) {
+				for (uint32_t i = 0U; !skip_ && i < blk_n; i++) {
+					_fx_flac_wide_set(blk, inst->widebuf, i, value);
+				}
+				inst->priv_state = FLAC_SUBFRAME_FINALIZE;
+				break;
 			}
+
+			/* Only remember the value; the block buffer is filled once the
+			   entire frame has been read, if at all */
+			inst->const_mask |= (uint8_t)(1U << inst->chan_cur);
+			inst->const_val[inst->chan_cur] = (int32_t)value;
 			inst->priv_state = FLAC_SUBFRAME_FINALIZE;
 			break;
 		}
@@ -1528,9 +2950,27 @@ static bool _fx_flac_process_in_frame(fx_flac_t *inst) {
 		case FLAC_SUBFRAME_LPC: {
 			/* Either just read up to "order" samples, or the entire block */
 			const uint32_t n = (sfh->type == SFT_VERBATIM) ? blk_n : sfh->order;
+			if (skip_) {
+				/* Skip as many samples as possible at once */
+				const uint8_t n_per_read = 57U / bps;
+				while (inst->blk_cur < n) {
+					uint32_t m = n - inst->blk_cur;
+					m = (m > n_per_read) ? n_per_read : m;
+					READ_BITS_CRC(m * bps);
+					inst->blk_cur += m;
+				}
+			}
+			if (wide) {
+				while (inst->blk_cur < n) {
+					READ_BITS_CRC(bps);
+					_fx_flac_wide_set(blk, inst->widebuf, inst->blk_cur,
+					                  SIGN_EXTEND(tmp_, bps));
+					inst->blk_cur++;
+				}
+			}
 			while (inst->blk_cur < n) {
-				blk[inst->blk_cur] = READ_BITS_CRC(bps);
-				blk[inst->blk_cur] = SIGN_EXTEND(blk[inst->blk_cur], bps);
+				READ_BITS_CRC(bps);
+				blk[inst->blk_cur] = (int32_t)(SIGN_EXTEND(tmp_, bps));
 				inst->blk_cur++;
 			}
 			inst->priv_state =
@@ -1582,6 +3022,9 @@ static bool _fx_flac_process_in_frame(fx_flac_t *inst) {
 		case FLAC_SUBFRAME_RICE_INIT: {
 			/* Read the Rice parameter */
 			ENSURE_BITS(10U);
+			if (_fx_flac_frame_oversized(inst)) {
+				return _fx_flac_handle_err(inst);
+			}
 
 			uint8_t n_bits = (sfh->residual_method == RES_RICE) ? 4U : 5U;
 			sfh->rice_parameter = READ_BITS_FAST_CRC(n_bits);
@@ -1613,6 +3056,71 @@ static bool _fx_flac_process_in_frame(fx_flac_t *inst) {
 		}
 		case FLAC_SUBFRAME_RICE:
 		case FLAC_SUBFRAME_RICE_UNARY:
+			/* In verify-only mode or for masked channels, skip over the rice
+			   samples without decoding them. Runs of zeros in the unary part
+			   are skipped using the bits already present in the bitstream
+			   buffer. */
+			while (skip_ && inst->partition_sample > 0U) {
+				fx_bitstream_t *bs = &inst->bitstream;
+				const uint8_t k = sfh->rice_parameter;
+
+				/* Fast path: skip all complete codes in the buffered bits */
+				if (inst->priv_state == FLAC_SUBFRAME_RICE_UNARY &&
+				    bs->pos < BUFSIZE) {
+					const uint8_t n_avail = BUFSIZE - bs->pos;
+					const uint64_t bits = bs->buf << bs->pos;
+					uint8_t n_bits = 0U;
+					uint16_t n_smpls = 0U;
+					while (n_smpls < inst->partition_sample) {
+						const uint64_t rem = bits << n_bits;
+						if (!rem) {
+							break;
+						}
+						const uint8_t len = _fx_flac_clz64(rem) + 1U + k;
+						if (n_bits + len > n_avail || n_bits + len > 57U) {
+							break;
+						}
+						n_bits += len;
+						n_smpls++;
+					}
+					if (n_smpls > 0U) {
+						READ_BITS_FAST_CRC(n_bits);
+						inst->blk_cur += n_smpls;
+						inst->partition_sample -= n_smpls;
+						continue;
+					}
+				}
+
+				/* Slow path: codes crossing the end of the buffered bits */
+				while (inst->priv_state == FLAC_SUBFRAME_RICE_UNARY) {
+					const uint8_t n_avail = BUFSIZE - bs->pos;
+					if (n_avail == 0U) {
+						return false; /* Need more data */
+					}
+					const uint64_t bits = bs->buf << bs->pos;
+					const uint8_t n_zeros = bits ? _fx_flac_clz64(bits) : 64U;
+					if (n_zeros >= n_avail) {
+						/* A single read is limited to 57 bits */
+						if (n_avail / 2U > 0U) {
+							READ_BITS_FAST_CRC(n_avail / 2U);
+						}
+						READ_BITS_FAST_CRC(n_avail - n_avail / 2U);
+						continue;
+					}
+					if (n_zeros > 0U) {
+						READ_BITS_FAST_CRC(n_zeros);
+					}
+					READ_BITS_FAST_CRC(1U);
+					inst->priv_state = FLAC_SUBFRAME_RICE;
+				}
+				if (k > 0U) {
+					READ_BITS_CRC(k);
+				}
+				inst->priv_state = FLAC_SUBFRAME_RICE_UNARY;
+				inst->blk_cur++;
+				inst->partition_sample--;
+			}
+
 			/* Read the individual rice samples */
 			while (inst->partition_sample > 0U) {
 				/* Read the unary part of the Rice encoded sample bit-by-bit */
@@ -1635,7 +3143,7 @@ static bool _fx_flac_process_in_frame(fx_flac_t *inst) {
 				if (sfh->rice_parameter > 0U) {
 					r = READ_BITS_CRC(sfh->rice_parameter);
 				}
-				const uint16_t q = inst->rice_unary_counter;
+				const uint32_t q = inst->rice_unary_counter;
 				const uint32_t val = (q << sfh->rice_parameter) | r;
 
 				/* Last bit determines sign */
@@ -1656,6 +3164,16 @@ static bool _fx_flac_process_in_frame(fx_flac_t *inst) {
 		case FLAC_SUBFRAME_RICE_VERBATIM: {
 			/* Samples are encoded in verbatim in this partition */
 			const uint8_t bps = sfh->rice_parameter;
+			while (skip_ && inst->partition_sample > 0U) {
+				uint32_t m = inst->partition_sample;
+				if (bps > 0U) {
+					const uint32_t n_per_read = 57U / bps;
+					m = (m > n_per_read) ? n_per_read : m;
+					READ_BITS_CRC(m * bps);
+				}
+				inst->blk_cur += m;
+				inst->partition_sample -= m;
+			}
 			while (inst->partition_sample > 0U) {
 				blk[inst->blk_cur] = (bps == 0) ? 0U : READ_BITS_CRC(bps);
 				blk[inst->blk_cur] = SIGN_EXTEND(blk[inst->blk_cur], bps);
@@ -1670,8 +3188,16 @@ static bool _fx_flac_process_in_frame(fx_flac_t *inst) {
 			inst->partition_cur++;
 			if (inst->partition_cur == (1U << sfh->rice_partition_order)) {
 				/* Decode the residual */
-				_fx_flac_restore_lpc_signal(blk, blk_n, sfh->lpc_coeffs,
-				                            sfh->order, sfh->lpc_shift);
+				if (skip_) {
+					/* Signal reconstruction is not required */
+				} else if (wide) {
+					_fx_flac_restore_lpc_signal_wide(
+					    blk, inst->widebuf, blk_n, sfh->lpc_coeffs, sfh->order,
+					    sfh->lpc_shift);
+				} else {
+					_fx_flac_restore_lpc_signal(blk, blk_n, sfh->lpc_coeffs,
+					                            sfh->order, sfh->lpc_shift);
+				}
 				inst->priv_state = FLAC_SUBFRAME_FINALIZE;
 			} else {
 				inst->priv_state = FLAC_SUBFRAME_RICE_INIT;
@@ -1679,10 +3205,18 @@ static bool _fx_flac_process_in_frame(fx_flac_t *inst) {
 			break;
 		case FLAC_SUBFRAME_FINALIZE: {
 			/* Apply the wasted bits transformation */
-			if (sfh->wasted_bits) {
+			if (skip_) {
+				/* Signal reconstruction is not required */
+			} else if (inst->const_mask & (1U << inst->chan_cur)) {
+				int32_t *v = &inst->const_val[inst->chan_cur];
+				*v = (int32_t)((uint32_t)*v << sfh->wasted_bits);
+			} else if (sfh->wasted_bits && wide) {
+				_fx_flac_shift_wide(blk, inst->widebuf, blk_n,
+				                    sfh->wasted_bits);
+			} else if (sfh->wasted_bits) {
 				uint8_t shift = sfh->wasted_bits;
 				for (uint16_t i = 0U; i < blk_n; i++) {
-					blk[i] = blk[i] * (1 << shift);
+					blk[i] = (int32_t)((uint32_t)blk[i] << shift);
 				}
 			}
 
@@ -1698,16 +3232,79 @@ static bool _fx_flac_process_in_frame(fx_flac_t *inst) {
 
 			/* Read the CRC16 sum, resync if it doesn't match our own */
 			uint16_t crc16 = READ_BITS(16U);
-#ifndef FX_FLAC_NO_CRC
-			if (crc16 != inst->crc16) {
+			if (crc16_ && (crc16 != inst->crc16)) {
 				return _fx_flac_handle_err(inst);
 			}
-#else
-			(void)crc16;
-#endif
 
-			/* Post process side-stereo */
+			/* Remember where the next frame is expected */
+			const fx_flac_frame_info_t *fi = &inst->frame_info;
+			inst->next_sample = fi->first_sample + fi->n_samples;
+			inst->next_frame = fh->sync_info + 1U;
+			inst->next_offset = _fx_flac_stream_pos(inst);
+			inst->has_next_frame = true;
+
+			/* Without header, complete the STREAMINFO from the first valid
+			   frame; subsequent candidates must be consistent with it */
+			if (inst->headerless) {
+				fx_flac_streaminfo_t *si = inst->streaminfo;
+				if (!si->sample_rate) {
+					si->sample_rate = fh->sample_rate;
+				}
+				if (!si->sample_size) {
+					si->sample_size = fh->sample_size;
+				}
+				if (!si->n_channels) {
+					si->n_channels = fh->channel_count;
+				}
+			}
+
+			/* Report digital silence */
+			const uint8_t all = (uint8_t)((1U << fh->channel_count) - 1U);
+			if (inst->const_mask == all) {
+				bool silent = true;
+				for (uint8_t c = 0U; c < fh->channel_count; c++) {
+					silent = silent && (inst->const_val[c] == 0);
+				}
+				inst->frame_info.silent = silent;
+			}
+
+			/* In verify-only mode we're done, skip the output stage */
+			if (verify_) {
+				inst->blk_cur = 0U;
+				inst->chan_cur = 0U;
+				inst->state = FLAC_END_OF_FRAME;
+				break;
+			}
+
+			/* Frames before the selected range are not written */
+			if (inst->frame_skip) {
+				inst->blk_cur = 0U;
+				inst->chan_cur = 0U;
+				inst->state = FLAC_SEARCH_FRAME;
+				inst->priv_state = FLAC_FRAME_SYNC;
+				break;
+			}
+
+			/* Either keep entirely constant frames symbolic, or fill the
+			   block buffers of the constant channels */
+			if (inst->const_mask && _fx_flac_finalize_const(inst)) {
+				inst->blk_cur = inst->blk_begin; /* Reset the read cursor */
+				inst->chan_cur = 0U;
+				inst->state = FLAC_DECODED_FRAME;
+				break;
+			}
+
+			/* Use the specialised kernel for common stereo configurations */
 			int32_t *c1 = inst->blkbuf[0], *c2 = inst->blkbuf[1];
+			if (inst->stereo_kernel) {
+				inst->stereo_kernel(c1, c2, blk_n);
+				inst->blk_cur = inst->blk_begin; /* Reset the read cursor */
+				inst->chan_cur = 0U;
+				inst->state = FLAC_DECODED_FRAME;
+				break;
+			}
+
+			/* Post process side-stereo */
 			switch (fh->channel_assignment) {
 				case LEFT_SIDE_STEREO:
 					_fx_flac_post_process_left_side(c1, c2, blk_n);
@@ -1716,26 +3313,38 @@ static bool _fx_flac_process_in_frame(fx_flac_t *inst) {
 					_fx_flac_post_process_right_side(c1, c2, blk_n);
 					break;
 				case MID_SIDE_STEREO:
-					_fx_flac_post_process_mid_side(c1, c2, blk_n);
+					if (fh->sample_size == 32U) {
+						_fx_flac_post_process_mid_side_wide(c1, c2,
+						                                    inst->widebuf, blk_n);
+					} else {
+						_fx_flac_post_process_mid_side(c1, c2, blk_n);
+					}
 					break;
 				default:
 					break;
 			}
 
 			/* Shift the output such that the resulting int32 stream can be
-			   played back. */
+			   played back; apply gain and requantisation if requested. */
 			uint8_t shift = 32U - fh->sample_size;
-			if (shift) {
+			if (shift || inst->output_stage) {
 				for (uint8_t c = 0U; c < fh->channel_count; c++) {
+					if (!(inst->channel_mask & (1U << c))) {
+						continue; /* Not part of the output */
+					}
 					int32_t *blk = inst->blkbuf[c];
+					if (inst->output_stage) {
+						_fx_flac_output_stage(inst, blk, blk_n, shift, c);
+						continue;
+					}
 					for (uint16_t i = 0U; i < blk_n; i++) {
-						blk[i] = blk[i] * (1 << shift);
+						blk[i] = (int32_t)((uint32_t)blk[i] << shift);
 					}
 				}
 			}
 
 			/* We're done decoding this frame! Notify the outer loop! */
-			inst->blk_cur = 0U; /* Reset the read cursor */
+			inst->blk_cur = inst->blk_begin; /* Reset the read cursor */
 			inst->chan_cur = 0U;
 			inst->state = FLAC_DECODED_FRAME;
 			break;
@@ -1747,6 +3356,337 @@ static bool _fx_flac_process_in_frame(fx_flac_t *inst) {
 	return true;
 }
 
+/* Frame decoder instances with and without frame checksum computation, as
+   well as the verify-only instance */
+
+static bool _fx_flac_process_in_frame_crc(fx_flac_t *inst) {
+	return _fx_flac_process_in_frame_ex(inst, true, false);
+}
+
+static bool _fx_flac_process_in_frame_no_crc(fx_flac_t *inst) {
+	return _fx_flac_process_in_frame_ex(inst, false, false);
+}
+
+static bool _fx_flac_process_in_frame_verify(fx_flac_t *inst) {
+	return _fx_flac_process_in_frame_ex(inst, true, true);
+}
+
+/**
+ * Variant of _fx_flac_process_decoded_frame() that mixes the channels using
+ * the downmix matrix while writing the output. Channels excluded by the
+ * channel mask are treated as silent. chan_cur is the current output channel.
+ */
+static bool _fx_flac_process_decoded_frame_mix(fx_flac_t *inst, int32_t *out,
+                                               uint32_t *out_len) {
+	const fx_flac_frame_header_t *fh = inst->frame_header;
+	const uint8_t cc = fh->channel_count;
+	const uint8_t n_out = inst->mix_n_out;
+	int32_t *const *blk = inst->blkbuf;
+	uint32_t i = inst->blk_cur;
+	uint8_t o = inst->chan_cur;
+	uint32_t tar = 0U; /* Number of samples written. */
+	const bool stage =
+	    (inst->gain != FLAC_GAIN_UNITY) || (inst->dither_shift != 0U);
+
+	/* Mix entire output tuples in small chunks, one output channel at a time.
+	   This skips zero coefficients (e.g. LFE or opposite-side channels) and
+	   allows the compiler to vectorise the inner loops. */
+	if (o == 0U) {
+		uint32_t n = (*out_len - tar) / n_out;
+		if (n > inst->blk_end - i) {
+			n = inst->blk_end - i;
+		}
+		while (n > 0U) {
+			const uint32_t m = (n > 64U) ? 64U : n;
+			for (uint8_t r = 0U; r < n_out; r++) {
+				const int16_t *row = inst->mix + r * cc;
+				int64_t acc[64];
+				for (uint32_t j = 0U; j < m; j++) {
+					acc[j] = 0;
+				}
+				for (uint8_t c = 0U; c < cc; c++) {
+					const int64_t coef =
+					    (inst->channel_mask & (1U << c)) ? row[c] : 0;
+					const int32_t *x = blk[c] + i;
+					for (uint32_t j = 0U; coef && j < m; j++) {
+						acc[j] += x[j] * coef;
+					}
+				}
+				for (uint32_t j = 0U; stage && j < m; j++) {
+					out[tar + j * n_out + r] =
+					    _fx_flac_output_sample(inst, acc[j] >> 14, r);
+				}
+				for (uint32_t j = 0U; !stage && j < m; j++) {
+					const int64_t v = acc[j] >> 14;
+					out[tar + j * n_out + r] = (v > INT32_MAX)   ? INT32_MAX
+					                           : (v < INT32_MIN) ? INT32_MIN
+					                                             : (int32_t)v;
+				}
+			}
+			i += m;
+			tar += m * n_out;
+			n -= m;
+		}
+	}
+
+	/* Mix the remaining samples one at a time */
+	while (tar < *out_len && i < inst->blk_end) {
+		const int16_t *row = inst->mix + o * cc;
+		int64_t acc = 0;
+		for (uint8_t c = 0U; c < cc; c++) {
+			if (inst->channel_mask & (1U << c)) {
+				acc += (int64_t)blk[c][i] * row[c];
+			}
+		}
+		acc >>= 14;
+		if (stage) {
+			out[tar++] = _fx_flac_output_sample(inst, acc, o);
+		} else {
+			out[tar++] = (acc > INT32_MAX)   ? INT32_MAX
+			             : (acc < INT32_MIN) ? INT32_MIN
+			                                 : (int32_t)acc;
+		}
+		if (++o == n_out) {
+			o = 0U;
+			i++;
+		}
+	}
+	inst->blk_cur = i;
+	inst->chan_cur = o;
+
+	/* Inform the caller about the number of samples written */
+	*out_len = tar;
+
+	/* We're done with this frame! */
+	if (i == inst->blk_end) {
+		inst->state = FLAC_END_OF_FRAME;
+		return true;
+	}
+	return false;
+}
+
+/**
+ * Variant of _fx_flac_process_decoded_frame() that only writes the channels
+ * selected by the channel mask. chan_cur is the current output channel.
+ */
+static bool _fx_flac_process_decoded_frame_subset(fx_flac_t *inst,
+                                                  int32_t *out,
+                                                  uint32_t *out_len) {
+	const fx_flac_frame_header_t *fh = inst->frame_header;
+
+	/* Collect the selected channels */
+	const int32_t *chans[FLAC_MAX_CHANNEL_COUNT];
+	uint8_t n_sel = 0U;
+	for (uint8_t c = 0U; c < fh->channel_count; c++) {
+		if (inst->channel_mask & (1U << c)) {
+			chans[n_sel++] = inst->blkbuf[c];
+		}
+	}
+
+	/* Copy entire output tuples at once if possible */
+	uint32_t i = inst->blk_cur;
+	uint8_t o = inst->chan_cur;
+	uint32_t tar = 0U; /* Number of samples written. */
+	if (o == 0U && n_sel > 0U) {
+		uint32_t n = *out_len / n_sel;
+		if (n > inst->blk_end - i) {
+			n = inst->blk_end - i;
+		}
+		if (n_sel == 2U) {
+			_fx_flac_interleave_2(out, chans[0] + i, chans[1] + i, n);
+		} else {
+			for (uint8_t s = 0U; s < n_sel; s++) {
+				const int32_t *x = chans[s] + i;
+				for (uint32_t j = 0U; j < n; j++) {
+					out[j * n_sel + s] = x[j];
+				}
+			}
+		}
+		i += n;
+		tar = n * n_sel;
+	}
+	while (n_sel > 0U && tar < *out_len && i < inst->blk_end) {
+		out[tar++] = chans[o][i];
+		if (++o == n_sel) {
+			o = 0U;
+			i++;
+		}
+	}
+	inst->blk_cur = i;
+	inst->chan_cur = o;
+
+	/* Inform the caller about the number of samples written */
+	*out_len = tar;
+
+	/* We're done with this frame! */
+	if (n_sel == 0U || i == inst->blk_end) {
+		inst->state = FLAC_END_OF_FRAME;
+		return true;
+	}
+	return false;
+}
+
+/**
+ * Variant of _fx_flac_process_decoded_frame() for frames in which all
+ * channels are constant. Replicates the values of the channels selected by
+ * the channel mask. chan_cur is the current output channel.
+ */
+static bool _fx_flac_process_decoded_frame_const(fx_flac_t *inst,
+                                                 int32_t *out,
+                                                 uint32_t *out_len) {
+	const fx_flac_frame_header_t *fh = inst->frame_header;
+
+	/* Collect the values of the selected channels */
+	int32_t vals[FLAC_MAX_CHANNEL_COUNT];
+	uint8_t n_sel = 0U;
+	for (uint8_t c = 0U; c < fh->channel_count; c++) {
+		if (inst->channel_mask & (1U << c)) {
+			vals[n_sel++] = inst->const_val[c];
+		}
+	}
+
+	/* Fill entire output tuples at once if possible */
+	uint32_t i = inst->blk_cur;
+	uint8_t o = inst->chan_cur;
+	uint32_t tar = 0U; /* Number of samples written. */
+	if (o == 0U && n_sel > 0U) {
+		uint32_t n = *out_len / n_sel;
+		if (n > inst->blk_end - i) {
+			n = inst->blk_end - i;
+		}
+		if (n_sel == 1U) {
+			for (uint32_t j = 0U; j < n; j++) {
+				out[j] = vals[0];
+			}
+		} else if (n_sel == 2U) {
+			for (uint32_t j = 0U; j < n; j++) {
+				out[2U * j] = vals[0];
+				out[2U * j + 1U] = vals[1];
+			}
+		} else {
+			for (uint32_t j = 0U; j < n; j++) {
+				for (uint8_t s = 0U; s < n_sel; s++) {
+					out[j * n_sel + s] = vals[s];
+				}
+			}
+		}
+		i += n;
+		tar = n * n_sel;
+	}
+	while (n_sel > 0U && tar < *out_len && i < inst->blk_end) {
+		out[tar++] = vals[o];
+		if (++o == n_sel) {
+			o = 0U;
+			i++;
+		}
+	}
+	inst->blk_cur = i;
+	inst->chan_cur = o;
+
+	/* Inform the caller about the number of samples written */
+	*out_len = tar;
+
+	/* We're done with this frame! */
+	if (n_sel == 0U || i == inst->blk_end) {
+		inst->state = FLAC_END_OF_FRAME;
+		return true;
+	}
+	return false;
+}
+
+/**
+ * Resets the accumulators of the current peak bucket.
+ */
+static void _fx_flac_reset_peaks(fx_flac_t *inst) {
+	for (uint8_t c = 0U; c < FLAC_MAX_CHANNEL_COUNT; c++) {
+		inst->peak_acc[c].min = INT32_MAX;
+		inst->peak_acc[c].max = INT32_MIN;
+		inst->peak_acc[c].sum_sq = 0U;
+	}
+	inst->peak_n = 0U;
+}
+
+/**
+ * Writes the current peak bucket of a stream with cc channels to the peak
+ * array and starts a new bucket. Returns false if the array is full.
+ */
+static bool _fx_flac_write_peaks(fx_flac_t *inst, uint8_t cc) {
+	if (inst->peaks_len - inst->peaks_cnt < cc) {
+		return false;
+	}
+	fx_flac_peak_t *tar = inst->peaks + inst->peaks_cnt;
+	for (uint8_t c = 0U; c < cc; c++) {
+		if (inst->channel_mask & (1U << c)) {
+			tar[c] = inst->peak_acc[c];
+		} else {
+			tar[c].min = 0;
+			tar[c].max = 0;
+			tar[c].sum_sq = 0U;
+		}
+	}
+	inst->peaks_cnt += cc;
+	_fx_flac_reset_peaks(inst);
+	return true;
+}
+
+/**
+ * Variant of _fx_flac_process_decoded_frame() used in peak mode. Adds the
+ * decoded samples to the peak buckets instead of writing them to the output.
+ */
+static bool _fx_flac_process_decoded_frame_peaks(fx_flac_t *inst) {
+	const fx_flac_frame_header_t *fh = inst->frame_header;
+	const uint8_t cc = fh->channel_count;
+	uint32_t i = inst->blk_cur;
+	while (i < inst->blk_end) {
+		/* Process the samples up to the end of the current bucket */
+		uint32_t n = inst->blk_end - i;
+		if (n > inst->peak_bucket - inst->peak_n) {
+			n = inst->peak_bucket - inst->peak_n;
+		}
+
+		/* Make sure there is space for the bucket once it is complete */
+		const bool complete = (inst->peak_n + n) == inst->peak_bucket;
+		if (complete && (inst->peaks_len - inst->peaks_cnt < cc)) {
+			inst->blk_cur = i;
+			return false;
+		}
+
+		for (uint8_t c = 0U; c < cc; c++) {
+			if (!(inst->channel_mask & (1U << c))) {
+				continue; /* Not reconstructed */
+			}
+			fx_flac_peak_t *acc = &inst->peak_acc[c];
+			if (inst->frame_const) {
+				const int32_t x = inst->const_val[c], y = x >> 16;
+				acc->min = (x < acc->min) ? x : acc->min;
+				acc->max = (x > acc->max) ? x : acc->max;
+				acc->sum_sq += (uint64_t)n * (uint32_t)(y * y);
+				continue;
+			}
+			const int32_t *x = inst->blkbuf[c] + i;
+			int32_t lo = acc->min, hi = acc->max;
+			uint64_t sum_sq = 0U;
+			for (uint32_t j = 0U; j < n; j++) {
+				const int32_t y = x[j] >> 16;
+				lo = (x[j] < lo) ? x[j] : lo;
+				hi = (x[j] > hi) ? x[j] : hi;
+				sum_sq += (uint32_t)(y * y);
+			}
+			acc->min = lo;
+			acc->max = hi;
+			acc->sum_sq += sum_sq;
+		}
+		i += n;
+		inst->peak_n += n;
+		if (complete) {
+			_fx_flac_write_peaks(inst, cc);
+		}
+	}
+	inst->blk_cur = i;
+	inst->state = FLAC_END_OF_FRAME;
+	return true;
+}
+
 static bool _fx_flac_process_decoded_frame(fx_flac_t *inst, int32_t *out,
                                            uint32_t *out_len) {
 	/* Fetch the current stream and frame info. */
@@ -1754,16 +3694,44 @@ static bool _fx_flac_process_decoded_frame(fx_flac_t *inst, int32_t *out,
 
 	/* Fetch channel count and number of samples left to write */
 	const uint8_t cc = fh->channel_count;
+	if (inst->frame_const) {
+		return _fx_flac_process_decoded_frame_const(inst, out, out_len);
+	}
+	if (_fx_flac_prepare_downmix(inst, cc)) {
+		return _fx_flac_process_decoded_frame_mix(inst, out, out_len);
+	}
+	const uint8_t all = (uint8_t)((1U << cc) - 1U);
+	if ((inst->channel_mask & all) != all) {
+		return _fx_flac_process_decoded_frame_subset(inst, out, out_len);
+	}
 	uint32_t n_smpls_rem =
-	    (fh->block_size - inst->blk_cur - 1U) * cc + (cc - inst->chan_cur);
+	    (inst->blk_end - inst->blk_cur - 1U) * cc + (cc - inst->chan_cur);
 
 	/* Truncate to the actually available space. */
 	if (n_smpls_rem > *out_len) {
 		n_smpls_rem = *out_len;
 	}
 
-	/* Interlace the decoded samples in the output array */
+	/* Interlace the decoded samples in the output array. Copy entire sample
+	   tuples at once for stereo, 5.1 and 7.1 streams if possible. */
 	uint32_t tar = 0U; /* Number of samples written. */
+	if (inst->chan_cur == 0U && (cc == 2U || cc == 6U || cc == 8U)) {
+		const uint32_t n = n_smpls_rem / cc;
+		switch (cc) {
+			case 2U:
+				_fx_flac_interleave_2(out, inst->blkbuf[0] + inst->blk_cur,
+				                      inst->blkbuf[1] + inst->blk_cur, n);
+				break;
+			case 6U:
+				_fx_flac_interleave_6(out, inst->blkbuf, inst->blk_cur, n);
+				break;
+			default:
+				_fx_flac_interleave_8(out, inst->blkbuf, inst->blk_cur, n);
+				break;
+		}
+		inst->blk_cur += n;
+		tar = cc * n;
+	}
 	while (tar < n_smpls_rem) {
 		/* Write to the output buffer */
 		out[tar] = inst->blkbuf[inst->chan_cur][inst->blk_cur];
@@ -1781,7 +3749,7 @@ static bool _fx_flac_process_decoded_frame(fx_flac_t *inst, int32_t *out,
 	*out_len = tar;
 
 	/* We're done with this frame! */
-	if (inst->blk_cur == fh->block_size) {
+	if (inst->blk_cur == inst->blk_end) {
 		inst->state = FLAC_END_OF_FRAME;
 		return true;
 	}
@@ -1790,40 +3758,257 @@ static bool _fx_flac_process_decoded_frame(fx_flac_t *inst, int32_t *out,
 	return false;
 }
 
+/**
+ * Writes the replacement samples for the current gap in the same way as
+ * decoded samples. Once the gap is filled, continues with decoding the frame
+ * following the gap, unless that frame is past the selected range.
+ */
+static bool _fx_flac_process_gap(fx_flac_t *inst, int32_t *out,
+                                 uint32_t *out_len) {
+	const uint32_t out_max = *out_len;
+	*out_len = 0U;
+	while (true) {
+		/* Generate the next chunk once the current one has been written */
+		if (inst->blk_cur == inst->blk_end) {
+			if (!inst->conceal_rem) {
+				inst->blk_begin = inst->conceal_blk_begin;
+				inst->blk_end = inst->conceal_blk_end;
+				inst->blk_cur = 0U;
+				inst->chan_cur = 0U;
+				inst->state =
+				    (inst->frame_info.first_sample >= inst->range_end)
+				        ? FLAC_END_OF_RANGE
+				        : FLAC_IN_FRAME;
+				return true;
+			}
+			_fx_flac_fill_gap(inst);
+		}
+
+		/* The output functions signal the end of each chunk by switching to
+		   the FLAC_END_OF_FRAME state */
+		bool ok = true;
+		if (inst->peak_bucket) {
+			ok = _fx_flac_process_decoded_frame_peaks(inst);
+		} else if (!out) {
+			inst->blk_cur = inst->blk_end; /* Discard the samples */
+		} else {
+			uint32_t n = out_max - *out_len;
+			ok = _fx_flac_process_decoded_frame(inst, out + *out_len, &n);
+			*out_len += n;
+		}
+		inst->state = FLAC_FRAME_CORRUPT;
+		if (!ok) {
+			return false;
+		}
+	}
+}
+
 /******************************************************************************
- * PUBLIC API                                                                 *
+ * Stream probing                                                             *
  ******************************************************************************/
 
-uint32_t fx_flac_size(uint32_t max_block_size, uint8_t max_channels) {
-	/* Calculate the size of the fixed-size structures */
-	uint32_t size;
-	bool ok = _fx_flac_check_params(max_block_size, max_channels) &&
-	          fx_mem_init_size(&size) &&
-	          fx_mem_update_size(&size, sizeof(fx_flac_t)) &&
-	          fx_mem_update_size(&size, sizeof(fx_flac_metadata_t)) &&
-	          fx_mem_update_size(&size, sizeof(fx_flac_streaminfo_t)) &&
-	          fx_mem_update_size(&size, sizeof(fx_flac_frame_header_t)) &&
-	          fx_mem_update_size(&size, sizeof(fx_flac_subframe_header_t)) &&
-	          fx_mem_update_size(&size, sizeof(int32_t) * 32U);
+/**
+ * Size of the "fLaC" marker, the metadata block header and the STREAMINFO
+ * block.
+ */
+#define FX_FLAC_PROBE_HEADER_SIZE 42U
 
-	/* Calculate the size of the structures depending on the given parameters.
-	 */
-	for (uint8_t i = 0; i < max_channels; i++) {
-		ok = ok && fx_mem_update_size(&size, sizeof(int32_t) * max_block_size);
+static inline uint32_t _fx_flac_read_be(const uint8_t *p, uint8_t n) {
+	uint32_t v = 0U;
+	for (uint8_t i = 0U; i < n; i++) {
+		v = (v << 8U) | p[i];
 	}
-	return ok ? size : 0;
+	return v;
 }
 
-fx_flac_t *fx_flac_init(void *mem, uint16_t max_block_size,
-                        uint8_t max_channels) {
-	/* Make sure the parameters are valid. */
-	if (!_fx_flac_check_params(max_block_size, max_channels)) {
-		return NULL;
+/**
+ * Parses the 34 bytes of a STREAMINFO metadata block.
+ */
+static void _fx_flac_parse_streaminfo(const uint8_t *p,
+                                      fx_flac_streaminfo_t *si) {
+	si->min_block_size = (uint16_t)_fx_flac_read_be(p, 2U);
+	si->max_block_size = (uint16_t)_fx_flac_read_be(p + 2U, 2U);
+	si->min_frame_size = _fx_flac_read_be(p + 4U, 3U);
+	si->max_frame_size = _fx_flac_read_be(p + 7U, 3U);
+	si->sample_rate = _fx_flac_read_be(p + 10U, 3U) >> 4U;
+	si->n_channels = ((p[12] >> 1U) & 0x07U) + 1U;
+	si->sample_size = (((p[12] & 0x01U) << 4U) | (p[13] >> 4U)) + 1U;
+	si->n_samples =
+	    ((uint64_t)(p[13] & 0x0FU) << 32U) | _fx_flac_read_be(p + 14U, 4U);
+	for (uint8_t i = 0U; i < 16U; i++) {
+		si->md5_sum[i] = p[18U + i];
 	}
+}
 
-	/* Abort if mem is NULL to allow passing malloc as a direct argument to this
-	   code. Furthermore, store the original "mem" pointer and return it later
-	   so the calling code is safe to pass the returned pointer to free. */
+/**
+ * Returns the size of the ID3v2 tag at the beginning of buf, or zero if
+ * there is none.
+ */
+static uint32_t _fx_flac_id3v2_size(const uint8_t *buf, uint32_t len) {
+	if ((len < 10U) || (buf[0] != 'I') || (buf[1] != 'D') || (buf[2] != '3')) {
+		return 0U;
+	}
+	uint32_t size = 0U;
+	for (uint8_t i = 6U; i < 10U; i++) {
+		if (buf[i] & 0x80U) {
+			return 0U; /* Not a synchsafe integer */
+		}
+		size = (size << 7U) | buf[i];
+	}
+	return size + ((buf[5] & 0x10U) ? 20U : 10U); /* Header and footer */
+}
+
+/**
+ * Returns the number of bytes at the end of buf occupied by ID3v1 and APEv2
+ * tags.
+ */
+static uint32_t _fx_flac_trailer_size(const uint8_t *buf, uint32_t len) {
+	const uint64_t size = fx_flac_probe_trailer(buf, len);
+	return (size > len) ? len : (uint32_t)size;
+}
+
+/**
+ * Parses the frame header at the beginning of buf and checks it against the
+ * stream format. Returns the size of the header including its CRC-8, or zero
+ * if there is no valid header.
+ */
+static uint32_t _fx_flac_probe_frame(const uint8_t *buf, uint32_t len,
+                                     const fx_flac_probe_t *info,
+                                     uint64_t *first_sample,
+                                     uint32_t *block_size) {
+	if ((len < 6U) || (buf[0] != 0xFFU) || ((buf[1] & 0xFEU) != 0xF8U) ||
+	    (buf[3] & 0x01U) || ((buf[3] >> 4U) > MID_SIDE_STEREO)) {
+		return 0U;
+	}
+	const bool variable = buf[1] & 0x01U;
+	const uint8_t block_size_enum = buf[2] >> 4U;
+	const uint8_t sample_rate_enum = buf[2] & 0x0FU;
+	uint32_t sample_rate = info->sample_rate;
+	uint8_t sample_size = info->sample_size, channel_count = 0U;
+	*block_size = 0U;
+	if (!_fx_flac_decode_block_size(
+	        (fx_flac_block_size_t)block_size_enum, block_size) ||
+	    !_fx_flac_decode_sample_rate(
+	        (fx_flac_sample_rate_t)sample_rate_enum, &sample_rate) ||
+	    !_fx_flac_decode_sample_size(
+	        (fx_flac_sample_size_t)((buf[3] >> 1U) & 0x07U), &sample_size) ||
+	    !_fx_flac_decode_channel_count(
+	        (fx_flac_channel_assignment_t)(buf[3] >> 4U), &channel_count)) {
+		return 0U;
+	}
+
+	/* Decode the UTF-8 coded frame or sample number */
+	uint32_t i = 4U;
+	uint8_t v = buf[i++], n_ones = 0U;
+	while (v & 0x80U) {
+		v = v << 1U;
+		n_ones++;
+	}
+	if ((n_ones == 1U) || (n_ones > (variable ? 7U : 6U)) ||
+	    (len < i + n_ones + 4U)) {
+		return 0U;
+	}
+	uint64_t sync_info = v >> n_ones;
+	for (uint8_t j = 1U; j < n_ones; j++) {
+		if ((buf[i] & 0xC0U) != 0x80U) {
+			return 0U;
+		}
+		sync_info = (sync_info << 6U) | (buf[i++] & 0x3FU);
+	}
+
+	/* Read the block size and sample rate stored after the header */
+	switch (block_size_enum) {
+		case BLK_SIZE_READ_8BIT:
+			*block_size = 1U + _fx_flac_read_be(buf + i, 1U);
+			i += 1U;
+			break;
+		case BLK_SIZE_READ_16BIT:
+			*block_size = 1U + _fx_flac_read_be(buf + i, 2U);
+			i += 2U;
+			break;
+		default:
+			break;
+	}
+	switch (sample_rate_enum) {
+		case FS_READ_8BIT_KHZ:
+			sample_rate = 1000U * _fx_flac_read_be(buf + i, 1U);
+			i += 1U;
+			break;
+		case FS_READ_16BIT_HZ:
+			sample_rate = _fx_flac_read_be(buf + i, 2U);
+			i += 2U;
+			break;
+		case FS_READ_16BIT_DHZ:
+			sample_rate = 10U * _fx_flac_read_be(buf + i, 2U);
+			i += 2U;
+			break;
+		default:
+			break;
+	}
+
+	/* Check the CRC-8 and the consistency with the STREAMINFO block */
+	uint8_t crc8 = 0U;
+	for (uint32_t j = 0U; j < i; j++) {
+		crc8 = fx_flac_crc8_table_[crc8 ^ buf[j]];
+	}
+	if ((crc8 != buf[i]) || (sample_rate != info->sample_rate) ||
+	    (sample_size != info->sample_size) ||
+	    (channel_count != info->n_channels) ||
+	    (info->max_block_size && (*block_size > info->max_block_size))) {
+		return 0U;
+	}
+
+	/* Compute the index of the first sample, see FLAC_FRAME_HEADER_CRC */
+	if (variable) {
+		*first_sample = sync_info;
+	} else if (info->max_block_size > 0U) {
+		*first_sample = sync_info * info->max_block_size;
+	} else {
+		*first_sample = sync_info * *block_size;
+	}
+	return i + 1U;
+}
+
+/******************************************************************************
+ * PUBLIC API                                                                 *
+ ******************************************************************************/
+
+static uint32_t _fx_flac_size(uint32_t max_block_size, uint8_t max_channels,
+                              bool planar) {
+	/* Calculate the size of the fixed-size structures */
+	uint32_t size;
+	bool ok = _fx_flac_check_params(max_block_size, max_channels) &&
+	          fx_mem_init_size(&size) &&
+	          fx_mem_update_size(&size, sizeof(fx_flac_t)) &&
+	          fx_mem_update_size(&size, sizeof(fx_flac_metadata_t)) &&
+	          fx_mem_update_size(&size, sizeof(fx_flac_streaminfo_t)) &&
+	          fx_mem_update_size(&size, sizeof(fx_flac_frame_header_t)) &&
+	          fx_mem_update_size(&size, sizeof(fx_flac_subframe_header_t)) &&
+	          fx_mem_update_size(&size, sizeof(int32_t) * 32U) &&
+	          fx_mem_update_size(&size,
+	                             sizeof(uint32_t) * ((max_block_size + 31U) / 32U));
+
+	/* Calculate the size of the structures depending on the given parameters.
+	 */
+	for (uint8_t i = 0; !planar && i < max_channels; i++) {
+		ok = ok && fx_mem_update_size(&size, sizeof(int32_t) * max_block_size);
+	}
+	ok = ok && (planar || fx_mem_update_size(&size, sizeof(int32_t) *
+	                                                     FX_FLAC_CONCEAL_TAIL *
+	                                                     max_channels));
+	return ok ? size : 0;
+}
+
+static fx_flac_t *_fx_flac_init(void *mem, uint16_t max_block_size,
+                                uint8_t max_channels, bool planar) {
+	/* Make sure the parameters are valid. */
+	if (!_fx_flac_check_params(max_block_size, max_channels)) {
+		return NULL;
+	}
+
+	/* Abort if mem is NULL to allow passing malloc as a direct argument to this
+	   code. Furthermore, store the original "mem" pointer and return it later
+	   so the calling code is safe to pass the returned pointer to free. */
 	fx_flac_t *inst_unaligned = (fx_flac_t *)mem;
 	if (mem) {
 		/* Fetch the base address of the flac_t address. */
@@ -1832,6 +4017,33 @@ fx_flac_t *fx_flac_init(void *mem, uint16_t max_block_size,
 		/* Copy the given parameters */
 		inst->max_block_size = max_block_size;
 		inst->max_channels = max_channels;
+#ifdef FX_FLAC_NO_CRC
+		inst->crc_mode = FLAC_CRC_NONE;
+#else
+		inst->crc_mode = FLAC_CRC_FULL;
+#endif
+		inst->frame_crc_mode = inst->crc_mode;
+		inst->verify_only = false;
+		inst->packet = false;
+		inst->headerless = false;
+		inst->headerless_rate = 0U;
+		inst->headerless_size = 0U;
+		inst->planar = false;
+		inst->downmix = FLAC_DOWNMIX_NONE;
+		inst->mix_n_in = 0U;
+		inst->mix_n_out = 0U;
+		inst->channel_mask = FLAC_CHANNEL_MASK_ALL;
+		inst->range_first = 0U;
+		inst->range_end = FLAC_RANGE_END_OF_STREAM;
+		inst->gain = FLAC_GAIN_UNITY;
+		inst->dither_shift = 0U;
+		inst->dither = FLAC_DITHER_NONE;
+		inst->peak_bucket = 0U;
+		inst->peaks = NULL;
+		inst->peaks_len = 0U;
+		inst->peaks_cnt = 0U;
+		inst->cuesheet = NULL;
+		inst->conceal = FLAC_CONCEAL_DROP;
 
 		/* Fetch the base addresses of the internal pointers. */
 		inst->metadata = (fx_flac_metadata_t *)fx_mem_align(
@@ -1843,15 +4055,26 @@ fx_flac_t *fx_flac_init(void *mem, uint16_t max_block_size,
 		inst->subframe_header = (fx_flac_subframe_header_t *)fx_mem_align(
 		    &mem, sizeof(fx_flac_subframe_header_t));
 		inst->qbuf = (int32_t *)fx_mem_align(&mem, sizeof(int32_t) * 32U);
+		inst->widebuf = (uint32_t *)fx_mem_align(
+		    &mem, sizeof(uint32_t) * ((max_block_size + 31U) / 32U));
 
-		/* Compute the addresses of the per-channel buffers */
+		/* Compute the addresses of the per-channel buffers. Planar instances
+		   decode into the buffers provided by the caller. */
 		for (uint8_t i = 0; i < FLAC_MAX_CHANNEL_COUNT; i++) {
-			inst->blkbuf[i] = NULL;
+			inst->blkbuf_own[i] = NULL;
 		}
-		for (uint8_t i = 0; i < max_channels; i++) {
-			inst->blkbuf[i] =
+		for (uint8_t i = 0; !planar && i < max_channels; i++) {
+			inst->blkbuf_own[i] =
 			    (int32_t *)fx_mem_align(&mem, sizeof(int32_t) * max_block_size);
 		}
+		for (uint8_t i = 0; i < FLAC_MAX_CHANNEL_COUNT; i++) {
+			inst->blkbuf[i] = inst->blkbuf_own[i];
+		}
+		inst->tailbuf = NULL;
+		if (!planar) {
+			inst->tailbuf = (int32_t *)fx_mem_align(
+			    &mem, sizeof(int32_t) * FX_FLAC_CONCEAL_TAIL * max_channels);
+		}
 
 		/* Reset the instance, i.e. zero most/all fields. */
 		fx_flac_reset(inst);
@@ -1860,6 +4083,24 @@ fx_flac_t *fx_flac_init(void *mem, uint16_t max_block_size,
 	return inst_unaligned;
 }
 
+uint32_t fx_flac_size(uint32_t max_block_size, uint8_t max_channels) {
+	return _fx_flac_size(max_block_size, max_channels, false);
+}
+
+fx_flac_t *fx_flac_init(void *mem, uint16_t max_block_size,
+                        uint8_t max_channels) {
+	return _fx_flac_init(mem, max_block_size, max_channels, false);
+}
+
+uint32_t fx_flac_size_planar(uint32_t max_block_size, uint8_t max_channels) {
+	return _fx_flac_size(max_block_size, max_channels, true);
+}
+
+fx_flac_t *fx_flac_init_planar(void *mem, uint16_t max_block_size,
+                               uint8_t max_channels) {
+	return _fx_flac_init(mem, max_block_size, max_channels, true);
+}
+
 void fx_flac_reset(fx_flac_t *inst) {
 	inst = (fx_flac_t *)FX_ALIGN_ADDR(inst);
 
@@ -1890,6 +4131,350 @@ void fx_flac_reset(fx_flac_t *inst) {
 	inst->rice_unary_counter = 0U;
 	inst->chan_cur = 0U;
 	inst->blk_cur = 0U;
+	inst->stereo_kernel = NULL;
+	inst->output_stage = false;
+	inst->const_mask = 0U;
+	inst->frame_const = false;
+	inst->dither_rng = 0x2545F491U;
+	for (uint8_t c = 0U; c < FLAC_MAX_CHANNEL_COUNT; c++) {
+		inst->dither_err[c] = 0;
+	}
+	_fx_flac_reset_peaks(inst);
+	inst->n_bytes_consumed = 0U;
+	inst->src_start = NULL;
+	inst->frame_info.offset = 0U;
+	inst->frame_info.first_sample = 0U;
+	inst->frame_info.n_samples = 0U;
+	inst->frame_skip = false;
+	inst->blk_begin = 0U;
+	inst->blk_end = 0U;
+	inst->frame_info.silent = false;
+	inst->corrupt_info = inst->frame_info;
+	inst->has_next_frame = false;
+	inst->has_resync = false;
+	inst->sync_stats.n_header_crc = 0U;
+	inst->sync_stats.n_inconsistent = 0U;
+	inst->sync_stats.n_discontinuous = 0U;
+	inst->sync_stats.n_oversized = 0U;
+	inst->conceal_rem = 0U;
+	inst->conceal_pos = 0U;
+	inst->conceal_fade = 0U;
+	inst->conceal_blk_begin = 0U;
+	inst->conceal_blk_end = 0U;
+	inst->tail_len = 0U;
+
+	/* Discard the cue sheet of the previous stream */
+	if (inst->cuesheet) {
+		_fx_flac_clear_cuesheet(inst->cuesheet);
+	}
+
+	/* Without header, start with the caller-provided defaults and search for
+	   the first frame */
+	if (inst->headerless) {
+		inst->streaminfo->sample_rate = inst->headerless_rate;
+		inst->streaminfo->sample_size = inst->headerless_size;
+		inst->state = FLAC_SEARCH_FRAME;
+		inst->priv_state = FLAC_FRAME_SYNC;
+	}
+}
+
+void fx_flac_flush(fx_flac_t *inst) {
+	inst = (fx_flac_t *)FX_ALIGN_ADDR(inst);
+
+	/* Without metadata there is nothing to retain; start anew */
+	if (inst->state < FLAC_END_OF_METADATA) {
+		fx_flac_reset(inst);
+		return;
+	}
+
+	/* Discard the bits buffered in the bitstream reader */
+	fx_bitstream_init(&inst->bitstream);
+
+	/* Search for the next frame */
+	inst->state = FLAC_SEARCH_FRAME;
+	inst->priv_state = FLAC_FRAME_SYNC;
+	inst->chan_cur = 0U;
+	inst->blk_cur = 0U;
+	inst->has_next_frame = false; /* Frames may be skipped intentionally */
+	inst->has_resync = false;
+	inst->conceal_rem = 0U;
+	inst->tail_len = 0U;
+}
+
+void fx_flac_set_crc_mode(fx_flac_t *inst, fx_flac_crc_mode_t mode) {
+	inst = (fx_flac_t *)FX_ALIGN_ADDR(inst);
+	inst->crc_mode = mode;
+}
+
+void fx_flac_set_verify_only(fx_flac_t *inst, bool verify_only) {
+	inst = (fx_flac_t *)FX_ALIGN_ADDR(inst);
+	inst->verify_only = verify_only;
+}
+
+bool fx_flac_set_headerless(fx_flac_t *inst, bool headerless,
+                            uint32_t sample_rate, uint8_t sample_size) {
+	inst = (fx_flac_t *)FX_ALIGN_ADDR(inst);
+	if ((sample_rate > 0xFFFFFU) || (sample_size > 32U) ||
+	    (sample_size > 0U && sample_size < 4U)) {
+		return false;
+	}
+	inst->headerless = headerless;
+	inst->headerless_rate = sample_rate;
+	inst->headerless_size = sample_size;
+	fx_flac_reset(inst);
+	return true;
+}
+
+bool fx_flac_set_concealment(fx_flac_t *inst, fx_flac_conceal_t policy) {
+	inst = (fx_flac_t *)FX_ALIGN_ADDR(inst);
+	switch (policy) {
+		case FLAC_CONCEAL_DROP:
+		case FLAC_CONCEAL_SILENCE:
+		case FLAC_CONCEAL_REPEAT:
+			inst->conceal = policy;
+			return true;
+		default:
+			return false;
+	}
+}
+
+bool fx_flac_set_downmix(fx_flac_t *inst, fx_flac_downmix_t mode) {
+	inst = (fx_flac_t *)FX_ALIGN_ADDR(inst);
+	switch (mode) {
+		case FLAC_DOWNMIX_NONE:
+		case FLAC_DOWNMIX_STEREO:
+		case FLAC_DOWNMIX_MONO:
+			inst->downmix = mode;
+			inst->mix_n_in = 0U; /* Recompute the matrix */
+			return true;
+		default:
+			return false;
+	}
+}
+
+bool fx_flac_set_downmix_matrix(fx_flac_t *inst, const int16_t *matrix,
+                                uint8_t n_in, uint8_t n_out) {
+	inst = (fx_flac_t *)FX_ALIGN_ADDR(inst);
+	if ((n_in == 0U) || (n_in > FLAC_MAX_CHANNEL_COUNT) || (n_out == 0U) ||
+	    (n_out > FLAC_MAX_CHANNEL_COUNT)) {
+		return false;
+	}
+	for (uint8_t i = 0U; i < n_in * n_out; i++) {
+		inst->mix[i] = matrix[i];
+	}
+	inst->downmix = FLAC_DOWNMIX_CUSTOM;
+	inst->mix_n_in = n_in;
+	inst->mix_n_out = n_out;
+	return true;
+}
+
+bool fx_flac_set_range(fx_flac_t *inst, uint64_t first, uint64_t end) {
+	inst = (fx_flac_t *)FX_ALIGN_ADDR(inst);
+	if (first >= end) {
+		return false;
+	}
+	inst->range_first = first;
+	inst->range_end = end;
+	return true;
+}
+
+bool fx_flac_set_gain(fx_flac_t *inst, int32_t gain) {
+	inst = (fx_flac_t *)FX_ALIGN_ADDR(inst);
+	if (gain < 0 || gain > FLAC_GAIN_MAX) {
+		return false;
+	}
+	inst->gain = gain;
+	return true;
+}
+
+bool fx_flac_set_output_depth(fx_flac_t *inst, uint8_t bits,
+                              fx_flac_dither_t dither) {
+	inst = (fx_flac_t *)FX_ALIGN_ADDR(inst);
+	if (bits > 32U) {
+		return false;
+	}
+	switch (dither) {
+		case FLAC_DITHER_NONE:
+		case FLAC_DITHER_TPDF:
+		case FLAC_DITHER_SHAPED:
+			inst->dither_shift = (bits == 0U) ? 0U : (uint8_t)(32U - bits);
+			inst->dither = dither;
+			return true;
+		default:
+			return false;
+	}
+}
+
+void fx_flac_set_channel_mask(fx_flac_t *inst, uint8_t mask) {
+	inst = (fx_flac_t *)FX_ALIGN_ADDR(inst);
+	inst->channel_mask = mask;
+}
+
+bool fx_flac_set_planar_output(fx_flac_t *inst, int32_t *const *channels) {
+	inst = (fx_flac_t *)FX_ALIGN_ADDR(inst);
+
+	/* Switch back to the internal buffers and interleaved output */
+	if (!channels) {
+		for (uint8_t i = 0; i < FLAC_MAX_CHANNEL_COUNT; i++) {
+			inst->blkbuf[i] = inst->blkbuf_own[i];
+		}
+		inst->planar = false;
+		return true;
+	}
+
+	/* The decoding functions rely on the buffers being aligned */
+	for (uint8_t i = 0; i < inst->max_channels; i++) {
+		if (!channels[i] || ((uintptr_t)channels[i] & (FX_ALIGN - 1U))) {
+			return false;
+		}
+	}
+	for (uint8_t i = 0; i < inst->max_channels; i++) {
+		inst->blkbuf[i] = channels[i];
+	}
+	inst->planar = true;
+	return true;
+}
+
+void fx_flac_set_peak_output(fx_flac_t *inst, uint32_t bucket_size,
+                             fx_flac_peak_t *peaks, uint32_t n_peaks) {
+	inst = (fx_flac_t *)FX_ALIGN_ADDR(inst);
+	if (!peaks) {
+		bucket_size = 0U;
+	}
+	if (bucket_size != inst->peak_bucket) {
+		_fx_flac_reset_peaks(inst);
+	}
+	inst->peak_bucket = bucket_size;
+	inst->peaks = peaks;
+	inst->peaks_len = peaks ? n_peaks : 0U;
+	inst->peaks_cnt = 0U;
+}
+
+void fx_flac_set_cuesheet_output(fx_flac_t *inst, fx_flac_cuesheet_t *cuesheet,
+                                 fx_flac_cue_track_t *tracks,
+                                 uint32_t n_tracks,
+                                 fx_flac_cue_index_t *indices,
+                                 uint32_t n_indices) {
+	inst = (fx_flac_t *)FX_ALIGN_ADDR(inst);
+	inst->cuesheet = cuesheet;
+	if (cuesheet) {
+		cuesheet->tracks = tracks;
+		cuesheet->indices = indices;
+		cuesheet->max_tracks = tracks ? n_tracks : 0U;
+		cuesheet->max_indices = indices ? n_indices : 0U;
+		_fx_flac_clear_cuesheet(cuesheet);
+	}
+}
+
+/**
+ * Returns the offset of the first sample of the given track, see
+ * fx_flac_cuesheet_track_range().
+ */
+static uint64_t _fx_flac_cue_track_start(const fx_flac_cuesheet_t *cs,
+                                         const fx_flac_cue_track_t *track) {
+	const fx_flac_cue_index_t *indices = cs->indices + track->first_index;
+	uint64_t offs = track->n_indices ? indices[0].offset : 0U;
+	for (uint8_t i = 0U; i < track->n_indices; i++) {
+		if (indices[i].number == 1U) {
+			offs = indices[i].offset;
+			break;
+		}
+	}
+	return track->offset + offs;
+}
+
+bool fx_flac_cuesheet_track_range(const fx_flac_cuesheet_t *cuesheet,
+                                  uint8_t number, uint64_t *first,
+                                  uint64_t *end) {
+	if (!cuesheet->valid || number == 170U || number == 255U) {
+		return false; /* The lead-out track contains no audio */
+	}
+	for (uint32_t i = 0U; i < cuesheet->n_tracks; i++) {
+		const fx_flac_cue_track_t *track = &cuesheet->tracks[i];
+		if (track->number != number) {
+			continue;
+		}
+		*first = _fx_flac_cue_track_start(cuesheet, track);
+		*end = (i + 1U < cuesheet->n_tracks)
+		           ? _fx_flac_cue_track_start(cuesheet, track + 1U)
+		           : FLAC_RANGE_END_OF_STREAM;
+		return true;
+	}
+	return false;
+}
+
+uint32_t fx_flac_get_peak_count(const fx_flac_t *inst) {
+	inst = (const fx_flac_t *)FX_ALIGN_ADDR(inst);
+	return inst->peaks_cnt;
+}
+
+bool fx_flac_flush_peaks(fx_flac_t *inst) {
+	inst = (fx_flac_t *)FX_ALIGN_ADDR(inst);
+	if (!inst->peak_bucket || !inst->peak_n) {
+		return true;
+	}
+	return _fx_flac_write_peaks(inst, inst->frame_header->channel_count);
+}
+
+bool fx_flac_get_frame_info(const fx_flac_t *inst, fx_flac_frame_info_t *info) {
+	inst = (const fx_flac_t *)FX_ALIGN_ADDR(inst);
+	switch (inst->state) {
+		case FLAC_IN_FRAME:
+		case FLAC_DECODED_FRAME:
+		case FLAC_END_OF_FRAME:
+			*info = inst->frame_info;
+			return true;
+		case FLAC_FRAME_CORRUPT:
+			*info = inst->corrupt_info;
+			return true;
+		default:
+			return false;
+	}
+}
+
+bool fx_flac_get_frame_header(const fx_flac_t *inst,
+                              fx_flac_frame_header_info_t *header) {
+	inst = (const fx_flac_t *)FX_ALIGN_ADDR(inst);
+	switch (inst->state) {
+		case FLAC_IN_FRAME:
+		case FLAC_DECODED_FRAME:
+		case FLAC_END_OF_FRAME:
+			break;
+		default:
+			return false;
+	}
+	const fx_flac_frame_header_t *fh = inst->frame_header;
+	header->offset = inst->frame_info.offset;
+	header->first_sample = inst->frame_info.first_sample;
+	header->sync_info = fh->sync_info;
+	header->blocking = (fh->blocking_strategy == BLK_VARIABLE)
+	                       ? FLAC_BLOCKING_VARIABLE
+	                       : FLAC_BLOCKING_FIXED;
+	header->block_size = fh->block_size;
+	header->sample_rate = fh->sample_rate;
+	switch (fh->channel_assignment) {
+		case LEFT_SIDE_STEREO:
+			header->channel_assignment = FLAC_CHANNELS_LEFT_SIDE;
+			break;
+		case RIGHT_SIDE_STEREO:
+			header->channel_assignment = FLAC_CHANNELS_RIGHT_SIDE;
+			break;
+		case MID_SIDE_STEREO:
+			header->channel_assignment = FLAC_CHANNELS_MID_SIDE;
+			break;
+		default:
+			header->channel_assignment = FLAC_CHANNELS_INDEPENDENT;
+			break;
+	}
+	header->channel_count = fh->channel_count;
+	header->sample_size = fh->sample_size;
+	return true;
+}
+
+void fx_flac_get_sync_stats(const fx_flac_t *inst,
+                            fx_flac_sync_stats_t *stats) {
+	inst = (const fx_flac_t *)FX_ALIGN_ADDR(inst);
+	*stats = inst->sync_stats;
 }
 
 fx_flac_state_t fx_flac_get_state(const fx_flac_t *inst) {
@@ -1938,13 +4523,21 @@ int64_t fx_flac_get_streaminfo(fx_flac_t const *inst,
 	}
 }
 
-fx_flac_state_t fx_flac_process(fx_flac_t *inst, const uint8_t *in,
-                                uint32_t *in_len, int32_t *out,
-                                uint32_t *out_len) {
+/**
+ * Runs the decoder state machine on the given input. If "batch" is NULL, this
+ * returns whenever the decoder transitions to a relevant state. Otherwise
+ * decoding continues across frame and metadata boundaries until the input or
+ * the output space is exhausted; events are recorded in "batch".
+ */
+static fx_flac_state_t _fx_flac_process(fx_flac_t *inst, const uint8_t *in,
+                                        uint32_t *in_len, int32_t *out,
+                                        uint32_t *out_len,
+                                        fx_flac_batch_result_t *batch) {
 	inst = (fx_flac_t *)FX_ALIGN_ADDR(inst);
 
 	/* Set the current bytestream source to the provided input buffer */
 	fx_bitstream_t *bs = &inst->bitstream; /* Alias */
+	inst->src_start = in;
 	fx_bitstream_set_source(bs, in, *in_len);
 
 	/* Advance the statemachine */
@@ -1959,12 +4552,46 @@ fx_flac_state_t fx_flac_process(fx_flac_t *inst, const uint8_t *in,
 		}
 
 		/* Automatically return once the state transitions to a relevant state,
-		   even if there is still data to read. */
+		   even if there is still data to read. In batch mode only record the
+		   event and return once the output buffer is full. */
 		if (old_state != inst->state) {
+			if (batch && old_state == FLAC_IN_FRAME &&
+			    inst->state == FLAC_SEARCH_FRAME && !inst->frame_skip) {
+				batch->events |= FLAC_BATCH_RESYNC;
+			}
 			old_state = inst->state;
 			switch (inst->state) {
 				case FLAC_END_OF_METADATA:
+					if (batch) {
+						batch->events |= FLAC_BATCH_METADATA;
+						break;
+					}
+					done = true; /* Good point to return to the caller */
+					continue;
+				case FLAC_END_OF_RANGE:
+					done = true;
+					continue;
+				case FLAC_FRAME_CORRUPT:
+					/* Concealed gaps do not interrupt batch decoding */
+					if (batch && !inst->verify_only) {
+						batch->events |= FLAC_BATCH_GAP;
+						break;
+					}
+					if (batch) {
+						batch->events |= FLAC_BATCH_RESYNC;
+					}
+					done = true; /* Caller should query the frame info */
+					continue;
 				case FLAC_END_OF_FRAME:
+					if (batch) {
+						/* The planar output is overwritten by the next frame,
+						   so always return to the caller in that case */
+						batch->n_frames++;
+						if (!inst->planar &&
+						    (!out || !out_len || out_len_ < *out_len)) {
+							break;
+						}
+					}
 					done = true; /* Good point to return to the caller */
 					continue;
 				default:
@@ -1982,26 +4609,80 @@ fx_flac_state_t fx_flac_process(fx_flac_t *inst, const uint8_t *in,
 			case FLAC_IN_METADATA:
 				done = !_fx_flac_process_in_metadata(inst);
 				break;
+			case FLAC_END_OF_FRAME: {
+				/* Retain the end of the frame for concealing gaps */
+				if ((inst->conceal == FLAC_CONCEAL_REPEAT) &&
+				    !inst->verify_only && !inst->planar && inst->tailbuf) {
+					_fx_flac_store_tail(inst);
+				}
+
+				/* Stop once the last sample of the range has been written */
+				const fx_flac_frame_info_t *fi = &inst->frame_info;
+				if (!inst->verify_only &&
+				    fi->first_sample + fi->n_samples >= inst->range_end) {
+					inst->state = FLAC_END_OF_RANGE;
+					break;
+				}
+				inst->state = FLAC_SEARCH_FRAME;
+				inst->priv_state = FLAC_FRAME_SYNC;
+				break;
+			}
 			case FLAC_END_OF_METADATA:
-			case FLAC_END_OF_FRAME:
 				inst->state = FLAC_SEARCH_FRAME;
 				inst->priv_state = FLAC_FRAME_SYNC;
 				break;
+			case FLAC_END_OF_RANGE:
+				done = true;
+				break;
 			case FLAC_SEARCH_FRAME:
 				done = !_fx_flac_process_search_frame(inst);
 				break;
 			case FLAC_IN_FRAME:
-				done = !_fx_flac_process_in_frame(inst);
+				if (inst->verify_only) {
+					done = !_fx_flac_process_in_frame_verify(inst);
+				} else if (inst->frame_crc_mode == FLAC_CRC_FULL) {
+					done = !_fx_flac_process_in_frame_crc(inst);
+				} else {
+					done = !_fx_flac_process_in_frame_no_crc(inst);
+				}
 				break;
-			case FLAC_DECODED_FRAME:
-				/* If no output buffers are given, just discard the data. */
-				if (!out || !out_len) {
+			case FLAC_DECODED_FRAME: {
+				/* In peak mode only the summary is written */
+				if (inst->peak_bucket) {
+					done = !_fx_flac_process_decoded_frame_peaks(inst);
+					break;
+				}
+
+				/* If no output buffers are given, just discard the data. In
+				   planar mode the data already is in the caller's buffers. */
+				if (!out || !out_len || inst->planar) {
 					inst->state = FLAC_END_OF_FRAME;
 					break;
 				}
-				out_len_ = *out_len;
-				done = !_fx_flac_process_decoded_frame(inst, out, &out_len_);
+				uint32_t n = *out_len - out_len_;
+				done =
+				    !_fx_flac_process_decoded_frame(inst, out + out_len_, &n);
+				out_len_ += n;
 				break;
+			}
+			case FLAC_FRAME_CORRUPT: {
+				/* Fill the gap in front of the next frame */
+				if (!inst->verify_only &&
+				    inst->priv_state == FLAC_SUBFRAME_HEADER) {
+					uint32_t n = (out && out_len) ? *out_len - out_len_ : 0U;
+					done = !_fx_flac_process_gap(
+					    inst, (out && out_len) ? out + out_len_ : NULL, &n);
+					out_len_ += n;
+					break;
+				}
+
+				/* Either continue with the frame following a gap or search
+				   for the next frame */
+				inst->state = (inst->priv_state == FLAC_SUBFRAME_HEADER)
+				                  ? FLAC_IN_FRAME
+				                  : FLAC_SEARCH_FRAME;
+				break;
+			}
 			default:
 				inst->state = FLAC_ERR; /* Internal error */
 				break;
@@ -2015,8 +4696,397 @@ fx_flac_state_t fx_flac_process(fx_flac_t *inst, const uint8_t *in,
 		*out_len = out_len_;
 	}
 	*in_len = bs->src - in;
+	inst->n_bytes_consumed += *in_len;
+	inst->src_start = bs->src;
 
 	/* Return the current state */
+	if (batch && inst->state == FLAC_ERR) {
+		batch->events |= FLAC_BATCH_ERROR;
+	}
 	return inst->state;
 }
 
+fx_flac_state_t fx_flac_process(fx_flac_t *inst, const uint8_t *in,
+                                uint32_t *in_len, int32_t *out,
+                                uint32_t *out_len) {
+	return _fx_flac_process(inst, in, in_len, out, out_len, NULL);
+}
+
+fx_flac_state_t fx_flac_process_batch(fx_flac_t *inst, const uint8_t *in,
+                                      uint32_t *in_len, int32_t *out,
+                                      uint32_t *out_len,
+                                      fx_flac_batch_result_t *result) {
+	fx_flac_batch_result_t result_;
+	if (!result) {
+		result = &result_;
+	}
+	result->n_frames = 0U;
+	result->events = 0U;
+	return _fx_flac_process(inst, in, in_len, out, out_len, result);
+}
+
+bool fx_flac_set_streaminfo(fx_flac_t *inst, const uint8_t *blob,
+                            uint32_t len) {
+	inst = (fx_flac_t *)FX_ALIGN_ADDR(inst);
+	if (len != 34U) {
+		return false;
+	}
+	fx_flac_reset(inst);
+	_fx_flac_parse_streaminfo(blob, inst->streaminfo);
+	inst->metadata->type = META_TYPE_STREAMINFO;
+	inst->metadata->is_last = true;
+	inst->metadata->length = 34U;
+	inst->state = FLAC_END_OF_METADATA;
+	return true;
+}
+
+fx_flac_state_t fx_flac_decode_packet(fx_flac_t *inst, const uint8_t *pkt,
+                                      uint32_t pkt_len, int32_t *out,
+                                      uint32_t *out_len) {
+	static const uint8_t padding[8] = {0};
+	inst = (fx_flac_t *)FX_ALIGN_ADDR(inst);
+	if (inst->state < FLAC_END_OF_METADATA) {
+		if (out_len) {
+			*out_len = 0U;
+		}
+		return inst->state; /* The STREAMINFO is missing */
+	}
+
+	/* Discard any data buffered from the previous packet and expect a frame
+	   header at the beginning of the packet */
+	inst->n_bytes_consumed = _fx_flac_stream_pos(inst);
+	fx_bitstream_init(&inst->bitstream);
+	inst->state = FLAC_SEARCH_FRAME;
+	inst->priv_state = FLAC_FRAME_SYNC;
+	inst->chan_cur = 0U;
+	inst->blk_cur = 0U;
+	inst->frame_skip = false;
+	inst->frame_info.offset = inst->n_bytes_consumed;
+	inst->packet = true;
+
+	const uint32_t out_max = (out && out_len) ? *out_len : 0U;
+	uint32_t n_out = out_max;
+	fx_flac_process(inst, pkt, &pkt_len, out, &n_out);
+
+	/* The decoder reads ahead up to seven bytes while parsing headers;
+	   complete short frames at the end of the packet by passing
+	   padding bytes. Padding that is actually read fails the CRC check. */
+	if (inst->state == FLAC_IN_FRAME || (inst->state == FLAC_SEARCH_FRAME &&
+	                                     inst->priv_state != FLAC_FRAME_SYNC)) {
+		uint32_t n_pad = sizeof(padding), n = out_max - n_out;
+		fx_flac_process(inst, padding, &n_pad, out ? out + n_out : NULL, &n);
+		n_out += n;
+	}
+	if (out_len) {
+		*out_len = n_out;
+	}
+
+	/* Frames before the selected range are only parsed */
+	if (inst->state == FLAC_SEARCH_FRAME && inst->frame_skip) {
+		inst->state = FLAC_END_OF_FRAME;
+	} else if (inst->state == FLAC_SEARCH_FRAME ||
+	           inst->state == FLAC_IN_FRAME) {
+		_fx_flac_handle_err(inst); /* Truncated packet */
+	}
+	inst->packet = false;
+	return inst->state;
+}
+
+/**
+ * Magic bytes at the beginning of a snapshot, followed by the version.
+ */
+static const uint8_t fx_flac_snapshot_magic_[4] = {'f', 'x', 'S', 'n'};
+
+/**
+ * Writes the n least significant bytes of v in big-endian order and returns a
+ * pointer at the byte following them.
+ */
+static uint8_t *_fx_flac_put_be(uint8_t *p, uint64_t v, uint8_t n) {
+	for (uint8_t i = n; i-- > 0U;) {
+		p[i] = (uint8_t)v;
+		v >>= 8U;
+	}
+	return p + n;
+}
+
+/**
+ * Reads n bytes in big-endian order and advances the pointer.
+ */
+static uint64_t _fx_flac_get_be(const uint8_t **p, uint8_t n) {
+	uint64_t v = 0U;
+	for (uint8_t i = 0U; i < n; i++) {
+		v = (v << 8U) | (*p)[i];
+	}
+	*p += n;
+	return v;
+}
+
+/**
+ * Computes the CRC-16 checksum protecting a snapshot.
+ */
+static uint16_t _fx_flac_snapshot_crc(const uint8_t *blob, uint32_t len) {
+	uint16_t crc16 = 0U;
+	for (uint32_t i = 0U; i < len; i++) {
+		crc16 = fx_flac_crc16_table_[((crc16 >> 8U) ^ blob[i]) & 0xFFU] ^
+		        (uint16_t)(crc16 << 8U);
+	}
+	return crc16;
+}
+
+bool fx_flac_snapshot(const fx_flac_t *inst, uint8_t *blob, uint32_t len) {
+	inst = (const fx_flac_t *)FX_ALIGN_ADDR(inst);
+	if ((inst->state != FLAC_END_OF_FRAME) || (len < FLAC_SNAPSHOT_SIZE)) {
+		return false;
+	}
+
+	/* Header */
+	uint8_t *p = blob;
+	for (uint8_t i = 0U; i < 4U; i++) {
+		*(p++) = fx_flac_snapshot_magic_[i];
+	}
+	*(p++) = FLAC_SNAPSHOT_VERSION;
+
+	/* STREAMINFO */
+	const fx_flac_streaminfo_t *si = inst->streaminfo;
+	p = _fx_flac_put_be(p, si->min_block_size, 2U);
+	p = _fx_flac_put_be(p, si->max_block_size, 2U);
+	p = _fx_flac_put_be(p, si->min_frame_size, 4U);
+	p = _fx_flac_put_be(p, si->max_frame_size, 4U);
+	p = _fx_flac_put_be(p, si->sample_rate, 4U);
+	*(p++) = si->n_channels;
+	*(p++) = si->sample_size;
+	p = _fx_flac_put_be(p, si->n_samples, 8U);
+	for (uint8_t i = 0U; i < 16U; i++) {
+		*(p++) = si->md5_sum[i];
+	}
+
+	/* Bits read ahead and checksums */
+	p = _fx_flac_put_be(p, inst->bitstream.buf, 8U);
+	*(p++) = inst->bitstream.pos;
+	*(p++) = inst->crc8;
+	p = _fx_flac_put_be(p, inst->crc16, 2U);
+
+	/* Position within the stream and the last frame */
+	const fx_flac_frame_info_t *fi = &inst->frame_info;
+	const fx_flac_frame_header_t *fh = inst->frame_header;
+	p = _fx_flac_put_be(p, inst->n_bytes_consumed, 8U);
+	p = _fx_flac_put_be(p, fi->offset, 8U);
+	p = _fx_flac_put_be(p, fi->first_sample, 8U);
+	p = _fx_flac_put_be(p, fi->n_samples, 4U);
+	*(p++) = fi->silent;
+	p = _fx_flac_put_be(p, fh->sync_info, 8U);
+	*(p++) = (uint8_t)fh->blocking_strategy;
+	p = _fx_flac_put_be(p, fh->block_size, 4U);
+	p = _fx_flac_put_be(p, fh->sample_rate, 4U);
+	*(p++) = (uint8_t)fh->channel_assignment;
+	*(p++) = fh->channel_count;
+	*(p++) = fh->sample_size;
+	p = _fx_flac_put_be(p, inst->next_sample, 8U);
+	p = _fx_flac_put_be(p, inst->next_offset, 8U);
+	*(p++) = inst->has_next_frame;
+	p = _fx_flac_put_be(p, inst->sync_stats.n_header_crc, 4U);
+	p = _fx_flac_put_be(p, inst->sync_stats.n_inconsistent, 4U);
+	p = _fx_flac_put_be(p, inst->sync_stats.n_discontinuous, 4U);
+	p = _fx_flac_put_be(p, inst->sync_stats.n_oversized, 4U);
+
+	/* Dither state, so the output is the same as without the snapshot */
+	p = _fx_flac_put_be(p, inst->dither_rng, 4U);
+	for (uint8_t c = 0U; c < FLAC_MAX_CHANNEL_COUNT; c++) {
+		p = _fx_flac_put_be(p, (uint64_t)inst->dither_err[c], 8U);
+	}
+
+	/* Checksum */
+	_fx_flac_put_be(p, _fx_flac_snapshot_crc(blob, (uint32_t)(p - blob)), 2U);
+	return true;
+}
+
+bool fx_flac_restore(fx_flac_t *inst, const uint8_t *blob, uint32_t len) {
+	inst = (fx_flac_t *)FX_ALIGN_ADDR(inst);
+
+	/* Validate the blob before touching the decoder */
+	if (len < FLAC_SNAPSHOT_SIZE) {
+		return false;
+	}
+	for (uint8_t i = 0U; i < 4U; i++) {
+		if (blob[i] != fx_flac_snapshot_magic_[i]) {
+			return false;
+		}
+	}
+	if ((blob[4] != FLAC_SNAPSHOT_VERSION) ||
+	    (_fx_flac_snapshot_crc(blob, FLAC_SNAPSHOT_SIZE - 2U) !=
+	     _fx_flac_read_be(blob + FLAC_SNAPSHOT_SIZE - 2U, 2U))) {
+		return false;
+	}
+	const uint8_t *p = blob + 5U;
+	fx_flac_streaminfo_t si;
+	si.min_block_size = (uint16_t)_fx_flac_get_be(&p, 2U);
+	si.max_block_size = (uint16_t)_fx_flac_get_be(&p, 2U);
+	si.min_frame_size = (uint32_t)_fx_flac_get_be(&p, 4U);
+	si.max_frame_size = (uint32_t)_fx_flac_get_be(&p, 4U);
+	si.sample_rate = (uint32_t)_fx_flac_get_be(&p, 4U);
+	si.n_channels = *(p++);
+	si.sample_size = *(p++);
+	si.n_samples = _fx_flac_get_be(&p, 8U);
+	for (uint8_t i = 0U; i < 16U; i++) {
+		si.md5_sum[i] = *(p++);
+	}
+	if ((si.max_block_size > inst->max_block_size) ||
+	    (si.n_channels > inst->max_channels) || (p[8] > BUFSIZE)) {
+		return false;
+	}
+
+	/* Start from a clean state; the decoded samples are gone, so there is
+	   nothing to retain for concealment */
+	fx_flac_reset(inst);
+	*inst->streaminfo = si;
+	inst->metadata->type = META_TYPE_STREAMINFO;
+	inst->metadata->is_last = true;
+	inst->metadata->length = 34U;
+	inst->bitstream.buf = _fx_flac_get_be(&p, 8U);
+	inst->bitstream.pos = *(p++);
+	inst->crc8 = *(p++);
+	inst->crc16 = (uint16_t)_fx_flac_get_be(&p, 2U);
+
+	fx_flac_frame_info_t *fi = &inst->frame_info;
+	fx_flac_frame_header_t *fh = inst->frame_header;
+	inst->n_bytes_consumed = _fx_flac_get_be(&p, 8U);
+	fi->offset = _fx_flac_get_be(&p, 8U);
+	fi->first_sample = _fx_flac_get_be(&p, 8U);
+	fi->n_samples = (uint32_t)_fx_flac_get_be(&p, 4U);
+	fi->silent = *(p++);
+	fh->sync_info = _fx_flac_get_be(&p, 8U);
+	fh->blocking_strategy = (fx_flac_blocking_strategy_t)(*(p++) & 0x01U);
+	fh->block_size = (uint32_t)_fx_flac_get_be(&p, 4U);
+	fh->sample_rate = (uint32_t)_fx_flac_get_be(&p, 4U);
+	fh->channel_assignment = (fx_flac_channel_assignment_t)*(p++);
+	fh->channel_count = *(p++);
+	fh->sample_size = *(p++);
+	inst->next_sample = _fx_flac_get_be(&p, 8U);
+	inst->next_frame = fh->sync_info + 1U;
+	inst->next_offset = _fx_flac_get_be(&p, 8U);
+	inst->has_next_frame = *(p++);
+	inst->sync_stats.n_header_crc = (uint32_t)_fx_flac_get_be(&p, 4U);
+	inst->sync_stats.n_inconsistent = (uint32_t)_fx_flac_get_be(&p, 4U);
+	inst->sync_stats.n_discontinuous = (uint32_t)_fx_flac_get_be(&p, 4U);
+	inst->sync_stats.n_oversized = (uint32_t)_fx_flac_get_be(&p, 4U);
+	inst->dither_rng = (uint32_t)_fx_flac_get_be(&p, 4U);
+	for (uint8_t c = 0U; c < FLAC_MAX_CHANNEL_COUNT; c++) {
+		inst->dither_err[c] = (int64_t)_fx_flac_get_be(&p, 8U);
+	}
+	inst->state = FLAC_END_OF_FRAME;
+	return true;
+}
+
+uint32_t fx_flac_probe(const uint8_t *buf, uint32_t len,
+                       fx_flac_probe_t *info) {
+	/* Skip any ID3v2 tags */
+	uint32_t offs = 0U, size;
+	while ((size = _fx_flac_id3v2_size(buf + offs, len - offs)) > 0U) {
+		offs += size;
+		if (offs > len) {
+			info->offset = offs;
+			return offs + FX_FLAC_PROBE_HEADER_SIZE;
+		}
+	}
+	info->offset = offs;
+	if (len - offs < FX_FLAC_PROBE_HEADER_SIZE) {
+		/* Make sure there is at least a chance to find a FLAC stream */
+		const uint8_t *p = buf + offs;
+		if ((len - offs >= 3U) && (p[0] == 'I') && (p[1] == 'D') &&
+		    (p[2] == '3')) {
+			return offs + 10U;
+		}
+		return offs + FX_FLAC_PROBE_HEADER_SIZE;
+	}
+
+	/* The first metadata block must be the STREAMINFO block */
+	const uint8_t *p = buf + offs;
+	if ((p[0] != 'f') || (p[1] != 'L') || (p[2] != 'a') || (p[3] != 'C') ||
+	    ((p[4] & 0x7FU) != META_TYPE_STREAMINFO) ||
+	    (_fx_flac_read_be(p + 5U, 3U) != 34U)) {
+		return 0U;
+	}
+	fx_flac_streaminfo_t si;
+	_fx_flac_parse_streaminfo(p + 8U, &si);
+	info->min_block_size = si.min_block_size;
+	info->max_block_size = si.max_block_size;
+	info->min_frame_size = si.min_frame_size;
+	info->max_frame_size = si.max_frame_size;
+	info->sample_rate = si.sample_rate;
+	info->n_channels = si.n_channels;
+	info->sample_size = si.sample_size;
+	info->n_samples = si.n_samples;
+	return offs + FX_FLAC_PROBE_HEADER_SIZE;
+}
+
+uint64_t fx_flac_probe_trailer(const uint8_t *buf, uint32_t len) {
+	uint64_t size = 0U;
+	if ((len >= 128U) && (buf[len - 128U] == 'T') &&
+	    (buf[len - 127U] == 'A') && (buf[len - 126U] == 'G')) {
+		size = 128U;
+	}
+	static const uint8_t ape[8] = {'A', 'P', 'E', 'T', 'A', 'G', 'E', 'X'};
+	if (len - size >= 32U) {
+		const uint8_t *footer = buf + len - size - 32U;
+		bool match = true;
+		for (uint8_t i = 0U; i < 8U; i++) {
+			match = match && (footer[i] == ape[i]);
+		}
+		if (match) {
+			const uint32_t n = _fx_flac_read_be(footer + 12U, 4U);
+			const uint32_t ape_size =
+			    ((n & 0xFFU) << 24U) | ((n & 0xFF00U) << 8U) |
+			    ((n >> 8U) & 0xFF00U) | (n >> 24U); /* Little endian */
+			const bool has_header = footer[23] & 0x80U;
+			size += (uint64_t)ape_size + (has_header ? 32U : 0U);
+		}
+	}
+	return size;
+}
+
+bool fx_flac_probe_tail(const uint8_t *buf, uint32_t len,
+                        fx_flac_probe_t *info) {
+	/* Search backwards for a frame header such that the frame ends exactly at
+	   the end of the stream and its CRC-16 matches */
+	const uint32_t end = len - _fx_flac_trailer_size(buf, len);
+	for (uint32_t i = end; i-- > 0U;) {
+		uint64_t first_sample;
+		uint32_t block_size;
+		if ((buf[i] != 0xFFU) ||
+		    !_fx_flac_probe_frame(buf + i, end - i, info, &first_sample,
+		                          &block_size)) {
+			continue;
+		}
+		uint16_t crc16 = 0U;
+		for (uint32_t j = i; j < end - 2U; j++) {
+			crc16 = fx_flac_crc16_table_[((crc16 >> 8U) ^ buf[j]) & 0xFFU] ^
+			        (uint16_t)(crc16 << 8U);
+		}
+		if (crc16 == _fx_flac_read_be(buf + end - 2U, 2U)) {
+			info->n_samples = first_sample + block_size;
+			return true;
+		}
+	}
+	return false;
+}
+
+int32_t fx_flac_find_frame(const uint8_t *buf, uint32_t len,
+                           const fx_flac_probe_t *info, uint64_t *first_sample,
+                           uint32_t *n_samples) {
+	for (uint32_t i = 0U; (i + 1U < len) && (i <= INT32_MAX); i++) {
+		uint64_t first_sample_;
+		uint32_t block_size;
+		if ((buf[i] == 0xFFU) &&
+		    _fx_flac_probe_frame(buf + i, len - i, info, &first_sample_,
+		                         &block_size)) {
+			if (first_sample) {
+				*first_sample = first_sample_;
+			}
+			if (n_samples) {
+				*n_samples = block_size;
+			}
+			return (int32_t)i;
+		}
+	}
+	return -1;
+}
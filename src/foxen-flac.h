@@ -27,6 +27,7 @@
 #ifndef FOXEN_FLAC_H
 #define FOXEN_FLAC_H
 
+#include <stdbool.h>
 #include <stdint.h>
 
 #ifndef FX_EXPORT
@@ -129,7 +130,25 @@ typedef enum {
 	/**
 	 * The decoder reached the end of a block.
 	 */
-	FLAC_END_OF_FRAME = 6
+	FLAC_END_OF_FRAME = 6,
+
+	/**
+	 * Reported in three cases: in verify-only mode (see
+	 * fx_flac_set_verify_only()) for a frame that failed the integrity checks
+	 * or a range of samples for which no valid frame was found; for each gap
+	 * filled while a concealment policy is active (see
+	 * fx_flac_set_concealment()); and for packets rejected by
+	 * fx_flac_decode_packet(). Use fx_flac_get_frame_info() to query the
+	 * location of the corrupted data.
+	 */
+	FLAC_FRAME_CORRUPT = 7,
+
+	/**
+	 * The decoder has written the last sample of the range selected using
+	 * fx_flac_set_range(). No further input is consumed until the decoder is
+	 * reset or flushed.
+	 */
+	FLAC_END_OF_RANGE = 8
 } fx_flac_state_t;
 
 /**
@@ -162,6 +181,485 @@ typedef enum {
 	FLAC_KEY_MD5_SUM_F = 143,
 } fx_flac_streaminfo_key_t;
 
+/**
+ * Location of a frame within the stream, see fx_flac_get_frame_info().
+ */
+typedef struct {
+	/**
+	 * Offset of the first byte of the frame header, relative to the first
+	 * byte passed to the decoder after the last reset.
+	 */
+	uint64_t offset;
+
+	/**
+	 * Index of the first sample (per channel) in the frame.
+	 */
+	uint64_t first_sample;
+
+	/**
+	 * Number of samples (per channel) in the frame.
+	 */
+	uint32_t n_samples;
+
+	/**
+	 * True if all channels of the frame are coded as constant zero, i.e. the
+	 * frame is digital silence. Only valid once the frame has been decoded,
+	 * i.e. in the FLAC_DECODED_FRAME and FLAC_END_OF_FRAME states.
+	 */
+	bool silent;
+} fx_flac_frame_info_t;
+
+/**
+ * Blocking strategy of a frame, see fx_flac_get_frame_header().
+ */
+typedef enum {
+	/**
+	 * All frames of the stream except for the last one have the same block
+	 * size; the frame header stores the frame number.
+	 */
+	FLAC_BLOCKING_FIXED = 0,
+
+	/**
+	 * The block size may change from frame to frame; the frame header stores
+	 * the index of the first sample.
+	 */
+	FLAC_BLOCKING_VARIABLE = 1
+} fx_flac_blocking_t;
+
+/**
+ * Inter-channel decorrelation used by a frame, see fx_flac_get_frame_header().
+ */
+typedef enum {
+	/**
+	 * All channels are coded independently.
+	 */
+	FLAC_CHANNELS_INDEPENDENT = 0,
+
+	/**
+	 * Stereo frame coded as left channel and side channel.
+	 */
+	FLAC_CHANNELS_LEFT_SIDE = 1,
+
+	/**
+	 * Stereo frame coded as side channel and right channel.
+	 */
+	FLAC_CHANNELS_RIGHT_SIDE = 2,
+
+	/**
+	 * Stereo frame coded as mid channel and side channel.
+	 */
+	FLAC_CHANNELS_MID_SIDE = 3
+} fx_flac_channel_mode_t;
+
+/**
+ * Contents of the header of the current frame, see fx_flac_get_frame_header().
+ */
+typedef struct {
+	/**
+	 * Offset of the first byte of the frame header, relative to the first
+	 * byte passed to the decoder after the last reset.
+	 */
+	uint64_t offset;
+
+	/**
+	 * Index of the first sample (per channel) in the frame, computed from
+	 * sync_info according to the blocking strategy.
+	 */
+	uint64_t first_sample;
+
+	/**
+	 * Synchronisation information stored in the header, i.e. the frame number
+	 * for FLAC_BLOCKING_FIXED and the sample number for
+	 * FLAC_BLOCKING_VARIABLE.
+	 */
+	uint64_t sync_info;
+
+	/**
+	 * Blocking strategy of the stream.
+	 */
+	fx_flac_blocking_t blocking;
+
+	/**
+	 * Number of samples (per channel) in the frame.
+	 */
+	uint32_t block_size;
+
+	/**
+	 * Sample rate in Hz. Taken from the STREAMINFO block if the header refers
+	 * to it.
+	 */
+	uint32_t sample_rate;
+
+	/**
+	 * Inter-channel decorrelation and number of channels.
+	 */
+	fx_flac_channel_mode_t channel_assignment;
+	uint8_t channel_count;
+
+	/**
+	 * Bits per sample. Taken from the STREAMINFO block if the header refers
+	 * to it.
+	 */
+	uint8_t sample_size;
+} fx_flac_frame_header_info_t;
+
+/**
+ * Number of frame candidates rejected while searching for frames, see
+ * fx_flac_get_sync_stats().
+ */
+typedef struct {
+	/**
+	 * Frame headers with an invalid CRC-8 checksum.
+	 */
+	uint32_t n_header_crc;
+
+	/**
+	 * Frame headers contradicting the STREAMINFO metadata block, i.e. with a
+	 * different sample rate, bit depth or channel count, or a block size
+	 * outside of the announced range.
+	 */
+	uint32_t n_inconsistent;
+
+	/**
+	 * Frame headers with a sample or frame number that cannot follow the
+	 * last valid frame, given the number of bytes in between. A candidate
+	 * continuing a rejected one is accepted and becomes the new reference.
+	 */
+	uint32_t n_discontinuous;
+
+	/**
+	 * Frames that were aborted because they exceeded the maximum frame size
+	 * announced in the STREAMINFO metadata block.
+	 */
+	uint32_t n_oversized;
+} fx_flac_sync_stats_t;
+
+/**
+ * Format and duration of a stream as determined by fx_flac_probe().
+ */
+typedef struct {
+	/**
+	 * Offset of the "fLaC" marker relative to the beginning of the probed
+	 * buffer, i.e. the size of any ID3v2 tags preceding the stream.
+	 */
+	uint32_t offset;
+
+	/**
+	 * Fields of the STREAMINFO metadata block. Sizes and n_samples may be
+	 * zero if unknown.
+	 */
+	uint16_t min_block_size;
+	uint16_t max_block_size;
+	uint32_t min_frame_size;
+	uint32_t max_frame_size;
+	uint32_t sample_rate;
+	uint8_t n_channels;
+	uint8_t sample_size;
+	uint64_t n_samples;
+} fx_flac_probe_t;
+
+/**
+ * Summary of a bucket of samples of a single channel, see
+ * fx_flac_set_peak_output().
+ */
+typedef struct {
+	/**
+	 * Smallest and largest sample in the bucket, scaled just like the
+	 * output of fx_flac_process().
+	 */
+	int32_t min;
+	int32_t max;
+
+	/**
+	 * Sum of the squared samples in the bucket, where each sample is scaled
+	 * to 16 bits (i.e. shifted right by 16 bits) before squaring. Divide by
+	 * the bucket size and take the square root to obtain the RMS value.
+	 */
+	uint64_t sum_sq;
+} fx_flac_peak_t;
+
+/**
+ * Index point of a track in a CUESHEET metadata block, see
+ * fx_flac_set_cuesheet_output().
+ */
+typedef struct {
+	/**
+	 * Offset of the index point in samples (per channel), relative to the
+	 * offset of the track.
+	 */
+	uint64_t offset;
+
+	/**
+	 * Index point number. Index point 0 marks the pregap, index point 1 the
+	 * beginning of the track proper.
+	 */
+	uint8_t number;
+} fx_flac_cue_index_t;
+
+/**
+ * Track in a CUESHEET metadata block, see fx_flac_set_cuesheet_output().
+ */
+typedef struct {
+	/**
+	 * Offset of the track in samples (per channel), relative to the beginning
+	 * of the stream.
+	 */
+	uint64_t offset;
+
+	/**
+	 * Track number. The last track is the lead-out track, numbered 170 for
+	 * CD-DA and 255 otherwise.
+	 */
+	uint8_t number;
+
+	/**
+	 * Zero-terminated International Standard Recording Code. Empty if the
+	 * track has none.
+	 */
+	char isrc[13];
+
+	/**
+	 * True for audio tracks, false for data tracks.
+	 */
+	bool audio;
+
+	/**
+	 * True if the audio was recorded with pre-emphasis.
+	 */
+	bool pre_emphasis;
+
+	/**
+	 * Number of index points of this track stored in the index point array.
+	 */
+	uint8_t n_indices;
+
+	/**
+	 * Position of the first index point of this track in the index point
+	 * array.
+	 */
+	uint32_t first_index;
+} fx_flac_cue_track_t;
+
+/**
+ * Contents of a CUESHEET metadata block, see fx_flac_set_cuesheet_output().
+ */
+typedef struct {
+	/**
+	 * True once a complete CUESHEET block has been read.
+	 */
+	bool valid;
+
+	/**
+	 * True if the cue sheet corresponds to a compact disc.
+	 */
+	bool is_cd;
+
+	/**
+	 * Zero-terminated media catalog number.
+	 */
+	char catalog[129];
+
+	/**
+	 * Number of lead-in samples; only meaningful for compact discs.
+	 */
+	uint64_t lead_in;
+
+	/**
+	 * Caller-owned arrays receiving the tracks and index points.
+	 */
+	fx_flac_cue_track_t *tracks;
+	fx_flac_cue_index_t *indices;
+
+	/**
+	 * Capacity of the arrays and the number of entries that were written.
+	 * Tracks that do not fit into the array are skipped along with their
+	 * index points.
+	 */
+	uint32_t max_tracks;
+	uint32_t max_indices;
+	uint32_t n_tracks;
+	uint32_t n_indices;
+} fx_flac_cuesheet_t;
+
+/**
+ * Enum used in fx_flac_set_crc_mode() to select which checksums are verified.
+ */
+typedef enum {
+	/**
+	 * Verify both the frame header CRC-8 and the frame CRC-16 checksum.
+	 * Frames with a mismatching checksum are discarded. This is the default.
+	 */
+	FLAC_CRC_FULL = 0,
+
+	/**
+	 * Only verify the frame header CRC-8 checksum. This keeps the search for
+	 * frame boundaries robust while skipping the checksum over the audio data.
+	 */
+	FLAC_CRC_HEADER = 1,
+
+	/**
+	 * Do not verify any checksums. Only use this if the integrity of the input
+	 * data has already been checked by other means.
+	 */
+	FLAC_CRC_NONE = 2
+} fx_flac_crc_mode_t;
+
+/**
+ * Enum used in fx_flac_set_downmix() to select how the decoded channels are
+ * mixed into the output buffer.
+ */
+typedef enum {
+	/**
+	 * Output all channels of the stream. This is the default.
+	 */
+	FLAC_DOWNMIX_NONE = 0,
+
+	/**
+	 * Output two channels. Surround channels are mixed into the left and
+	 * right channel following ITU-R BS.775 (center and surround channels
+	 * attenuated by 3 dB, LFE discarded); mono streams are duplicated.
+	 */
+	FLAC_DOWNMIX_STEREO = 1,
+
+	/**
+	 * Output a single channel, the average of the FLAC_DOWNMIX_STEREO mix.
+	 */
+	FLAC_DOWNMIX_MONO = 2,
+
+	/**
+	 * Apply the matrix passed to fx_flac_set_downmix_matrix().
+	 */
+	FLAC_DOWNMIX_CUSTOM = 3
+} fx_flac_downmix_t;
+
+/**
+ * Downmix matrix coefficient corresponding to a gain of one, i.e. the
+ * coefficients passed to fx_flac_set_downmix_matrix() are in Q2.14 format.
+ */
+#define FLAC_DOWNMIX_UNITY (1 << 14)
+
+/**
+ * End of the sample range passed to fx_flac_set_range() selecting all
+ * samples up to the end of the stream.
+ */
+#define FLAC_RANGE_END_OF_STREAM UINT64_MAX
+
+/**
+ * Channel mask selecting all channels, see fx_flac_set_channel_mask().
+ */
+#define FLAC_CHANNEL_MASK_ALL 0xFFU
+
+/**
+ * Gain passed to fx_flac_set_gain() corresponding to a factor of one, i.e.
+ * the gain is in Q16.16 format.
+ */
+#define FLAC_GAIN_UNITY (1 << 16)
+
+/**
+ * Largest gain accepted by fx_flac_set_gain(), corresponding to +24 dB.
+ */
+#define FLAC_GAIN_MAX (16 << 16)
+
+/**
+ * Size of the blob written by fx_flac_snapshot() in bytes.
+ */
+#define FLAC_SNAPSHOT_SIZE 211U
+
+/**
+ * Version of the snapshot format. Blobs with a different version are rejected
+ * by fx_flac_restore().
+ */
+#define FLAC_SNAPSHOT_VERSION 2U
+
+/**
+ * Enum used in fx_flac_set_output_depth() to select how samples are
+ * requantised to the target bit depth.
+ */
+typedef enum {
+	/**
+	 * Round to the nearest representable value.
+	 */
+	FLAC_DITHER_NONE = 0,
+
+	/**
+	 * Add triangular (TPDF) dither with an amplitude of one LSB before
+	 * rounding.
+	 */
+	FLAC_DITHER_TPDF = 1,
+
+	/**
+	 * TPDF dither with first-order error feedback, which moves the
+	 * quantisation noise towards high frequencies.
+	 */
+	FLAC_DITHER_SHAPED = 2
+} fx_flac_dither_t;
+
+/**
+ * Enum used in fx_flac_set_concealment() to select how samples lost to
+ * corrupt frames are replaced.
+ */
+typedef enum {
+	/**
+	 * Corrupt frames are dropped; the output skips the lost samples.
+	 */
+	FLAC_CONCEAL_DROP = 0,
+
+	/**
+	 * The lost samples are replaced by silence.
+	 */
+	FLAC_CONCEAL_SILENCE = 1,
+
+	/**
+	 * The end of the last valid frame is repeated and faded out linearly
+	 * over the length of one block; the remaining samples are silent.
+	 */
+	FLAC_CONCEAL_REPEAT = 2
+} fx_flac_conceal_t;
+
+/**
+ * Flags reported by fx_flac_process_batch() in fx_flac_batch_result_t.
+ */
+typedef enum {
+	/**
+	 * The decoder finished reading the metadata; the values returned by
+	 * fx_flac_get_streaminfo() are now valid.
+	 */
+	FLAC_BATCH_METADATA = 1,
+
+	/**
+	 * At least one corrupted frame was discarded and the decoder resynchronised
+	 * with the stream.
+	 */
+	FLAC_BATCH_RESYNC = 2,
+
+	/**
+	 * The decoder entered the FLAC_ERR state.
+	 */
+	FLAC_BATCH_ERROR = 4,
+
+	/**
+	 * At least one gap in the sequence of samples was filled according to
+	 * the concealment policy, see fx_flac_set_concealment().
+	 */
+	FLAC_BATCH_GAP = 8
+} fx_flac_batch_event_t;
+
+/**
+ * Result of a call to fx_flac_process_batch().
+ */
+typedef struct {
+	/**
+	 * Number of frames whose last sample was written to the output buffer
+	 * during this call.
+	 */
+	uint32_t n_frames;
+
+	/**
+	 * Bitwise combination of the fx_flac_batch_event_t flags that occurred.
+	 */
+	uint32_t events;
+} fx_flac_batch_result_t;
+
 /**
  * Returns the size of the FLAC decoder instance in bytes. This assumes that the
  * FLAC audio that is being decoded uses the maximum settings, i.e. the largest
@@ -229,6 +727,40 @@ FX_EXPORT fx_flac_t *fx_flac_init(void *mem, uint16_t max_block_size,
 #define FX_FLAC_ALLOC_DEFAULT() \
 	FX_FLAC_ALLOC(FLAC_MAX_BLOCK_SIZE, FLAC_MAX_CHANNEL_COUNT)
 
+/**
+ * Returns the size of a FLAC decoder instance without internal sample buffers.
+ * Such an instance decodes directly into the caller-owned buffers registered
+ * using fx_flac_set_planar_output() and only holds the decoder state and a
+ * few small auxiliary buffers, independent of the number of channels.
+ *
+ * @return zero if the given parameters are out of range, the number of bytes
+ * required to hold the FLAC decoder structure otherwise.
+ */
+FX_EXPORT uint32_t fx_flac_size_planar(uint32_t max_block_size,
+                                       uint8_t max_channels);
+
+/**
+ * Initializes a FLAC decoder without internal sample buffers at the given
+ * memory location. The memory region must be at least as large as indicated by
+ * fx_flac_size_planar(). See fx_flac_init() regarding the parameters. Frames
+ * are skipped until output buffers have been registered using
+ * fx_flac_set_planar_output().
+ */
+FX_EXPORT fx_flac_t *fx_flac_init_planar(void *mem, uint16_t max_block_size,
+                                         uint8_t max_channels);
+
+/**
+ * Macro which calls malloc to allocate memory for a new fx_flac instance
+ * without internal sample buffers. The returned pointer must be freed using
+ * free.
+ */
+#define FX_FLAC_ALLOC_PLANAR(max_block_size, max_channels)                  \
+	(fx_flac_size_planar((max_block_size), (max_channels)) == 0U)           \
+	    ? NULL                                                              \
+	    : fx_flac_init_planar(                                              \
+	          malloc(fx_flac_size_planar((max_block_size), (max_channels))), \
+	          (max_block_size), (max_channels))
+
 /**
  * Resets the FLAC decoder.
  *
@@ -236,6 +768,349 @@ FX_EXPORT fx_flac_t *fx_flac_init(void *mem, uint16_t max_block_size,
  */
 FX_EXPORT void fx_flac_reset(fx_flac_t *inst);
 
+/**
+ * Discards all input data buffered inside the decoder and starts searching for
+ * the next audio frame. Call this after seeking within the input stream. In
+ * contrast to fx_flac_reset() the stream metadata is retained. If the decoder
+ * has not finished reading the metadata yet, this is equivalent to
+ * fx_flac_reset().
+ *
+ * @param inst is the FLAC decoder that should be flushed.
+ */
+FX_EXPORT void fx_flac_flush(fx_flac_t *inst);
+
+/**
+ * Selects which checksums are verified by the decoder. The setting is retained
+ * when calling fx_flac_reset(). Defaults to FLAC_CRC_FULL, unless the library
+ * was compiled with FX_FLAC_NO_CRC, in which case it defaults to
+ * FLAC_CRC_NONE. Changes take effect with the next frame; a frame that is
+ * being decoded is checked according to the previous setting.
+ *
+ * @param inst is the FLAC decoder instance.
+ * @param mode is the new CRC mode.
+ */
+FX_EXPORT void fx_flac_set_crc_mode(fx_flac_t *inst, fx_flac_crc_mode_t mode);
+
+/**
+ * Enables or disables the verify-only mode. In this mode the decoder checks
+ * the integrity of each frame (including both checksums, independent of the
+ * CRC mode), but does not reconstruct or output the audio signal, which is
+ * considerably faster than decoding the stream. fx_flac_process() returns
+ * FLAC_END_OF_FRAME for each intact frame and FLAC_FRAME_CORRUPT for each
+ * corrupt frame or gap in the sequence of samples. Truncated streams can be
+ * detected by comparing the end of the last frame to the number of samples
+ * stored in the STREAMINFO header. The setting is retained when calling
+ * fx_flac_reset().
+ *
+ * @param inst is the FLAC decoder instance.
+ * @param verify_only if true, enables the verify-only mode.
+ */
+FX_EXPORT void fx_flac_set_verify_only(fx_flac_t *inst, bool verify_only);
+
+/**
+ * Enables or disables the headerless mode, used to join a live stream after
+ * its beginning. In this mode the decoder does not wait for the "fLaC" marker
+ * and the metadata blocks, but immediately searches for the next frame. The
+ * sample rate, sample size and number of channels are taken from the first
+ * valid frame and are available via fx_flac_get_streaminfo() from then on.
+ * Frame headers may refer to the STREAMINFO block for the sample rate or
+ * sample size; the given defaults are used in that case. Frames whose sample
+ * size is unknown are skipped. Resets the decoder; the setting is retained
+ * when calling fx_flac_reset().
+ *
+ * @param inst is the FLAC decoder instance.
+ * @param headerless if true, enables the headerless mode.
+ * @param sample_rate is the default sample rate in Hz, or zero if unknown.
+ * @param sample_size is the default number of bits per sample between 4 and
+ * 32, or zero if unknown.
+ * @return false if one of the defaults is invalid.
+ */
+FX_EXPORT bool fx_flac_set_headerless(fx_flac_t *inst, bool headerless,
+                                      uint32_t sample_rate,
+                                      uint8_t sample_size);
+
+/**
+ * Selects how samples lost to corrupt frames are handled. The number of lost
+ * samples is derived from the frame or sample number of the next valid frame.
+ * Unless the policy is FLAC_CONCEAL_DROP, fx_flac_process() reports each gap
+ * by returning FLAC_FRAME_CORRUPT before the frame following the gap is
+ * decoded; fx_flac_get_frame_info() returns the location of the gap. The
+ * replacement samples are then written just like decoded samples, so the
+ * output keeps a constant sample clock. fx_flac_process_batch() does not
+ * return at gaps but reports FLAC_BATCH_GAP. With planar output, gaps are
+ * reported, but no samples are written. Samples lost at the very end of the
+ * stream cannot be detected. The setting is retained when calling
+ * fx_flac_reset().
+ *
+ * @param inst is the FLAC decoder instance.
+ * @param policy is the concealment policy. Defaults to FLAC_CONCEAL_DROP.
+ * @return false if the policy is invalid.
+ */
+FX_EXPORT bool fx_flac_set_concealment(fx_flac_t *inst,
+                                       fx_flac_conceal_t policy);
+
+/**
+ * Selects the channels that are decoded and written to the output, where bit
+ * i corresponds to channel i of the stream. Excluded channels are still
+ * parsed to find the next subframe, but are neither reconstructed nor
+ * written to the output; the output only contains the selected channels in
+ * ascending order, and all sample counts passed to and returned from
+ * fx_flac_process() refer to these channels. Both channels of a stereo pair
+ * coded as mid/side or left/right-side are reconstructed if either of them is
+ * selected. If a downmix is active, excluded channels are treated as silent.
+ * With planar output, the buffers of excluded channels hold unspecified data.
+ * The setting is retained when calling fx_flac_reset(). Do not change the
+ * setting while the decoder is in the FLAC_DECODED_FRAME state.
+ *
+ * @param inst is the FLAC decoder instance.
+ * @param mask is the channel mask. Defaults to FLAC_CHANNEL_MASK_ALL.
+ */
+FX_EXPORT void fx_flac_set_channel_mask(fx_flac_t *inst, uint8_t mask);
+
+/**
+ * Selects one of the downmix presets. The mix is computed while writing the
+ * output buffer, i.e. the output buffer only holds the mixed channels and
+ * all sample counts passed to and returned from fx_flac_process() refer to
+ * the mixed output. The preset coefficients are scaled such that the output
+ * cannot clip. The setting is retained when calling fx_flac_reset() and has
+ * no effect on planar output, see fx_flac_set_planar_output(). Do not change
+ * the setting while the decoder is in the FLAC_DECODED_FRAME state.
+ *
+ * @param inst is the FLAC decoder instance.
+ * @param mode is the downmix preset. Use fx_flac_set_downmix_matrix() to
+ * select FLAC_DOWNMIX_CUSTOM.
+ * @return false if mode is not a valid preset, in which case the previous
+ * setting is retained.
+ */
+FX_EXPORT bool fx_flac_set_downmix(fx_flac_t *inst, fx_flac_downmix_t mode);
+
+/**
+ * Mixes the decoded channels using the given matrix. Each output sample is
+ * computed as the sum of the input samples weighted with the corresponding
+ * row of the matrix and saturated to the 32-bit range. Frames with a channel
+ * count other than n_in are output without mixing.
+ *
+ * @param inst is the FLAC decoder instance.
+ * @param matrix is a row-major n_out x n_in matrix of coefficients, where
+ * FLAC_DOWNMIX_UNITY corresponds to a gain of one. The matrix is copied.
+ * @param n_in is the number of channels in the stream.
+ * @param n_out is the number of output channels.
+ * @return false if n_in or n_out are zero or larger than
+ * FLAC_MAX_CHANNEL_COUNT, in which case the previous setting is retained.
+ */
+FX_EXPORT bool fx_flac_set_downmix_matrix(fx_flac_t *inst,
+                                          const int16_t *matrix, uint8_t n_in,
+                                          uint8_t n_out);
+
+/**
+ * Restricts the output to the samples (per channel) with indices in the
+ * range [first, end). Frames ending before the first sample are parsed but
+ * not reconstructed, the first and last frame of the range are trimmed while
+ * writing the output, and once the last sample has been written the decoder
+ * transitions to the FLAC_END_OF_RANGE state without consuming further
+ * input. Planar output and verify-only mode are not trimmed. Sample indices
+ * are those reported by fx_flac_get_frame_info(); the setting is retained
+ * when calling fx_flac_reset() or fx_flac_flush(), such that the range can be
+ * combined with seeking.
+ *
+ * @param inst is the FLAC decoder instance.
+ * @param first is the index of the first sample that should be written.
+ * @param end is the index of the sample following the last sample that
+ * should be written, or FLAC_RANGE_END_OF_STREAM.
+ * @return false if the range is empty, in which case the previous setting is
+ * retained.
+ */
+FX_EXPORT bool fx_flac_set_range(fx_flac_t *inst, uint64_t first,
+                                 uint64_t end);
+
+/**
+ * Sets a gain that is applied to the decoded samples in the output stage,
+ * e.g. to implement ReplayGain. Results exceeding the 32-bit range are
+ * clipped. The decoder does not parse the REPLAYGAIN_* Vorbis comments; the
+ * caller has to convert the gain in dB to a linear factor and should limit
+ * the gain to the reciprocal of the corresponding peak value to prevent
+ * clipping. The gain is applied after the downmix and also affects planar
+ * output. The setting is retained when calling fx_flac_reset().
+ *
+ * @param inst is the FLAC decoder instance.
+ * @param gain is the linear gain in Q16.16 format, i.e. FLAC_GAIN_UNITY
+ * corresponds to a factor of one, which is the default.
+ * @return false if gain is negative or larger than FLAC_GAIN_MAX, in which
+ * case the previous setting is retained.
+ */
+FX_EXPORT bool fx_flac_set_gain(fx_flac_t *inst, int32_t gain);
+
+/**
+ * Requantises the output to the given bit depth whenever the samples have a
+ * higher precision, i.e. if the stream has a larger bit depth, or if a gain
+ * or a downmix is applied. Samples are still scaled to the 32-bit range; the
+ * lower 32 - bits bits are zero, such that e.g. out[i] >> 16 yields 16-bit
+ * samples for bits = 16. Dither is generated using a deterministic
+ * pseudo-random sequence that restarts when calling fx_flac_reset(). The
+ * setting is retained when calling fx_flac_reset().
+ *
+ * @param inst is the FLAC decoder instance.
+ * @param bits is the target bit depth. Zero (the default) or 32 disable the
+ * requantisation.
+ * @param dither selects the dither applied before rounding.
+ * @return false if bits is larger than 32 or dither is not valid, in which
+ * case the previous setting is retained.
+ */
+FX_EXPORT bool fx_flac_set_output_depth(fx_flac_t *inst, uint8_t bits,
+                                        fx_flac_dither_t dither);
+
+/**
+ * Registers caller-owned per-channel buffers the audio frames are decoded
+ * into. The residuals and the reconstructed signal are written directly into
+ * these buffers, i.e. there is no interleaved output. Once a frame has been
+ * decoded, fx_flac_process() returns FLAC_END_OF_FRAME and the first
+ * n_samples entries of each buffer (see fx_flac_get_frame_info()) hold the
+ * samples of the corresponding channel, scaled just like the interleaved
+ * output. The buffers are overwritten by the next frame; new buffers, for
+ * example the next slot of a ring buffer, may be registered whenever the
+ * decoder is not in the FLAC_IN_FRAME state.
+ *
+ * @param inst is the FLAC decoder instance.
+ * @param channels is an array of max_channels pointers, each pointing at a
+ * buffer that can hold max_block_size samples and that is aligned to 16 bytes.
+ * If NULL, the decoder returns to producing interleaved output using its
+ * internal buffers; for instances initialized using fx_flac_init_planar()
+ * frames are skipped in this case.
+ * @return false if one of the buffers is NULL or not aligned; the previous
+ * setting is retained in this case.
+ */
+FX_EXPORT bool fx_flac_set_planar_output(fx_flac_t *inst,
+                                         int32_t *const *channels);
+
+/**
+ * Enables the peak mode, in which no samples are written to the output
+ * buffer. Instead, the decoded samples are split into buckets of bucket_size
+ * samples per channel and the minimum, maximum and sum of squares of each
+ * bucket are written to the given array, one fx_flac_peak_t entry per
+ * channel and bucket. Buckets span frame boundaries. Entries of channels
+ * excluded by fx_flac_set_channel_mask() are zero, downmixing does not apply.
+ *
+ * Once the array is full, fx_flac_process() returns in the
+ * FLAC_DECODED_FRAME state. Read the entries and call this function again
+ * with the same bucket size to continue; the bucket that is currently being
+ * accumulated is only discarded if the bucket size changes or when calling
+ * fx_flac_reset(). The last, incomplete bucket of a stream is written by
+ * fx_flac_flush_peaks().
+ *
+ * @param inst is the FLAC decoder instance.
+ * @param bucket_size is the number of samples per channel summarised in one
+ * bucket. Zero disables the peak mode.
+ * @param peaks is the array the entries are written to. NULL disables the
+ * peak mode.
+ * @param n_peaks is the number of entries that fit into the array.
+ */
+FX_EXPORT void fx_flac_set_peak_output(fx_flac_t *inst, uint32_t bucket_size,
+                                       fx_flac_peak_t *peaks,
+                                       uint32_t n_peaks);
+
+/**
+ * Returns the number of entries written to the array registered using
+ * fx_flac_set_peak_output() since it has been registered.
+ */
+FX_EXPORT uint32_t fx_flac_get_peak_count(const fx_flac_t *inst);
+
+/**
+ * Writes the bucket that is currently being accumulated to the peak array,
+ * even though it contains less than bucket_size samples. Call this after the
+ * end of the stream has been reached.
+ *
+ * @return false if the peak array is full, true otherwise, including the
+ * case in which there is no incomplete bucket.
+ */
+FX_EXPORT bool fx_flac_flush_peaks(fx_flac_t *inst);
+
+/**
+ * Registers a structure receiving the contents of the CUESHEET metadata block
+ * of the stream, if there is one. Without this, the block is skipped. The
+ * structure is cleared when calling this function and fx_flac_reset(); the
+ * setting is retained when calling fx_flac_reset().
+ *
+ * @param inst is the FLAC decoder instance.
+ * @param cuesheet is the structure the cue sheet is written to, or NULL to
+ * skip the block.
+ * @param tracks is the array the tracks are written to.
+ * @param n_tracks is the length of the track array. A compact disc has at
+ * most 100 tracks, including the lead-out track.
+ * @param indices is the array the index points of all tracks are written to.
+ * @param n_indices is the length of the index point array.
+ */
+FX_EXPORT void fx_flac_set_cuesheet_output(fx_flac_t *inst,
+                                           fx_flac_cuesheet_t *cuesheet,
+                                           fx_flac_cue_track_t *tracks,
+                                           uint32_t n_tracks,
+                                           fx_flac_cue_index_t *indices,
+                                           uint32_t n_indices);
+
+/**
+ * Computes the range of samples covered by a track of a cue sheet. A track
+ * begins at its index point 1 (or its first index point if there is none) and
+ * ends where the next track begins, i.e. the pregap of a track is attributed
+ * to the preceding track. The result can be passed to fx_flac_set_range().
+ *
+ * @param cuesheet is a cue sheet read by the decoder.
+ * @param number is the track number.
+ * @param first is a pointer at a variable receiving the index of the first
+ * sample of the track.
+ * @param end is a pointer at a variable receiving the index of the sample
+ * following the track, or FLAC_RANGE_END_OF_STREAM if the cue sheet has no
+ * lead-out track.
+ * @return false if the cue sheet is invalid or has no track with the given
+ * number, or if the track is the lead-out track.
+ */
+FX_EXPORT bool fx_flac_cuesheet_track_range(const fx_flac_cuesheet_t *cuesheet,
+                                            uint8_t number, uint64_t *first,
+                                            uint64_t *end);
+
+/**
+ * Returns the location of the current frame. In the FLAC_FRAME_CORRUPT state,
+ * returns the location of the corrupted data instead.
+ *
+ * @param inst is the FLAC decoder instance.
+ * @param info is a pointer at the structure receiving the frame location.
+ * @return true if the decoder is in the FLAC_IN_FRAME, FLAC_DECODED_FRAME,
+ * FLAC_END_OF_FRAME or FLAC_FRAME_CORRUPT state, false otherwise. In the
+ * latter case, info is not written to.
+ */
+FX_EXPORT bool fx_flac_get_frame_info(const fx_flac_t *inst,
+                                      fx_flac_frame_info_t *info);
+
+/**
+ * Returns the header of the current frame. The header is available as soon
+ * as the decoder has found the frame, i.e. in the same states as the frame
+ * location, so positions and sample numbers can be recorded while decoding
+ * without parsing the stream a second time.
+ *
+ * @param inst is the FLAC decoder instance.
+ * @param header is a pointer at the structure receiving the frame header.
+ * @return true if the decoder is in the FLAC_IN_FRAME, FLAC_DECODED_FRAME or
+ * FLAC_END_OF_FRAME state, false otherwise. In the latter case, header is not
+ * written to.
+ */
+FX_EXPORT bool fx_flac_get_frame_header(const fx_flac_t *inst,
+                                        fx_flac_frame_header_info_t *header);
+
+/**
+ * Returns the number of frame candidates that were rejected since the last
+ * reset. Candidates are only accepted if their header is consistent with the
+ * STREAMINFO block and with the position of the last valid frame, and are
+ * abandoned as soon as they exceed the maximum frame size. This prevents
+ * false sync codes in corrupt data from being decoded up to the final CRC-16
+ * check. The position check is relaxed if the stream may have been spliced:
+ * forward jumps directly after a valid frame are accepted, a "fLaC" marker
+ * starts a new stream, and two consecutive candidates that continue each
+ * other re-anchor the check, i.e. only the first frame after a jump is lost.
+ *
+ * @param inst is the FLAC decoder instance.
+ * @param stats is a pointer at the structure receiving the counters.
+ */
+FX_EXPORT void fx_flac_get_sync_stats(const fx_flac_t *inst,
+                                      fx_flac_sync_stats_t *stats);
+
 /**
  * Returns the current decoder state.
  *
@@ -291,6 +1166,179 @@ FX_EXPORT fx_flac_state_t fx_flac_process(fx_flac_t *inst, const uint8_t *in,
                                           uint32_t *in_len, int32_t *out,
                                           uint32_t *out_len);
 
+/**
+ * Same as fx_flac_process(), but does not return at frame or metadata
+ * boundaries. Instead, decoding continues until either the input data is
+ * exhausted or the output buffer is full. This reduces the per-call overhead
+ * for streams with small block sizes.
+ *
+ * @param inst is the decoder instance.
+ * @param in is a pointer at the encoded bytestream.
+ * @param in_len is a pointer at the number of valid bytes in "in". Contains
+ * the number of bytes that were actually read after the function returns.
+ * @param out is a pointer at the output buffer, see fx_flac_process().
+ * @param out_len is a pointer at the number of samples that fit into "out".
+ * Contains the number of samples written after the function returns.
+ * @param result is a pointer at a structure receiving the number of completed
+ * frames and the events that occurred during this call. May be NULL.
+ * @return the current state of the decoder.
+ */
+FX_EXPORT fx_flac_state_t fx_flac_process_batch(fx_flac_t *inst,
+                                                const uint8_t *in,
+                                                uint32_t *in_len, int32_t *out,
+                                                uint32_t *out_len,
+                                                fx_flac_batch_result_t *result);
+
+/**
+ * Loads the STREAMINFO metadata block from an external source instead of
+ * reading it from the stream, e.g. from the codec private data of a Matroska
+ * or MP4 container. Resets the decoder; afterwards, the decoder is in the
+ * FLAC_END_OF_METADATA state and expects audio frames.
+ *
+ * @param inst is the FLAC decoder instance.
+ * @param blob is a pointer at the contents of the STREAMINFO block, without
+ * the "fLaC" marker and the metadata block header.
+ * @param len is the length of blob in bytes. Must be 34.
+ * @return false if len is invalid, true otherwise.
+ */
+FX_EXPORT bool fx_flac_set_streaminfo(fx_flac_t *inst, const uint8_t *blob,
+                                      uint32_t len);
+
+/**
+ * Decodes a packet containing exactly one frame, as produced by container
+ * demultiplexers. In contrast to fx_flac_process(), the decoder does not
+ * search for the frame; if the packet does not start with a valid frame, is
+ * truncated, or fails the integrity checks, it is rejected immediately.
+ * Gaps are not concealed in this mode, see fx_flac_set_concealment(); the
+ * container timestamps should be used instead.
+ *
+ * @param inst is the decoder instance. The STREAMINFO must have been read,
+ * see fx_flac_set_streaminfo().
+ * @param pkt is a pointer at the packet.
+ * @param pkt_len is the length of the packet in bytes.
+ * @param out is a pointer at the output buffer, see fx_flac_process().
+ * @param out_len is a pointer at the number of samples that fit into "out".
+ * Contains the number of samples written after the function returns.
+ * @return FLAC_END_OF_FRAME if the frame was decoded, FLAC_FRAME_CORRUPT if
+ * the packet was rejected, or FLAC_DECODED_FRAME if the output buffer is too
+ * small; in the latter case call fx_flac_process() without input to retrieve
+ * the remaining samples. Returns the current state if the decoder has not
+ * read the STREAMINFO yet.
+ */
+FX_EXPORT fx_flac_state_t fx_flac_decode_packet(fx_flac_t *inst,
+                                                const uint8_t *pkt,
+                                                uint32_t pkt_len, int32_t *out,
+                                                uint32_t *out_len);
+
+/**
+ * Serialises the state required to resume decoding after the current frame,
+ * e.g. to migrate the decoder to another process or to return to this point
+ * after seeking. The blob contains the STREAMINFO, the bits the decoder has
+ * read ahead, the checksum state and the position counters, but neither the
+ * decoded samples nor the settings of the instance. May only be called in
+ * the FLAC_END_OF_FRAME state.
+ *
+ * @param inst is the FLAC decoder instance.
+ * @param blob is a pointer at the memory the snapshot is written to.
+ * @param len is the size of blob in bytes. Must be at least
+ * FLAC_SNAPSHOT_SIZE.
+ * @return false if the decoder is not at the end of a frame or the blob is
+ * too small, true otherwise.
+ */
+FX_EXPORT bool fx_flac_snapshot(const fx_flac_t *inst, uint8_t *blob,
+                                uint32_t len);
+
+/**
+ * Restores a snapshot taken using fx_flac_snapshot(). Afterwards the decoder
+ * is in the FLAC_END_OF_FRAME state and continues with the next frame as
+ * soon as it is passed the input following the bytes consumed by the
+ * original instance; the stream is not searched again. Settings such as the
+ * sample range, gain or concealment policy are not part of the snapshot and
+ * are kept; the FLAC_CONCEAL_REPEAT policy conceals with silence until the
+ * next frame has been decoded.
+ *
+ * @param inst is the FLAC decoder instance.
+ * @param blob is a pointer at the snapshot.
+ * @param len is the length of blob in bytes.
+ * @return false if the blob is truncated, corrupt, has a different version or
+ * describes a stream exceeding the block size or channel count of the
+ * instance, in which case the decoder is left untouched; true otherwise.
+ */
+FX_EXPORT bool fx_flac_restore(fx_flac_t *inst, const uint8_t *blob,
+                               uint32_t len);
+
+/**
+ * Reads the format of a FLAC stream without allocating a decoder. Only the
+ * "fLaC" marker and the STREAMINFO block are parsed, i.e. the first 42 bytes
+ * of the stream. ID3v2 tags in front of the stream are skipped.
+ *
+ * @param buf is a pointer at the first bytes of the file.
+ * @param len is the number of valid bytes in buf.
+ * @param info is a pointer at the structure receiving the stream format.
+ * @return the number of bytes from the beginning of buf up to the end of the
+ * STREAMINFO block, or zero if buf does not contain a FLAC stream. If this is
+ * larger than len, buf is too short and only info->offset is valid. Either
+ * call this function again with more data, or with a buffer starting at
+ * info->offset, which allows to skip large tags without reading them.
+ */
+FX_EXPORT uint32_t fx_flac_probe(const uint8_t *buf, uint32_t len,
+                                 fx_flac_probe_t *info);
+
+/**
+ * Minimum number of bytes at the end of a file that should be passed to
+ * fx_flac_probe_trailer(): an ID3v1 tag followed by an APEv2 footer.
+ */
+#define FLAC_PROBE_TRAILER_SIZE 160U
+
+/**
+ * Determines the size of the ID3v1 and APEv2 tags at the end of a file, e.g.
+ * to decide how many bytes must be passed to fx_flac_probe_tail().
+ *
+ * @param buf is a pointer at the last bytes of the file. Should be at least
+ * FLAC_PROBE_TRAILER_SIZE bytes large, unless the file is shorter.
+ * @param len is the number of valid bytes in buf.
+ * @return the size of the tags in bytes. This may be larger than len.
+ */
+FX_EXPORT uint64_t fx_flac_probe_trailer(const uint8_t *buf, uint32_t len);
+
+/**
+ * Determines the number of samples of a stream by parsing the header of its
+ * last frame. Use this if fx_flac_probe() reported zero samples. ID3v1 and
+ * APEv2 tags at the end of the file are skipped.
+ *
+ * @param buf is a pointer at the last bytes of the file. Should be at least
+ * as large as the maximum frame size plus the size of any trailing tags, see
+ * fx_flac_probe_trailer().
+ * @param len is the number of valid bytes in buf.
+ * @param info is the stream format returned by fx_flac_probe(). Used to
+ * validate the frame header; n_samples is updated if a frame was found.
+ * @return true if the last frame was found, false otherwise.
+ */
+FX_EXPORT bool fx_flac_probe_tail(const uint8_t *buf, uint32_t len,
+                                  fx_flac_probe_t *info);
+
+/**
+ * Searches the given buffer for the first frame header that is consistent
+ * with the stream format. This can be used to implement bisection search on
+ * the sample index, after which the decoder is flushed using fx_flac_flush()
+ * and fed with data starting at the frame. Only the CRC-8 of the header is
+ * checked, so the result may rarely be a false positive within audio data.
+ *
+ * @param buf is the buffer that should be searched.
+ * @param len is the length of the buffer in bytes.
+ * @param info is the stream format returned by fx_flac_probe().
+ * @param first_sample is a pointer at a variable receiving the index of the
+ * first sample (per channel) in the frame. May be NULL.
+ * @param n_samples is a pointer at a variable receiving the number of samples
+ * (per channel) in the frame. May be NULL.
+ * @return the offset of the frame header within buf, or -1 if no frame header
+ * was found.
+ */
+FX_EXPORT int32_t fx_flac_find_frame(const uint8_t *buf, uint32_t len,
+                                     const fx_flac_probe_t *info,
+                                     uint64_t *first_sample,
+                                     uint32_t *n_samples);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,225 @@
+/*
+ *  libfoxenflac -- Tiny FLAC Decoder Library
+ *  Copyright (C) 2018-2025  Andreas Stöckel
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#define _DEFAULT_SOURCE /* for clock_gettime() */
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <foxen-flac-cache.h>
+#include <foxen-flac-mmap.h>
+#include <foxen-flac.h>
+
+/**
+ * Size of the chunks passed to the decoder in the read()-based benchmark.
+ */
+#define BENCH_READ_CHUNK_SIZE 4096U
+
+/**
+ * Size of the output buffer in samples.
+ */
+#define BENCH_OUT_BUF_SIZE 16384U
+
+/**
+ * Number of passes over the file in the scrubbing benchmark.
+ */
+#define BENCH_SCRUB_N_PASSES 8U
+
+/**
+ * Distance between the windows read in the scrubbing benchmark in samples
+ * per channel. The windows overlap.
+ */
+#define BENCH_SCRUB_STEP 4096U
+
+/**
+ * Byte budget of the frame cache in the scrubbing benchmark.
+ */
+#define BENCH_SCRUB_CACHE_SIZE (16U << 20U)
+
+static double now() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/**
+ * Decodes the given file by reading it in small chunks using read() and
+ * passing these chunks to fx_flac_process(). Returns the number of decoded
+ * samples or zero on error.
+ */
+static uint64_t bench_read(const char *file) {
+	int fd = open(file, O_RDONLY);
+	if (fd < 0) {
+		return 0U;
+	}
+	fx_flac_t *flac = FX_FLAC_ALLOC_DEFAULT();
+	static uint8_t in_buf[BENCH_READ_CHUNK_SIZE];
+	static int32_t out_buf[BENCH_OUT_BUF_SIZE];
+	uint32_t in_buf_wr_cur = 0U;
+	uint64_t n_smpls = 0U;
+	bool eof = false;
+	while (true) {
+		if (!eof && in_buf_wr_cur < sizeof(in_buf)) {
+			ssize_t n = read(fd, in_buf + in_buf_wr_cur,
+			                 sizeof(in_buf) - in_buf_wr_cur);
+			eof = n <= 0;
+			in_buf_wr_cur += (n > 0) ? n : 0;
+		}
+		uint32_t in_len = in_buf_wr_cur, out_len = BENCH_OUT_BUF_SIZE;
+		if (fx_flac_process(flac, in_buf, &in_len, out_buf, &out_len) ==
+		    FLAC_ERR) {
+			n_smpls = 0U;
+			break;
+		}
+		n_smpls += out_len;
+		memmove(in_buf, in_buf + in_len, in_buf_wr_cur - in_len);
+		in_buf_wr_cur -= in_len;
+		if (eof && in_len == 0U && out_len == 0U) {
+			break;
+		}
+	}
+	free(flac);
+	close(fd);
+	return n_smpls;
+}
+
+/**
+ * Decodes the given file using the memory-mapped file helper.
+ */
+static uint64_t bench_mmap(const char *file) {
+	fx_flac_mmap_t *f = fx_flac_open_mmap(file);
+	if (!f) {
+		return 0U;
+	}
+	static int32_t out_buf[BENCH_OUT_BUF_SIZE];
+	uint64_t n_smpls = 0U;
+	while (true) {
+		uint32_t out_len = BENCH_OUT_BUF_SIZE;
+		if (fx_flac_mmap_read(f, out_buf, &out_len, FLAC_PCM_S32) ==
+		    FLAC_ERR) {
+			n_smpls = 0U;
+			break;
+		}
+		n_smpls += out_len;
+		if (out_len < BENCH_OUT_BUF_SIZE) {
+			break;
+		}
+	}
+	fx_flac_close_mmap(f);
+	return n_smpls;
+}
+
+/**
+ * Scrubs back and forth over the file in small, overlapping windows using
+ * fx_flac_mmap_read_range(), optionally with a frame cache.
+ */
+static uint64_t bench_scrub(const char *file, bool cached) {
+	fx_flac_mmap_t *f = fx_flac_open_mmap(file);
+	if (!f) {
+		return 0U;
+	}
+	fx_flac_cache_t *cache = NULL;
+	if (cached) {
+		cache = FX_FLAC_CACHE_ALLOC(BENCH_SCRUB_CACHE_SIZE, 16384U, 2U);
+		fx_flac_mmap_set_cache(f, cache);
+	}
+	static int32_t out_buf[BENCH_OUT_BUF_SIZE];
+
+	/* The first frame does not necessarily start at sample zero */
+	fx_flac_frame_info_t info = {0};
+	uint32_t out_len = 1U;
+	fx_flac_mmap_read(f, out_buf, &out_len, FLAC_PCM_S32);
+	fx_flac_get_frame_info(fx_flac_mmap_get_decoder(f), &info);
+	const uint64_t first = info.first_sample;
+
+	uint64_t n_smpls = 0U, n_total = first;
+	for (uint32_t pass = 0U; pass < BENCH_SCRUB_N_PASSES; pass++) {
+		/* Scrub forwards in even and backwards in odd passes */
+		const bool backwards = pass % 2U;
+		uint64_t pos = backwards ? n_total : first;
+		while (true) {
+			uint32_t out_len = BENCH_OUT_BUF_SIZE;
+			if (!fx_flac_mmap_read_range(f, pos, out_buf, &out_len,
+			                             FLAC_PCM_S32)) {
+				n_smpls = 0U;
+				goto done;
+			}
+			n_smpls += out_len;
+			if (backwards) {
+				if (pos < first + BENCH_SCRUB_STEP) {
+					break;
+				}
+				pos -= BENCH_SCRUB_STEP;
+			} else {
+				if (out_len == 0U) {
+					n_total = pos;
+					break;
+				}
+				pos += BENCH_SCRUB_STEP;
+			}
+		}
+	}
+done:
+	fx_flac_close_mmap(f);
+	free(cache);
+	return n_smpls;
+}
+
+static uint64_t bench_scrub_uncached(const char *file) {
+	return bench_scrub(file, false);
+}
+
+static uint64_t bench_scrub_cached(const char *file) {
+	return bench_scrub(file, true);
+}
+
+static bool run(const char *name, uint64_t (*fun)(const char *),
+                const char *file, int n_repeat) {
+	double best = 0.0;
+	uint64_t n_smpls = 0U;
+	for (int i = 0; i < n_repeat; i++) {
+		const double t0 = now();
+		n_smpls = fun(file);
+		const double t = now() - t0;
+		if (n_smpls == 0U) {
+			fprintf(stderr, "[ERR] %s: %s failed\n", file, name);
+			return false;
+		}
+		best = (i == 0 || t < best) ? t : best;
+	}
+	fprintf(stderr, "[-->] %-8s %12lu samples %10.3f ms %8.1f MSmpl/s\n", name,
+	        (unsigned long)n_smpls, best * 1e3, n_smpls / best * 1e-6);
+	return true;
+}
+
+int main(int argc, const char *argv[]) {
+	if (argc < 2 || argc > 3) {
+		fprintf(stderr, "Usage: ./bench_flac <FLAC FILE> [N REPEAT]\n");
+		return 1;
+	}
+	const int n_repeat = (argc == 3) ? atoi(argv[2]) : 10;
+	bool ok = run("read()", bench_read, argv[1], n_repeat) &&
+	          run("mmap()", bench_mmap, argv[1], n_repeat) &&
+	          run("scrub", bench_scrub_uncached, argv[1], n_repeat) &&
+	          run("cached", bench_scrub_cached, argv[1], n_repeat);
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,106 @@
+const uint8_t FLAC_32BIT[] = {
+    0x66, 0x4C, 0x61, 0x43, 0x80, 0x00, 0x00, 0x22, 0x00, 0x10, 0x00, 0x10,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x17, 0x70, 0x03, 0xF0, 0x00, 0x00,
+    0x00, 0x70, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xF8, 0x70, 0x1E, 0x00, 0x00,
+    0x0F, 0x24, 0x14, 0x7F, 0xFF, 0xFF, 0xFF, 0x7F, 0xFF, 0xF3, 0xD5, 0x41,
+    0x0D, 0xDB, 0x76, 0xDD, 0xB7, 0x6D, 0xDB, 0x76, 0xDD, 0xB7, 0x6D, 0xDB,
+    0x76, 0xDD, 0xB7, 0x6D, 0xDB, 0x76, 0x29, 0x00, 0x00, 0x00, 0x01, 0x00,
+    0x00, 0x28, 0x8C, 0x82, 0x0F, 0x21, 0xE4, 0x3C, 0x87, 0x90, 0xF2, 0x1E,
+    0x43, 0xC8, 0x79, 0x0F, 0x21, 0xE4, 0x3C, 0x87, 0x90, 0xF2, 0x1E, 0x40,
+    0x56, 0xA9, 0xFF, 0xF8, 0x70, 0x8E, 0x01, 0x00, 0x0F, 0x19, 0x14, 0x7F,
+    0xFF, 0xFF, 0xFF, 0x7F, 0xFF, 0xE3, 0x9D, 0x41, 0x24, 0x16, 0x41, 0x64,
+    0x16, 0x41, 0x64, 0x16, 0x41, 0x64, 0x16, 0x41, 0x64, 0x16, 0x41, 0x64,
+    0x16, 0x41, 0x64, 0x16, 0x41, 0x62, 0x8F, 0xFF, 0xFF, 0xFF, 0xF7, 0xFF,
+    0xFE, 0xDC, 0x0A, 0x09, 0x33, 0x33, 0x33, 0x33, 0x33, 0x33, 0x33, 0x33,
+    0x33, 0x33, 0x33, 0x33, 0x33, 0x33, 0x33, 0x33, 0x33, 0x33, 0x33, 0x33,
+    0x33, 0x88, 0x88, 0xFF, 0xF8, 0x70, 0x9E, 0x02, 0x00, 0x0F, 0xC3, 0x14,
+    0x80, 0x00, 0x00, 0x00, 0xC0, 0x00, 0x05, 0x11, 0xD0, 0x41, 0xE4, 0x3C,
+    0x87, 0x90, 0xF2, 0x1E, 0x43, 0xC8, 0x79, 0x0F, 0x21, 0xE4, 0x3C, 0x87,
+    0x90, 0xF2, 0x1E, 0x43, 0xC8, 0x28, 0xFF, 0xFF, 0xFF, 0xFE, 0xFF, 0xFF,
+    0xF7, 0xE2, 0x81, 0x8A, 0x65, 0x32, 0x99, 0x4C, 0xA6, 0x53, 0x29, 0x94,
+    0xCA, 0x65, 0x32, 0x99, 0x4C, 0xA6, 0x53, 0x0F, 0xCC, 0xFF, 0xF8, 0x70,
+    0xAE, 0x03, 0x00, 0x0F, 0x01, 0x14, 0xFF, 0xFF, 0xFF, 0xFF, 0x00, 0x00,
+    0x10, 0x37, 0x41, 0x05, 0x40, 0xA8, 0x15, 0x02, 0xA0, 0x54, 0x0A, 0x81,
+    0x50, 0x2A, 0x05, 0x40, 0xA8, 0x15, 0x02, 0xA0, 0x54, 0x0A, 0x80, 0xA3,
+    0xFF, 0xFF, 0xFF, 0xFD, 0xFF, 0xFF, 0xAE, 0xE6, 0x82, 0x4F, 0x1C, 0xF1,
+    0xCF, 0x1C, 0xF1, 0xCF, 0x1C, 0xF1, 0xCF, 0x1C, 0xF1, 0xCF, 0x1C, 0xF1,
+    0xCF, 0x1C, 0xF1, 0xCF, 0x1C, 0xF1, 0xC0, 0xE0, 0x75, 0xFF, 0xF8, 0x70,
+    0xAE, 0x04, 0x00, 0x0F, 0x17, 0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0x00, 0x7F,
+    0xFF, 0xFF, 0xFF, 0x80, 0xD0, 0x40, 0xFF, 0xF8, 0x70, 0x8E, 0x05, 0x00,
+    0x0F, 0xB2, 0x15, 0x5F, 0xFF, 0xFF, 0xFF, 0x7F, 0xFF, 0xEF, 0xC5, 0x03,
+    0x14, 0xCA, 0x65, 0x32, 0x99, 0x4C, 0xA6, 0x53, 0x29, 0x94, 0xCA, 0x65,
+    0x32, 0x99, 0x4C, 0xA6, 0x2A, 0xBF, 0xFF, 0xFF, 0xFF, 0x7F, 0xFF, 0xDF,
+    0x8E, 0x82, 0x0A, 0x79, 0x4F, 0x29, 0xE5, 0x3C, 0xA7, 0x94, 0xF2, 0x9E,
+    0x53, 0xCA, 0x79, 0x4F, 0x29, 0xE5, 0x3C, 0xA7, 0x94, 0xF0, 0x19, 0xAF,
+    0xFF, 0xF8, 0x70, 0xAE, 0x06, 0x00, 0x0F, 0xC1, 0x02, 0x0E, 0x91, 0xFF,
+    0x48, 0x1B, 0xB6, 0x0B, 0x82, 0xCD, 0xF9, 0x08, 0xD8, 0x5C, 0xC8, 0xA4,
+    0x01, 0xED, 0x16, 0x9E, 0xA0, 0x04, 0xE5, 0x4D, 0xA6, 0x99, 0xE3, 0x5A,
+    0xF3, 0x96, 0xFE, 0x82, 0x82, 0xC2, 0x16, 0x24, 0x3C, 0x55, 0x65, 0xBF,
+    0xBD, 0x2C, 0x44, 0x76, 0xB3, 0xE8, 0x7F, 0x72, 0x5A, 0x28, 0x8A, 0xEF,
+    0x3A, 0x25, 0x0C, 0x28, 0x2F, 0xC1, 0x04, 0xA9, 0xB6, 0xFB, 0x5C, 0x44,
+    0xC2, 0x02, 0xA8, 0x1D, 0x97, 0xD6, 0x71, 0xAA, 0x2D, 0xE5, 0xB2, 0xEB,
+    0xFF, 0x67, 0x5F, 0x61, 0x5F, 0x95, 0x99, 0x55, 0x22, 0x10, 0x92, 0x8A,
+    0x25, 0x22, 0x4F, 0xEB, 0xE7, 0x83, 0xFA, 0x23, 0xB2, 0x86, 0xA4, 0x18,
+    0x4A, 0x30, 0x46, 0x8C, 0x30, 0x60, 0xDC, 0xB9, 0xC7, 0x11, 0xF7, 0xA5,
+    0xB9, 0x8A, 0xD3, 0xDA, 0xBC, 0xDB, 0xFC, 0xCE, 0xA7, 0xFE, 0xDA, 0xBC,
+    0xC4, 0x2B, 0xC6, 0x3A, 0x5C, 0x17, 0xC1, 0xF7, 0xBD, 0xC9,
+};
+const int32_t FLAC_32BIT_OUT[] = {
+    2147483647, INT32_MIN, 2147480533, -2147478458,
+    2147477197, -2147472898, 2147473639, -2147466968,
+    2147469859, -2147460668, 2147465857, -2147453998,
+    2147461633, -2147446958, 2147457187, -2147439548,
+    2147452519, -2147431768, 2147447629, -2147423618,
+    2147442517, -2147415098, 2147437183, -2147406208,
+    2147431627, -2147396948, 2147425849, -2147387318,
+    2147419849, -2147377318, 2147413627, -2147366948,
+    2147483647, INT32_MIN, 2147476381, -2147481572,
+    2147468597, -2147479348, 2147460295, -2147476976,
+    2147451475, -2147474456, 2147442137, -2147471788,
+    2147432281, -2147468972, 2147421907, -2147466008,
+    2147411015, -2147462896, 2147399605, -2147459636,
+    2147387677, -2147456228, 2147375231, -2147452672,
+    2147362267, -2147448968, 2147348785, -2147445116,
+    2147334785, -2147441116, 2147320267, -2147436968,
+    INT32_MIN, 2147483647, -2147479496, 2147482609,
+    -2147475048, 2147481497, -2147470304, 2147480311,
+    -2147465264, 2147479051, -2147459928, 2147477717,
+    -2147454296, 2147476309, -2147448368, 2147474827,
+    -2147442144, 2147473271, -2147435624, 2147471641,
+    -2147428808, 2147469937, -2147421696, 2147468159,
+    -2147414288, 2147466307, -2147406584, 2147464381,
+    -2147398584, 2147462381, -2147390288, 2147460307,
+    2147483647, INT32_MIN, 2147482609, -2147474306,
+    2147481497, -2147464298, 2147480311, -2147453624,
+    2147479051, -2147442284, 2147477717, -2147430278,
+    2147476309, -2147417606, 2147474827, -2147404268,
+    2147473271, -2147390264, 2147471641, -2147375594,
+    2147469937, -2147360258, 2147468159, -2147344256,
+    2147466307, -2147327588, 2147464381, -2147310254,
+    2147462381, -2147292254, 2147460307, -2147273588,
+    2147483647, INT32_MIN, 2147483647, INT32_MIN,
+    2147483647, INT32_MIN, 2147483647, INT32_MIN,
+    2147483647, INT32_MIN, 2147483647, INT32_MIN,
+    2147483647, INT32_MIN, 2147483647, INT32_MIN,
+    2147483647, INT32_MIN, 2147483647, INT32_MIN,
+    2147483647, INT32_MIN, 2147483647, INT32_MIN,
+    2147483647, INT32_MIN, 2147483647, INT32_MIN,
+    2147483647, INT32_MIN, 2147483647, INT32_MIN,
+    2147483644, INT32_MIN, 2147479492, -2147471192,
+    2147475044, -2147457848, 2147470300, -2147443616,
+    2147465260, -2147428496, 2147459924, -2147412488,
+    2147454292, -2147395592, 2147448364, -2147377808,
+    2147442140, -2147359136, 2147435620, -2147339576,
+    2147428804, -2147319128, 2147421692, -2147297792,
+    2147414284, -2147275568, 2147406580, -2147252456,
+    2147398580, -2147228456, 2147390284, -2147203568,
+    -1230006498, 1718904690, -16095411, 945926071,
+    -1716976011, 38341435, 1473487022, 1639819093,
+    -2107064407, 1472494999, 1445589488, -1281316515,
+    -1797440526, -1628866059, -1462254124, -2061156560,
+    -631221117, -1446251530, 1841725814, 1023737348,
+    325107346, 1160261333, 374065401, -1162667076,
+    -732385529, 2092773230, -99875961, 1342983384,
+    -233858235, -1879459800, 694691262, -850369593,
+};
@@ -0,0 +1,42 @@
+const uint8_t FLAC_CONSTANT[] = {
+    0x66, 0x4C, 0x61, 0x43, 0x80, 0x00, 0x00, 0x22, 0x00, 0x10, 0x00, 0x10,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x0A, 0xC4, 0x42, 0xF0, 0x00, 0x00,
+    0x00, 0x40, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xF8, 0x70, 0x18, 0x00, 0x00,
+    0x0F, 0x50, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xE7, 0xCA, 0xFF, 0xF8,
+    0x70, 0xA8, 0x01, 0x00, 0x0F, 0xA3, 0x01, 0x3F, 0xCE, 0x01, 0x20, 0xFA,
+    0x00, 0x5B, 0xA1, 0xFF, 0xF8, 0x70, 0x88, 0x02, 0x00, 0x0F, 0xD0, 0x00,
+    0xFE, 0xD4, 0x14, 0xFC, 0x39, 0x7E, 0xE7, 0xD0, 0x57, 0x20, 0xD4, 0x35,
+    0x33, 0xCC, 0x76, 0xD5, 0xD7, 0x25, 0x87, 0xDF, 0x56, 0x77, 0xCC, 0x62,
+    0x94, 0x22, 0xFC, 0x3E, 0x58, 0x87, 0x0F, 0xFF, 0xF8, 0x70, 0x98, 0x03,
+    0x00, 0x0F, 0xDC, 0x14, 0x04, 0x42, 0x01, 0x11, 0xD0, 0x52, 0x13, 0xF8,
+    0x2B, 0x72, 0x99, 0x69, 0x28, 0xF9, 0x47, 0x95, 0x52, 0xA7, 0x38, 0x33,
+    0x39, 0x0F, 0x16, 0x1D, 0x4C, 0x93, 0x2C, 0x50, 0x11, 0x04, 0x08, 0x8D,
+    0x04, 0xA1, 0x3E, 0xFA, 0xD9, 0x4C, 0xA9, 0x21, 0xF3, 0x1E, 0x4A, 0x94,
+    0x73, 0x86, 0x66, 0x43, 0x8A, 0xFD, 0x4B, 0x26, 0x30, 0xD5, 0x47,
+};
+
+const int32_t FLAC_CONSTANT_OUT[] = {
+    0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0,
+    0, 0, 104857600, -157286400, 104857600, -157286400,
+    104857600, -157286400, 104857600, -157286400, 104857600, -157286400,
+    104857600, -157286400, 104857600, -157286400, 104857600, -157286400,
+    104857600, -157286400, 104857600, -157286400, 104857600, -157286400,
+    104857600, -157286400, 104857600, -157286400, 104857600, -157286400,
+    104857600, -157286400, 104857600, -157286400, -19660800, 107085824,
+    -19660800, 53805056, -19660800, -25690112, -19660800, -83099648,
+    -19660800, -151388160, -19660800, -249823232, -19660800, -319488000,
+    -19660800, -340131840, -19660800, -433651712, -19660800, -494665728,
+    -19660800, -510328832, -19660800, -591396864, -19660800, -620756992,
+    -19660800, -684785664, -19660800, -716242944, -19660800, -777781248,
+    214237184, 71368704, 107610112, 35848192, -51314688, -17104896,
+    -166199296, -55443456, -302710784, -100925440, -499580928, -166526976,
+    -638910464, -212992000, -680198144, -226754560, -867237888, -289079296,
+    -989331456, -329777152, -1020592128, -340197376, -1182793728, -394264576,
+    -1241448448, -413859840, -1369571328, -456523776, -1432420352, -477495296,
+    -1555562496, -518520832,
+};
@@ -0,0 +1,98 @@
+const uint8_t FLAC_CUESHEET[] = {
+    0x66, 0x4C, 0x61, 0x43, 0x00, 0x00, 0x00, 0x22, 0x00, 0x10, 0x00, 0x10,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x17, 0x70, 0x03, 0xF0, 0x00, 0x00,
+    0x00, 0x70, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x85, 0x00, 0x02, 0x4C, 0x31, 0x32,
+    0x33, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x30, 0x31, 0x32, 0x33, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x04, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x28, 0x02, 0x44, 0x45, 0x41, 0x31, 0x32,
+    0x33, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x40, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x08, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x50, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x70, 0xFF, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xF8,
+    0x70, 0x1E, 0x00, 0x00, 0x0F, 0x24, 0x14, 0x7F, 0xFF, 0xFF, 0xFF, 0x7F,
+    0xFF, 0xF3, 0xD5, 0x41, 0x0D, 0xDB, 0x76, 0xDD, 0xB7, 0x6D, 0xDB, 0x76,
+    0xDD, 0xB7, 0x6D, 0xDB, 0x76, 0xDD, 0xB7, 0x6D, 0xDB, 0x76, 0x29, 0x00,
+    0x00, 0x00, 0x01, 0x00, 0x00, 0x28, 0x8C, 0x82, 0x0F, 0x21, 0xE4, 0x3C,
+    0x87, 0x90, 0xF2, 0x1E, 0x43, 0xC8, 0x79, 0x0F, 0x21, 0xE4, 0x3C, 0x87,
+    0x90, 0xF2, 0x1E, 0x40, 0x56, 0xA9, 0xFF, 0xF8, 0x70, 0x8E, 0x01, 0x00,
+    0x0F, 0x19, 0x14, 0x7F, 0xFF, 0xFF, 0xFF, 0x7F, 0xFF, 0xE3, 0x9D, 0x41,
+    0x24, 0x16, 0x41, 0x64, 0x16, 0x41, 0x64, 0x16, 0x41, 0x64, 0x16, 0x41,
+    0x64, 0x16, 0x41, 0x64, 0x16, 0x41, 0x64, 0x16, 0x41, 0x62, 0x8F, 0xFF,
+    0xFF, 0xFF, 0xF7, 0xFF, 0xFE, 0xDC, 0x0A, 0x09, 0x33, 0x33, 0x33, 0x33,
+    0x33, 0x33, 0x33, 0x33, 0x33, 0x33, 0x33, 0x33, 0x33, 0x33, 0x33, 0x33,
+    0x33, 0x33, 0x33, 0x33, 0x33, 0x88, 0x88, 0xFF, 0xF8, 0x70, 0x9E, 0x02,
+    0x00, 0x0F, 0xC3, 0x14, 0x80, 0x00, 0x00, 0x00, 0xC0, 0x00, 0x05, 0x11,
+    0xD0, 0x41, 0xE4, 0x3C, 0x87, 0x90, 0xF2, 0x1E, 0x43, 0xC8, 0x79, 0x0F,
+    0x21, 0xE4, 0x3C, 0x87, 0x90, 0xF2, 0x1E, 0x43, 0xC8, 0x28, 0xFF, 0xFF,
+    0xFF, 0xFE, 0xFF, 0xFF, 0xF7, 0xE2, 0x81, 0x8A, 0x65, 0x32, 0x99, 0x4C,
+    0xA6, 0x53, 0x29, 0x94, 0xCA, 0x65, 0x32, 0x99, 0x4C, 0xA6, 0x53, 0x0F,
+    0xCC, 0xFF, 0xF8, 0x70, 0xAE, 0x03, 0x00, 0x0F, 0x01, 0x14, 0xFF, 0xFF,
+    0xFF, 0xFF, 0x00, 0x00, 0x10, 0x37, 0x41, 0x05, 0x40, 0xA8, 0x15, 0x02,
+    0xA0, 0x54, 0x0A, 0x81, 0x50, 0x2A, 0x05, 0x40, 0xA8, 0x15, 0x02, 0xA0,
+    0x54, 0x0A, 0x80, 0xA3, 0xFF, 0xFF, 0xFF, 0xFD, 0xFF, 0xFF, 0xAE, 0xE6,
+    0x82, 0x4F, 0x1C, 0xF1, 0xCF, 0x1C, 0xF1, 0xCF, 0x1C, 0xF1, 0xCF, 0x1C,
+    0xF1, 0xCF, 0x1C, 0xF1, 0xCF, 0x1C, 0xF1, 0xCF, 0x1C, 0xF1, 0xC0, 0xE0,
+    0x75, 0xFF, 0xF8, 0x70, 0xAE, 0x04, 0x00, 0x0F, 0x17, 0x00, 0xFF, 0xFF,
+    0xFF, 0xFF, 0x00, 0x7F, 0xFF, 0xFF, 0xFF, 0x80, 0xD0, 0x40, 0xFF, 0xF8,
+    0x70, 0x8E, 0x05, 0x00, 0x0F, 0xB2, 0x15, 0x5F, 0xFF, 0xFF, 0xFF, 0x7F,
+    0xFF, 0xEF, 0xC5, 0x03, 0x14, 0xCA, 0x65, 0x32, 0x99, 0x4C, 0xA6, 0x53,
+    0x29, 0x94, 0xCA, 0x65, 0x32, 0x99, 0x4C, 0xA6, 0x2A, 0xBF, 0xFF, 0xFF,
+    0xFF, 0x7F, 0xFF, 0xDF, 0x8E, 0x82, 0x0A, 0x79, 0x4F, 0x29, 0xE5, 0x3C,
+    0xA7, 0x94, 0xF2, 0x9E, 0x53, 0xCA, 0x79, 0x4F, 0x29, 0xE5, 0x3C, 0xA7,
+    0x94, 0xF0, 0x19, 0xAF, 0xFF, 0xF8, 0x70, 0xAE, 0x06, 0x00, 0x0F, 0xC1,
+    0x02, 0x0E, 0x91, 0xFF, 0x48, 0x1B, 0xB6, 0x0B, 0x82, 0xCD, 0xF9, 0x08,
+    0xD8, 0x5C, 0xC8, 0xA4, 0x01, 0xED, 0x16, 0x9E, 0xA0, 0x04, 0xE5, 0x4D,
+    0xA6, 0x99, 0xE3, 0x5A, 0xF3, 0x96, 0xFE, 0x82, 0x82, 0xC2, 0x16, 0x24,
+    0x3C, 0x55, 0x65, 0xBF, 0xBD, 0x2C, 0x44, 0x76, 0xB3, 0xE8, 0x7F, 0x72,
+    0x5A, 0x28, 0x8A, 0xEF, 0x3A, 0x25, 0x0C, 0x28, 0x2F, 0xC1, 0x04, 0xA9,
+    0xB6, 0xFB, 0x5C, 0x44, 0xC2, 0x02, 0xA8, 0x1D, 0x97, 0xD6, 0x71, 0xAA,
+    0x2D, 0xE5, 0xB2, 0xEB, 0xFF, 0x67, 0x5F, 0x61, 0x5F, 0x95, 0x99, 0x55,
+    0x22, 0x10, 0x92, 0x8A, 0x25, 0x22, 0x4F, 0xEB, 0xE7, 0x83, 0xFA, 0x23,
+    0xB2, 0x86, 0xA4, 0x18, 0x4A, 0x30, 0x46, 0x8C, 0x30, 0x60, 0xDC, 0xB9,
+    0xC7, 0x11, 0xF7, 0xA5, 0xB9, 0x8A, 0xD3, 0xDA, 0xBC, 0xDB, 0xFC, 0xCE,
+    0xA7, 0xFE, 0xDA, 0xBC, 0xC4, 0x2B, 0xC6, 0x3A, 0x5C, 0x17, 0xC1, 0xF7,
+    0xBD, 0xC9,
+};
@@ -0,0 +1,75 @@
+const uint8_t FLAC_OGG_FIXED_1[] = {
+    0x4F, 0x67, 0x67, 0x53, 0x00, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x99, 0x09, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x72, 0x0F,
+    0xFD, 0x77, 0x01, 0x0B, 0x80, 0x6A, 0x75, 0x6E, 0x6B, 0x73, 0x74, 0x72,
+    0x65, 0x61, 0x6D, 0x4F, 0x67, 0x67, 0x53, 0x00, 0x02, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x34, 0x12, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x3D, 0x78, 0xC6, 0x13, 0x01, 0x33, 0x7F, 0x46, 0x4C, 0x41, 0x43,
+    0x01, 0x00, 0x00, 0x00, 0x66, 0x4C, 0x61, 0x43, 0x80, 0x00, 0x00, 0x22,
+    0x04, 0x80, 0x04, 0x80, 0x00, 0x00, 0x0E, 0x00, 0x0E, 0x7A, 0x0B, 0xB8,
+    0x02, 0xF0, 0x00, 0xE4, 0x19, 0x9A, 0x9D, 0xF9, 0x55, 0x1B, 0x97, 0x55,
+    0x78, 0x60, 0x54, 0x22, 0x4B, 0xCC, 0xF9, 0x37, 0xF3, 0xF1, 0x4F, 0x67,
+    0x67, 0x53, 0x00, 0x04, 0x05, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x99, 0x09, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0xD3, 0x68, 0x0A, 0x83,
+    0x01, 0x50, 0x6D, 0x6F, 0x72, 0x65, 0x64, 0x61, 0x74, 0x61, 0x6D, 0x6F,
+    0x72, 0x65, 0x64, 0x61, 0x74, 0x61, 0x6D, 0x6F, 0x72, 0x65, 0x64, 0x61,
+    0x74, 0x61, 0x6D, 0x6F, 0x72, 0x65, 0x64, 0x61, 0x74, 0x61, 0x6D, 0x6F,
+    0x72, 0x65, 0x64, 0x61, 0x74, 0x61, 0x6D, 0x6F, 0x72, 0x65, 0x64, 0x61,
+    0x74, 0x61, 0x6D, 0x6F, 0x72, 0x65, 0x64, 0x61, 0x74, 0x61, 0x6D, 0x6F,
+    0x72, 0x65, 0x64, 0x61, 0x74, 0x61, 0x6D, 0x6F, 0x72, 0x65, 0x64, 0x61,
+    0x74, 0x61, 0x6D, 0x6F, 0x72, 0x65, 0x64, 0x61, 0x74, 0x61, 0x4F, 0x67,
+    0x67, 0x53, 0x00, 0x04, 0x80, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x34, 0x12, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x08, 0xC4, 0x2D, 0x85,
+    0x03, 0xFF, 0xFF, 0x6E, 0xFF, 0xF8, 0x3A, 0x18, 0xC2, 0x9A, 0x71, 0x12,
+    0xFF, 0xA3, 0x0C, 0x15, 0x1D, 0x56, 0xD5, 0x7A, 0xDA, 0x25, 0x6D, 0x5D,
+    0x77, 0x69, 0x8F, 0x77, 0x77, 0xEF, 0x7B, 0x91, 0x3E, 0xFF, 0xF7, 0x97,
+    0x74, 0xBA, 0x57, 0xDE, 0xF1, 0xED, 0x31, 0x48, 0x29, 0x71, 0x2B, 0xBB,
+    0x8E, 0xBA, 0xD7, 0x6E, 0xED, 0xEE, 0xD9, 0x52, 0xE5, 0x4B, 0x89, 0xEF,
+    0xBC, 0xA6, 0x96, 0x59, 0xFF, 0x2C, 0xF2, 0x9F, 0xE4, 0xFF, 0xFF, 0xE7,
+    0xC8, 0x72, 0x93, 0x2C, 0x9E, 0x4A, 0x4F, 0xF2, 0x66, 0x52, 0x50, 0xF2,
+    0x70, 0xE7, 0x93, 0x99, 0xCC, 0x93, 0x26, 0x4E, 0x49, 0x92, 0x64, 0x93,
+    0x84, 0xC2, 0x61, 0xCC, 0x92, 0x64, 0x32, 0x64, 0x84, 0xC9, 0x24, 0x84,
+    0xC3, 0x92, 0x42, 0x48, 0x49, 0x32, 0x48, 0x49, 0x02, 0x13, 0x24, 0x84,
+    0x92, 0x4C, 0x24, 0xC8, 0x64, 0x32, 0x61, 0x3C, 0x26, 0x13, 0x0E, 0x66,
+    0x4C, 0xE6, 0x50, 0xE7, 0x33, 0x39, 0x93, 0xC9, 0xE6, 0x67, 0x39, 0xCF,
+    0x3C, 0xF9, 0xE5, 0xFD, 0xD3, 0x7B, 0xBE, 0xC8, 0xEC, 0x3B, 0xB4, 0xD6,
+    0xF5, 0x37, 0xB5, 0xF7, 0xB2, 0x96, 0x5F, 0x96, 0x5D, 0x33, 0xF9, 0xCE,
+    0x7C, 0xF3, 0x9C, 0xCF, 0x26, 0x4C, 0x9E, 0x13, 0x30, 0x9C, 0x86, 0x19,
+    0x0C, 0x84, 0x84, 0xA4, 0x84, 0xC2, 0x61, 0x21, 0x32, 0x01, 0x24, 0xC2,
+    0x49, 0x24, 0x21, 0x26, 0x42, 0x48, 0x4C, 0x21, 0x24, 0x92, 0x49, 0x09,
+    0x30, 0x92, 0x49, 0x0C, 0x26, 0x13, 0x09, 0x32, 0x18, 0x64, 0xC9, 0x24,
+    0x98, 0x4A, 0x49, 0x39, 0x9C, 0xC9, 0x99, 0xCC, 0xE6, 0x52, 0x53, 0xF3,
+    0xF3, 0x7E, 0xCB, 0xDD, 0x2B, 0xA8, 0xD3, 0xAE, 0xFE, 0x76, 0xE9, 0xF7,
+    0x3E, 0x6F, 0x9F, 0xFE, 0xFD, 0xEF, 0xE6, 0xFD, 0xFB, 0x7E, 0xFD, 0xBF,
+    0xDB, 0xDB, 0xDF, 0xB7, 0xEF, 0x6F, 0x7B, 0x7B, 0xDB, 0xF7, 0xBD, 0xB7,
+    0xFE, 0xF7, 0xB7, 0x9F, 0xBD, 0xB7, 0xED, 0xED, 0xFB, 0xDB, 0xDE, 0xDF,
+    0xB7, 0xED, 0x80, 0xA2, 0x28, 0xA2, 0x8A, 0x8A, 0x23, 0x15, 0x55, 0x11,
+    0x55, 0x55, 0x54, 0x55, 0x57, 0x45, 0x54, 0x5A, 0x8D, 0x6A, 0xC6, 0x56,
+    0xD5, 0x6A, 0x9B, 0xBB, 0xD6, 0x5A, 0xD3, 0x57, 0x6E, 0xF7, 0xF4, 0xD0,
+    0xD3, 0x9A, 0x78, 0xA7, 0xFC, 0x6F, 0xFC, 0x58, 0x21, 0xCD, 0x97, 0x31,
+    0x09, 0x13, 0x4C, 0x43, 0xD3, 0x4E, 0x9F, 0xA4, 0xAC, 0x95, 0x25, 0xE5,
+    0x2F, 0x2E, 0x11, 0x97, 0x22, 0x1D, 0x2C, 0xA6, 0xE1, 0x1C, 0xF4, 0xEC,
+    0xF4, 0xB2, 0x9A, 0x4A, 0xCB, 0x0B, 0xA7, 0x4D, 0x0B, 0x23, 0x0B, 0xE9,
+    0x91, 0x3E, 0x94, 0xE8, 0x46, 0x69, 0xA1, 0x69, 0xA1, 0x13, 0xA6, 0x9F,
+    0x61, 0x44, 0x34, 0xA6, 0x84, 0x61, 0x12, 0x9A, 0x69, 0x4D, 0x3A, 0x53,
+    0x4D, 0x3A, 0x74, 0xD2, 0x47, 0x3A, 0x50, 0x89, 0xA7, 0x67, 0xA4, 0x89,
+    0xD3, 0xA4, 0x89, 0xE9, 0x22, 0x17, 0x22, 0x7F, 0xCB, 0xCA, 0x69, 0x65,
+    0x2C, 0x2A, 0x53, 0x4F, 0xE9, 0xF2, 0xF9, 0x79, 0xB2, 0x94, 0xB2, 0xC9,
+    0x69, 0xA7, 0xD0, 0xAC, 0xFF, 0xD3, 0xCB, 0x43, 0x65, 0x91, 0x0C, 0x49,
+    0x53, 0x2E, 0x11, 0xF9, 0x12, 0x44, 0x2F, 0xFF, 0xE5, 0x91, 0x39, 0x19,
+    0x96, 0xC2, 0x21, 0x14, 0x08, 0x96, 0x11, 0x2C, 0xA5, 0x94, 0xB9, 0x53,
+    0xF4, 0xD3, 0xA7, 0x4B, 0x96, 0x52, 0xCB, 0xCB, 0x4F, 0x61, 0x52, 0x85,
+    0x4A, 0x69, 0xB0, 0xCD, 0x29, 0x61, 0x19, 0x4B, 0x29, 0x65, 0x2E, 0x69,
+    0xA5, 0x2C, 0x88, 0x62, 0x1D, 0xE5, 0x22, 0x42, 0x30, 0x8C, 0xB2, 0x9D,
+    0x3D, 0x29, 0xF2, 0xFF, 0xF2, 0x24, 0x89, 0xCB, 0x2C, 0xA5, 0x96, 0x59,
+    0x65, 0x29, 0x65, 0x84, 0x65, 0x34, 0xD9, 0xFF, 0x61, 0x12, 0x54, 0xF4,
+    0xFA, 0x77, 0x3C, 0xBE, 0x84, 0x61, 0x13, 0xFE, 0xCE, 0x5E, 0x84, 0x66,
+    0x94, 0xFA, 0x74, 0xD2, 0x95, 0x0D, 0xC2, 0x08, 0x59, 0x7E, 0x5E, 0x54,
+    0x97, 0x4F, 0xA4, 0x89, 0xA7, 0xD2, 0x9A, 0x62, 0x14, 0xD9, 0x4B, 0x9B,
+    0x38, 0x93, 0x13, 0x9B, 0xF4, 0xD0, 0xB2, 0x26, 0x9A, 0x4A, 0xCF, 0x65,
+    0x32, 0x08, 0x69, 0xA5, 0x34, 0xA1, 0x69, 0x4D, 0x3F, 0x65, 0x29, 0x22,
+    0x48, 0x21, 0x4C, 0x42, 0x46, 0x69, 0x48, 0x93, 0xA5, 0x3A, 0x59, 0xA5,
+    0x3E, 0xCE, 0x94, 0xD2, 0x9B, 0x29, 0xE9, 0xD3, 0xF4, 0xD3, 0xD3, 0xD3,
+    0xA4, 0x89, 0x22, 0x17, 0xF9, 0x12, 0x44, 0xFD, 0x0D, 0xF9, 0x4B, 0x3A,
+    0x85, 0x22, 0x1A, 0x53, 0x66, 0x9A, 0x48, 0x84, 0x4F, 0xF0, 0x53, 0x29,
+};
@@ -0,0 +1,17 @@
+const uint8_t FLAC_SHORT_LAST[] = {
+    0x66, 0x4C, 0x61, 0x43, 0x80, 0x00, 0x00, 0x22, 0x00, 0x0C, 0x00, 0x18,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x0A, 0xC4, 0x40, 0xF0, 0x00, 0x00,
+    0x00, 0x3C, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xF8, 0x70, 0x08, 0x00, 0x00,
+    0x17, 0x7F, 0x14, 0x42, 0x25, 0x47, 0x1C, 0x41, 0x7F, 0x4C, 0xED, 0xD6,
+    0x1C, 0x25, 0x26, 0xBF, 0xD0, 0xD8, 0xD1, 0x34, 0xDF, 0x2C, 0x4E, 0xE4,
+    0x2A, 0x8A, 0x1E, 0x5E, 0xF6, 0x8F, 0x8A, 0xA0, 0xA4, 0xD5, 0x01, 0xCA,
+    0x92, 0x2B, 0x8C, 0x49, 0x35, 0x98, 0xA7, 0x70, 0x86, 0x39, 0xFF, 0xF8,
+    0x70, 0x08, 0x01, 0x00, 0x17, 0x14, 0x14, 0x2B, 0x96, 0x23, 0xCB, 0x41,
+    0x59, 0x1B, 0xD3, 0x0D, 0xD6, 0x28, 0x92, 0x3B, 0xA0, 0xDA, 0xE6, 0x10,
+    0xC5, 0xA2, 0xB3, 0x02, 0x64, 0x12, 0x8F, 0x47, 0x2E, 0x42, 0x1B, 0xCB,
+    0xE2, 0xB1, 0x33, 0x1F, 0x65, 0x3A, 0x87, 0x8F, 0x66, 0xE0, 0x23, 0x2E,
+    0xFF, 0xF8, 0x70, 0x08, 0x02, 0x00, 0x0B, 0xFD, 0x14, 0x9B, 0x5C, 0x98,
+    0x40, 0x41, 0x6F, 0xE0, 0x2A, 0x1C, 0x83, 0x89, 0xD2, 0x56, 0x5B, 0x54,
+    0x11, 0xBA, 0xEF, 0x2D, 0xBD, 0xAA, 0xB0, 0x77, 0x3E,
+};
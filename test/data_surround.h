@@ -0,0 +1,96 @@
+const uint8_t FLAC_SURROUND[] = {
+    0x66, 0x4C, 0x61, 0x43, 0x80, 0x00, 0x00, 0x22, 0x00, 0x10, 0x00, 0x10,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x0B, 0xB8, 0x0A, 0xF0, 0x00, 0x00,
+    0x00, 0x28, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xF8, 0x70, 0x58, 0x00, 0x00,
+    0x0F, 0xCB, 0x14, 0x0E, 0x94, 0xEC, 0x81, 0x41, 0x74, 0x8E, 0xFC, 0x66,
+    0xBC, 0x33, 0x40, 0x66, 0x90, 0x4B, 0x84, 0xFE, 0x1D, 0x8C, 0x60, 0x03,
+    0x52, 0xFE, 0x28, 0xBD, 0x54, 0xBF, 0x8C, 0x97, 0x14, 0xA7, 0x22, 0x8A,
+    0xAC, 0x41, 0xA7, 0xA4, 0xC4, 0x8E, 0x49, 0x05, 0x2E, 0xA3, 0x20, 0x49,
+    0x3F, 0xCB, 0x2A, 0x3B, 0x51, 0x3F, 0xF8, 0x63, 0xB3, 0xE3, 0x9B, 0x22,
+    0xBC, 0x24, 0x8B, 0x96, 0x28, 0x8A, 0x49, 0x29, 0xED, 0x87, 0x20, 0xEF,
+    0xD4, 0x4D, 0x4A, 0x62, 0x12, 0xBB, 0x76, 0x0E, 0x81, 0xC1, 0x10, 0x28,
+    0xBA, 0x39, 0x13, 0x64, 0x9F, 0x4A, 0x21, 0xB8, 0xF0, 0xD3, 0x64, 0x1E,
+    0x11, 0x22, 0x1C, 0x10, 0x85, 0x38, 0x6C, 0x58, 0x53, 0x90, 0x79, 0x17,
+    0xD6, 0xFA, 0x35, 0xEB, 0x3A, 0x32, 0x84, 0x33, 0x81, 0x08, 0x11, 0x32,
+    0x11, 0x47, 0xD7, 0x00, 0xB2, 0xCA, 0xE6, 0x1A, 0x23, 0xBC, 0xDF, 0xD8,
+    0xFE, 0x2B, 0x45, 0xF3, 0xF0, 0xA2, 0x54, 0x72, 0xA4, 0xE2, 0x0F, 0x34,
+    0xB0, 0x4A, 0x0E, 0xA3, 0xA2, 0xE0, 0xB6, 0xD5, 0x37, 0x48, 0x4B, 0x86,
+    0x83, 0x3E, 0x70, 0xA3, 0x9F, 0x39, 0x47, 0x4B, 0x3A, 0x63, 0x7D, 0x90,
+    0xAD, 0xD9, 0x3A, 0x61, 0xCB, 0x90, 0x01, 0x47, 0x03, 0x8C, 0xFC, 0xD4,
+    0x21, 0xF7, 0xC0, 0x70, 0x53, 0x09, 0x2D, 0x8D, 0x6B, 0xB4, 0xAE, 0x25,
+    0x23, 0xF2, 0xEC, 0xFC, 0x69, 0x0E, 0x7C, 0xB3, 0x9A, 0x15, 0x42, 0x14,
+    0x1D, 0xD9, 0xBB, 0x3C, 0x25, 0x00, 0x75, 0x99, 0x70, 0xC4, 0x40, 0xFF,
+    0xF8, 0x70, 0x58, 0x01, 0x00, 0x0F, 0xA0, 0x14, 0x72, 0x59, 0x68, 0x2C,
+    0x41, 0x62, 0xD4, 0xD0, 0xFA, 0xD9, 0xD5, 0x06, 0x99, 0x11, 0x0F, 0x2E,
+    0x9E, 0x32, 0x00, 0x31, 0xE3, 0xA0, 0x86, 0x0F, 0x3A, 0x5B, 0x72, 0x3F,
+    0xB0, 0x51, 0xD3, 0x95, 0x92, 0x0D, 0x06, 0x95, 0x88, 0xA9, 0xCF, 0xF5,
+    0x48, 0x94, 0xA8, 0xD3, 0xF0, 0xAE, 0x11, 0x06, 0xF7, 0xD1, 0x2C, 0x73,
+    0x4F, 0x5F, 0x4B, 0x8F, 0xD2, 0x18, 0xF8, 0x18, 0xE7, 0x98, 0x51, 0xA5,
+    0xD5, 0x74, 0x95, 0x07, 0x17, 0x97, 0xE1, 0x28, 0x13, 0x24, 0x0E, 0x0A,
+    0x09, 0xEC, 0x0F, 0x83, 0x26, 0xF5, 0x32, 0x00, 0x9F, 0xA8, 0xC3, 0xFE,
+    0x11, 0x23, 0xEA, 0x6C, 0xA1, 0x33, 0x94, 0x41, 0x5D, 0x14, 0x5D, 0x48,
+    0x5B, 0x65, 0x41, 0xEF, 0xD0, 0xDE, 0x19, 0x63, 0x30, 0x23, 0x42, 0x48,
+    0x83, 0xB7, 0x21, 0x0C, 0x7B, 0xC7, 0x8C, 0xA6, 0x4C, 0xFF, 0x82, 0x2F,
+    0x9D, 0xF7, 0x1F, 0xE3, 0x10, 0x61, 0x43, 0x67, 0x7B, 0x0A, 0x26, 0x3F,
+    0xAC, 0xDB, 0x20, 0xF3, 0x90, 0xE4, 0xB1, 0x28, 0x39, 0x47, 0x8C, 0x20,
+    0xD3, 0x14, 0x4C, 0x9D, 0x0C, 0x38, 0x33, 0x0A, 0xD3, 0x13, 0x62, 0x64,
+    0xB2, 0xC8, 0x33, 0x2F, 0x8A, 0x17, 0x33, 0x7F, 0x1C, 0xAA, 0x96, 0x14,
+    0x30, 0x16, 0x50, 0xDC, 0x42, 0x0D, 0x84, 0x69, 0x1A, 0xE4, 0xAB, 0xF5,
+    0x15, 0x17, 0x14, 0x44, 0x71, 0xB6, 0xBC, 0x25, 0x74, 0x35, 0x1E, 0xB2,
+    0x95, 0x00, 0x82, 0x8F, 0xB6, 0xDE, 0x64, 0x7C, 0x12, 0xBB, 0xDC, 0x54,
+    0x13, 0xC0, 0xCD, 0xBB, 0xFF, 0xF8, 0x70, 0x58, 0x02, 0x00, 0x07, 0x25,
+    0x14, 0x35, 0x35, 0x54, 0xA2, 0x41, 0x8C, 0xF9, 0xE5, 0x9D, 0xD5, 0x37,
+    0xDF, 0xF2, 0xE3, 0xF2, 0x31, 0x4A, 0x03, 0xBD, 0x5A, 0xB4, 0x1B, 0xF7,
+    0x86, 0x64, 0xED, 0xE9, 0x44, 0x79, 0x24, 0x60, 0x69, 0xA1, 0x45, 0x2F,
+    0x5C, 0x63, 0xF3, 0x50, 0x71, 0xBF, 0x79, 0xEB, 0x6B, 0xED, 0x89, 0x8E,
+    0x2C, 0xD2, 0x67, 0x06, 0xC8, 0x51, 0x77, 0xC7, 0x66, 0x61, 0x07, 0xF5,
+    0xB3, 0x19, 0x20, 0xD9, 0xEB, 0x8F, 0xC2, 0x52, 0x0D, 0x1F, 0x9B, 0xD0,
+    0x51, 0x2F, 0xF1, 0x50, 0x31, 0x07, 0x9A, 0xA6, 0xE5, 0x85, 0x21, 0xBF,
+    0x28, 0x5C, 0x03, 0x9B, 0x33, 0x25, 0x9D, 0x40, 0xA5, 0x81, 0xC3, 0x34,
+    0x9A, 0x10, 0x22, 0xFC, 0x76, 0x04, 0xD2, 0xC2, 0x0C, 0x8E, 0x80, 0xB5,
+    0xA3, 0x64, 0x8F, 0x08, 0x15, 0x1B,
+};
+
+const int32_t FLAC_SURROUND_OUT[] = {
+    244580352, -1490944000, -1840054272, -508493824, 1250820096, 1882718208,
+    -327090176, -1968439296, -619839488, 1632501760, 1419509760, -808648704,
+    -917897216, -1664548864, 1125777408, 1526005760, -1253507072, -1421737984,
+    -1376387072, -786497536, 1979449344, -679411712, -1502937088, 1734148096,
+    -1721892864, 394199040, 1202847744, -1985347584, 1273561088, 278855680,
+    -1959919616, 1452081152, -502857728, -522518528, 1442578432, -1939210240,
+    -1956184064, 1970667520, -1872101376, 1594753024, -1317142528, 911867904,
+    -1671954432, 1685651456, -1596850176, 1555496960, -1456209920, 1350434816,
+    -1371078656, 777912320, -3670016, -667484160, 1220018176, -1696923648,
+    -879165440, -470614016, 1548812288, -1902706688, 1449918464, -327811072,
+    -219480064, -1458700288, 1896284160, -564396032, -1315897344, 1907032064,
+    328663040, -1949827072, 604241920, 1630404608, -1500971008, -858849280,
+    940048384, -1688535040, -1097400320, 1552285696, 1261633536, -1414660096,
+    1385037824, -791740416, -1959198720, -663093248, 1492123648, 1747648512,
+    1750335488, 410058752, -1172373504, -1927610368, -1310130176, 279314432,
+    1875771392, 1508507648, 556138496, -520421376, -1486749696, -1940586496,
+    1918435328, 1961164800, 1769275392, 1564999680, 1283391488, 806748160,
+    1747714048, 1686306816, 1562705920, 1533345792, 1505099776, 1356595200,
+    1347747840, 781713408, 27590656, -621084672, -1261436928, -1722089472,
+    876544000, -473628672, -1488125952, -1956904960, -1468137472, -280231936,
+    291110912, -1483014144, -1824718848, -507445248, 1320878080, 1899102208,
+    -378667008, -1912209408, -682295296, 1617887232, 1408303104, -899743744,
+    -876216320, -1628504064, 1125974016, 1564540928, -1231224832, -1407582208,
+    -1377763328, -711327744, 1893203968, -671481856, -1479606272, 1764950016,
+    -1756692480, 481558528, 1189675008, -1975386112, 1231486976, 276496384,
+    -1963655168, 1418264576, -588251136, -507772928, 1415970816, -1899167744,
+    -1864695808, 1937178624, -1875050496, 1630666752, -1290272768, 845086720,
+    -1711144960, 1671823360, -1553268736, 1521745920, -1423048704, 1398865920,
+    -1321730048, 750059520, -82444288, -697434112, 1235419136, -1729560576,
+    -809959424, -475332608, 1502281728, -1964244992, 1465778176, -302841856,
+    -249692160, -1465450496, 1905065984, -525533184, -1254817792, 1911816192,
+    377028608, -1969881088, 685768704, 1575550976, -1470693376, -842203136,
+    892665856, -1606746112, -1116667904, 1576075264, 1274806272, -1338507264,
+    1419902976, -710213632, -1882390528, -644349952, 1410072576, 1720909824,
+    1729429504, 445841408, -1172832256, -1963851776, -1317011456, 284950528,
+    1960050688, 1441202176, 567279616, -523304960, -1488584704, -1958871040,
+    1944649728, 1969750016, 1789853696, 1582956544, 1289093120, 906166272,
+    1665007616, 1661206528, 1640497152, 1574043648, 1449263104, 1380384768,
+    1306132480, 790495232, 71761920, -609878016, -1289682944, -1745027072,
+    820248576, -403374080, -1482752000, -1930166272, -1447821312, -275513344,
+};
@@ -19,6 +19,9 @@
 #include <stdbool.h>
 #include <stdlib.h>
 
+#include <foxen-flac-cache.h>
+#include <foxen-flac-index.h>
+#include <foxen-flac-ogg.h>
 #include <foxen-flac.h>
 #include <foxen-unittest.h>
 
@@ -26,9 +29,16 @@
  * Unit tests                                                                 *
  ******************************************************************************/
 
+#include "data_32bit.h"
+#include "data_constant.h"
+#include "data_cuesheet.h"
 #include "data_fixed_1.h"
 #include "data_fixed_2.h"
 #include "data_header.h"
+#include "data_ogg.h"
+#include "data_short_last.h"
+#include "data_surround.h"
+#include "data_variable.h"
 
 static void check_flac_metadata_short(fx_flac_t *inst)
 {
@@ -269,6 +279,1539 @@ static void test_flac_fixed_2()
 	                               sizeof(FLAC_FIXED_2_OUT) / 4U);
 }
 
+static void test_flac_32bit()
+{
+	/* Seven frames covering all channel assignments, with side channels
+	   requiring 33 bits per sample, constant subframes and wasted bits */
+	const uint32_t n_out = sizeof(FLAC_32BIT_OUT) / 4U;
+	const uint32_t chunk_sizes[] = {1U, 13U, sizeof(FLAC_32BIT)};
+	for (uint32_t i = 0U; i < sizeof(chunk_sizes) / 4U; i++) {
+		fx_flac_t *inst = FX_FLAC_ALLOC_DEFAULT();
+		ASSERT_NE(NULL, inst);
+		int32_t out[sizeof(FLAC_32BIT_OUT) / 4U];
+		uint32_t in_ptr = 0U, out_ptr = 0U;
+		while (true) {
+			uint32_t in_len = sizeof(FLAC_32BIT) - in_ptr;
+			if (in_len > chunk_sizes[i]) {
+				in_len = chunk_sizes[i];
+			}
+			uint32_t out_len = n_out - out_ptr;
+			fx_flac_state_t state = fx_flac_process(
+			    inst, FLAC_32BIT + in_ptr, &in_len, out + out_ptr, &out_len);
+			ASSERT_NE(FLAC_ERR, state);
+			in_ptr += in_len;
+			out_ptr += out_len;
+			if (in_len == 0U && out_len == 0U &&
+			    in_ptr == sizeof(FLAC_32BIT)) {
+				break;
+			}
+		}
+		EXPECT_EQ(32, fx_flac_get_streaminfo(inst, FLAC_KEY_SAMPLE_SIZE));
+		ASSERT_EQ(n_out, out_ptr);
+		for (uint32_t j = 0U; j < n_out; j++) {
+			ASSERT_EQ(FLAC_32BIT_OUT[j], out[j]);
+		}
+		free(inst);
+	}
+}
+
+static void test_flac_planar()
+{
+	/* Decode into the caller's buffers, alternating between two slots */
+	const uint32_t n_out = sizeof(FLAC_32BIT_OUT) / 4U;
+	fx_flac_t *inst = FX_FLAC_ALLOC_PLANAR(16U, 2U);
+	ASSERT_NE(NULL, inst);
+	ASSERT_GT(fx_flac_size(16U, 2U), fx_flac_size_planar(16U, 2U));
+	int32_t mem[4U * 16U + 4U];
+	int32_t *base = (int32_t *)(((uintptr_t)mem + 15U) & ~(uintptr_t)15U);
+	int32_t *slots[2][2] = {{base, base + 16U}, {base + 32U, base + 48U}};
+	int32_t *unaligned[2] = {base + 1U, base};
+	EXPECT_EQ(false, fx_flac_set_planar_output(inst, unaligned));
+
+	uint32_t in_ptr = 0U, out_ptr = 0U, n_frames = 0U;
+	while (in_ptr < sizeof(FLAC_32BIT)) {
+		uint32_t in_len = sizeof(FLAC_32BIT) - in_ptr;
+		fx_flac_state_t state =
+		    fx_flac_process(inst, FLAC_32BIT + in_ptr, &in_len, NULL, NULL);
+		ASSERT_NE(FLAC_ERR, state);
+		in_ptr += in_len;
+		if (state == FLAC_END_OF_FRAME) {
+			fx_flac_frame_info_t info;
+			ASSERT_EQ(true, fx_flac_get_frame_info(inst, &info));
+			int32_t *const *slot = slots[n_frames % 2U];
+			for (uint32_t j = 0U; j < info.n_samples; j++) {
+				ASSERT_EQ(FLAC_32BIT_OUT[out_ptr++], slot[0][j]);
+				ASSERT_EQ(FLAC_32BIT_OUT[out_ptr++], slot[1][j]);
+			}
+			n_frames++;
+			ASSERT_EQ(true,
+			          fx_flac_set_planar_output(inst, slots[n_frames % 2U]));
+		} else if (state == FLAC_END_OF_METADATA) {
+			ASSERT_EQ(true, fx_flac_set_planar_output(inst, slots[0]));
+		}
+	}
+	EXPECT_EQ(7U, n_frames);
+	EXPECT_EQ(n_out, out_ptr);
+	free(inst);
+}
+
+static uint32_t decode_chunked(fx_flac_t *inst, const uint8_t *in,
+                               uint32_t in_len, uint32_t chunk, int32_t *out,
+                               uint32_t out_max)
+{
+	/* Use a small output buffer to exercise resuming the mix mid-frame */
+	uint32_t in_ptr = 0U, out_ptr = 0U;
+	while (true) {
+		uint32_t n_in = in_len - in_ptr;
+		uint32_t n_out = out_max - out_ptr;
+		n_in = (n_in > chunk) ? chunk : n_in;
+		n_out = (n_out > 5U) ? 5U : n_out;
+		fx_flac_state_t state =
+		    fx_flac_process(inst, in + in_ptr, &n_in, out + out_ptr, &n_out);
+		if (state == FLAC_ERR) {
+			return 0U;
+		}
+		in_ptr += n_in;
+		out_ptr += n_out;
+		if (n_in == 0U && n_out == 0U) {
+			return out_ptr;
+		}
+	}
+}
+
+static uint32_t decode_mixed(fx_flac_t *inst, const uint8_t *in,
+                             uint32_t in_len, int32_t *out, uint32_t out_max)
+{
+	return decode_chunked(inst, in, in_len, in_len, out, out_max);
+}
+
+static void check_mixed(const int32_t *in, uint32_t n_smpls, uint8_t n_in,
+                        const int16_t *matrix, uint8_t n_out,
+                        const int32_t *out)
+{
+	for (uint32_t i = 0U; i < n_smpls; i++) {
+		for (uint8_t o = 0U; o < n_out; o++) {
+			int64_t acc = 0;
+			for (uint8_t c = 0U; c < n_in; c++) {
+				acc += (int64_t)in[i * n_in + c] * matrix[o * n_in + c];
+			}
+			acc >>= 14;
+			acc = (acc > INT32_MAX) ? INT32_MAX : acc;
+			acc = (acc < INT32_MIN) ? INT32_MIN : acc;
+			ASSERT_EQ(acc, out[i * n_out + o]);
+		}
+	}
+}
+
+static void test_flac_downmix()
+{
+	/* ITU downmix of 5.1 with center and surround channels at -3 dB,
+	   normalised by 1 + 2 * 0.7071 */
+	const uint32_t n_smpls = sizeof(FLAC_SURROUND_OUT) / 4U / 6U;
+	const int16_t stereo[] = {6786, 0,    4798, 0, 4798, 0,
+	                          0,    6786, 4798, 0, 0,    4798};
+	const int16_t mono[] = {3393, 3393, 4798, 0, 2399, 2399};
+	int32_t out[sizeof(FLAC_SURROUND_OUT) / 4U];
+
+	fx_flac_t *inst = FX_FLAC_ALLOC_DEFAULT();
+	ASSERT_NE(NULL, inst);
+	EXPECT_EQ(false, fx_flac_set_downmix(inst, FLAC_DOWNMIX_CUSTOM));
+	ASSERT_EQ(true, fx_flac_set_downmix(inst, FLAC_DOWNMIX_STEREO));
+	ASSERT_EQ(2U * n_smpls, decode_mixed(inst, FLAC_SURROUND,
+	                                     sizeof(FLAC_SURROUND), out,
+	                                     2U * n_smpls));
+	check_mixed(FLAC_SURROUND_OUT, n_smpls, 6U, stereo, 2U, out);
+
+	/* The setting survives a reset */
+	fx_flac_reset(inst);
+	ASSERT_EQ(true, fx_flac_set_downmix(inst, FLAC_DOWNMIX_MONO));
+	ASSERT_EQ(n_smpls, decode_mixed(inst, FLAC_SURROUND, sizeof(FLAC_SURROUND),
+	                                out, n_smpls));
+	check_mixed(FLAC_SURROUND_OUT, n_smpls, 6U, mono, 1U, out);
+
+	/* Custom matrix with saturation; swaps the channels of a stereo stream and
+	   adds both channels with a gain of almost two to the third channel */
+	const int16_t custom[] = {0, FLAC_DOWNMIX_UNITY, FLAC_DOWNMIX_UNITY, 0,
+	                          32767, 32767};
+	const uint32_t n_32 = sizeof(FLAC_32BIT_OUT) / 4U / 2U;
+	int32_t out_32[3U * sizeof(FLAC_32BIT_OUT) / 4U / 2U];
+	EXPECT_EQ(false, fx_flac_set_downmix_matrix(inst, custom, 2U, 9U));
+	ASSERT_EQ(true, fx_flac_set_downmix_matrix(inst, custom, 2U, 3U));
+	fx_flac_reset(inst);
+	ASSERT_EQ(3U * n_32, decode_mixed(inst, FLAC_32BIT, sizeof(FLAC_32BIT),
+	                                  out_32, 3U * n_32));
+	check_mixed(FLAC_32BIT_OUT, n_32, 2U, custom, 3U, out_32);
+
+	/* Frames with a different channel count are not mixed */
+	fx_flac_reset(inst);
+	ASSERT_EQ(6U * n_smpls, decode_mixed(inst, FLAC_SURROUND,
+	                                     sizeof(FLAC_SURROUND), out,
+	                                     6U * n_smpls));
+	for (uint32_t i = 0U; i < 6U * n_smpls; i++) {
+		ASSERT_EQ(FLAC_SURROUND_OUT[i], out[i]);
+	}
+	free(inst);
+}
+
+static void test_flac_channel_mask()
+{
+	fx_flac_t *inst = FX_FLAC_ALLOC_DEFAULT();
+	ASSERT_NE(NULL, inst);
+
+	/* Select three of the six independent channels of the 5.1 stream */
+	const uint32_t n_smpls = sizeof(FLAC_SURROUND_OUT) / 4U / 6U;
+	const uint8_t sel[] = {0U, 2U, 5U};
+	int32_t out[sizeof(FLAC_SURROUND_OUT) / 4U];
+	fx_flac_set_channel_mask(inst, 0x25U);
+	ASSERT_EQ(3U * n_smpls, decode_mixed(inst, FLAC_SURROUND,
+	                                     sizeof(FLAC_SURROUND), out,
+	                                     3U * n_smpls));
+	for (uint32_t i = 0U; i < n_smpls; i++) {
+		for (uint8_t j = 0U; j < 3U; j++) {
+			ASSERT_EQ(FLAC_SURROUND_OUT[6U * i + sel[j]], out[3U * i + j]);
+		}
+	}
+
+	/* Masked channels are treated as silent when mixing */
+	const int16_t matrix[] = {FLAC_DOWNMIX_UNITY, FLAC_DOWNMIX_UNITY,
+	                          FLAC_DOWNMIX_UNITY, FLAC_DOWNMIX_UNITY,
+	                          FLAC_DOWNMIX_UNITY, FLAC_DOWNMIX_UNITY};
+	const int16_t matrix_masked[] = {FLAC_DOWNMIX_UNITY, 0, FLAC_DOWNMIX_UNITY,
+	                                 0, 0, FLAC_DOWNMIX_UNITY};
+	fx_flac_reset(inst);
+	ASSERT_EQ(true, fx_flac_set_downmix_matrix(inst, matrix, 6U, 1U));
+	ASSERT_EQ(n_smpls, decode_mixed(inst, FLAC_SURROUND, sizeof(FLAC_SURROUND),
+	                                out, n_smpls));
+	check_mixed(FLAC_SURROUND_OUT, n_smpls, 6U, matrix_masked, 1U, out);
+
+	/* Decode only one channel of the stereo pairs in the 32-bit stream */
+	const uint32_t n_32 = sizeof(FLAC_32BIT_OUT) / 4U / 2U;
+	int32_t out_32[sizeof(FLAC_32BIT_OUT) / 4U / 2U];
+	ASSERT_EQ(true, fx_flac_set_downmix(inst, FLAC_DOWNMIX_NONE));
+	for (uint8_t c = 0U; c < 2U; c++) {
+		fx_flac_reset(inst);
+		fx_flac_set_channel_mask(inst, (uint8_t)(1U << c));
+		ASSERT_EQ(n_32, decode_mixed(inst, FLAC_32BIT, sizeof(FLAC_32BIT),
+		                             out_32, n_32));
+		for (uint32_t i = 0U; i < n_32; i++) {
+			ASSERT_EQ(FLAC_32BIT_OUT[2U * i + c], out_32[i]);
+		}
+	}
+
+	/* Skipping the residual of the masked channel must also work when the
+	   stream is fed one byte at a time */
+	fx_flac_reset(inst);
+	fx_flac_set_channel_mask(inst, 0x02U);
+	ASSERT_EQ(n_32,
+	          decode_chunked(inst, FLAC_32BIT, sizeof(FLAC_32BIT), 1U, out_32,
+	                         n_32));
+	for (uint32_t i = 0U; i < n_32; i++) {
+		ASSERT_EQ(FLAC_32BIT_OUT[2U * i + 1U], out_32[i]);
+	}
+	free(inst);
+}
+
+static void test_flac_output_stage()
+{
+	const uint32_t n = sizeof(FLAC_SURROUND_OUT) / 4U;
+	int32_t out[sizeof(FLAC_SURROUND_OUT) / 4U];
+	int32_t out_ref[sizeof(FLAC_SURROUND_OUT) / 4U];
+	fx_flac_t *inst = FX_FLAC_ALLOC_DEFAULT();
+	ASSERT_NE(NULL, inst);
+	EXPECT_EQ(false, fx_flac_set_gain(inst, -1));
+	EXPECT_EQ(false, fx_flac_set_gain(inst, FLAC_GAIN_MAX + 1));
+	EXPECT_EQ(false, fx_flac_set_output_depth(inst, 33U, FLAC_DITHER_NONE));
+
+	/* A gain of two clips */
+	ASSERT_EQ(true, fx_flac_set_gain(inst, 2 * FLAC_GAIN_UNITY));
+	ASSERT_EQ(n, decode_mixed(inst, FLAC_SURROUND, sizeof(FLAC_SURROUND), out,
+	                          n));
+	for (uint32_t i = 0U; i < n; i++) {
+		int64_t v = 2 * (int64_t)FLAC_SURROUND_OUT[i];
+		v = (v > INT32_MAX) ? INT32_MAX : ((v < INT32_MIN) ? INT32_MIN : v);
+		ASSERT_EQ(v, out[i]);
+	}
+
+	/* Requantise to 8 bits after applying a gain of 0.75. The error is at
+	   most half an LSB without dither, 1.5 LSB with TPDF dither, and the
+	   difference of two such errors with noise shaping. */
+	const int64_t lsb = 1 << 24;
+	const int64_t max_err[] = {lsb / 2, 3 * lsb / 2, 3 * lsb};
+	ASSERT_EQ(true, fx_flac_set_gain(inst, 3 * FLAC_GAIN_UNITY / 4));
+	for (int d = FLAC_DITHER_NONE; d <= FLAC_DITHER_SHAPED; d++) {
+		ASSERT_EQ(true,
+		          fx_flac_set_output_depth(inst, 8U, (fx_flac_dither_t)d));
+		for (int pass = 0; pass < 2; pass++) {
+			fx_flac_reset(inst);
+			ASSERT_EQ(n, decode_mixed(inst, FLAC_SURROUND,
+			                          sizeof(FLAC_SURROUND), out, n));
+			for (uint32_t i = 0U; i < n; i++) {
+				const int64_t x = ((int64_t)FLAC_SURROUND_OUT[i] * 3) / 4;
+				const int64_t e = (int64_t)out[i] - x;
+				ASSERT_EQ(0, out[i] & (lsb - 1));
+				ASSERT_GE(max_err[d], (e < 0) ? -e : e);
+				if (pass == 0) {
+					out_ref[i] = out[i];
+				} else {
+					/* The dither sequence restarts after a reset */
+					ASSERT_EQ(out_ref[i], out[i]);
+				}
+			}
+		}
+	}
+
+	/* Mixed output is requantised as well */
+	fx_flac_reset(inst);
+	ASSERT_EQ(true, fx_flac_set_downmix(inst, FLAC_DOWNMIX_MONO));
+	ASSERT_EQ(n / 6U, decode_mixed(inst, FLAC_SURROUND, sizeof(FLAC_SURROUND),
+	                               out, n / 6U));
+	for (uint32_t i = 0U; i < n / 6U; i++) {
+		ASSERT_EQ(0, out[i] & (lsb - 1));
+	}
+	free(inst);
+}
+
+static void test_flac_peaks()
+{
+	/* Split the 5.1 stream into buckets of seven samples that span frame
+	   boundaries; only two buckets fit into the peak array at once */
+	const uint32_t n_smpls = sizeof(FLAC_SURROUND_OUT) / 4U / 6U;
+	const uint32_t n_buckets = (n_smpls + 6U) / 7U;
+	fx_flac_peak_t peaks[2U * 6U], all[6U * 6U];
+	fx_flac_t *inst = FX_FLAC_ALLOC_DEFAULT();
+	ASSERT_NE(NULL, inst);
+	fx_flac_set_peak_output(inst, 7U, peaks, 12U);
+
+	uint32_t in_ptr = 0U, n_all = 0U;
+	int32_t out[16];
+	while (true) {
+		uint32_t n_in = sizeof(FLAC_SURROUND) - in_ptr, n_out = 16U;
+		ASSERT_NE(FLAC_ERR, fx_flac_process(inst, FLAC_SURROUND + in_ptr,
+		                                    &n_in, out, &n_out));
+		EXPECT_EQ(0U, n_out);
+		in_ptr += n_in;
+		const uint32_t n_peaks = fx_flac_get_peak_count(inst);
+		if (n_in == 0U && n_peaks == 0U) {
+			break;
+		}
+		for (uint32_t i = 0U; i < n_peaks; i++) {
+			all[n_all++] = peaks[i];
+		}
+		fx_flac_set_peak_output(inst, 7U, peaks, 12U);
+	}
+	ASSERT_EQ(true, fx_flac_flush_peaks(inst));
+	for (uint32_t i = 0U; i < fx_flac_get_peak_count(inst); i++) {
+		all[n_all++] = peaks[i];
+	}
+	ASSERT_EQ(6U * n_buckets, n_all);
+
+	for (uint32_t b = 0U; b < n_buckets; b++) {
+		for (uint32_t c = 0U; c < 6U; c++) {
+			int32_t lo = INT32_MAX, hi = INT32_MIN;
+			uint64_t sum_sq = 0U;
+			for (uint32_t i = 7U * b; i < 7U * b + 7U && i < n_smpls; i++) {
+				const int32_t x = FLAC_SURROUND_OUT[6U * i + c];
+				lo = (x < lo) ? x : lo;
+				hi = (x > hi) ? x : hi;
+				sum_sq += (uint64_t)((int64_t)(x >> 16) * (x >> 16));
+			}
+			EXPECT_EQ(lo, all[6U * b + c].min);
+			EXPECT_EQ(hi, all[6U * b + c].max);
+			EXPECT_EQ(sum_sq, all[6U * b + c].sum_sq);
+		}
+	}
+	free(inst);
+}
+
+static void test_flac_constant()
+{
+	/* The stream consists of a silent frame, a constant mid/side frame with
+	   wasted bits, a left/side frame with a constant left channel and a
+	   regular right/side frame */
+	const bool silent[] = {true, false, false, false};
+	const uint32_t n = sizeof(FLAC_CONSTANT_OUT) / 4U;
+	int32_t out[sizeof(FLAC_CONSTANT_OUT) / 4U];
+	fx_flac_t *inst = FX_FLAC_ALLOC_DEFAULT();
+	ASSERT_NE(NULL, inst);
+	for (int verify = 0; verify < 2; verify++) {
+		fx_flac_reset(inst);
+		fx_flac_set_verify_only(inst, verify);
+		uint32_t in_ptr = 0U, out_ptr = 0U, n_frames = 0U;
+		while (true) {
+			uint32_t n_in = sizeof(FLAC_CONSTANT) - in_ptr;
+			uint32_t n_out = n - out_ptr;
+			fx_flac_state_t state = fx_flac_process(
+			    inst, FLAC_CONSTANT + in_ptr, &n_in, out + out_ptr, &n_out);
+			ASSERT_NE(FLAC_ERR, state);
+			if (state == FLAC_END_OF_FRAME) {
+				fx_flac_frame_info_t info;
+				ASSERT_EQ(true, fx_flac_get_frame_info(inst, &info));
+				ASSERT_GT(4U, n_frames);
+				EXPECT_EQ(silent[n_frames], info.silent);
+				n_frames++;
+			}
+			in_ptr += n_in;
+			out_ptr += n_out;
+			if (n_in == 0U && n_out == 0U) {
+				break;
+			}
+		}
+		EXPECT_EQ(4U, n_frames);
+		ASSERT_EQ(verify ? 0U : n, out_ptr);
+		for (uint32_t i = 0U; i < out_ptr; i++) {
+			ASSERT_EQ(FLAC_CONSTANT_OUT[i], out[i]);
+		}
+	}
+
+	/* Write a single channel in small chunks */
+	fx_flac_reset(inst);
+	fx_flac_set_verify_only(inst, false);
+	fx_flac_set_channel_mask(inst, 0x02U);
+	ASSERT_EQ(n / 2U, decode_mixed(inst, FLAC_CONSTANT, sizeof(FLAC_CONSTANT),
+	                               out, n / 2U));
+	for (uint32_t i = 0U; i < n / 2U; i++) {
+		ASSERT_EQ(FLAC_CONSTANT_OUT[2U * i + 1U], out[i]);
+	}
+	free(inst);
+}
+
+static void test_flac_range()
+{
+	/* The 32-bit test stream consists of seven frames with 16 samples each */
+	const uint32_t n_smpls = sizeof(FLAC_32BIT_OUT) / 4U / 2U;
+	const uint64_t ranges[][2] = {{20U, 50U},
+	                              {0U, 16U},
+	                              {16U, 17U},
+	                              {100U, FLAC_RANGE_END_OF_STREAM}};
+	int32_t out[sizeof(FLAC_32BIT_OUT) / 4U];
+	fx_flac_t *inst = FX_FLAC_ALLOC_DEFAULT();
+	ASSERT_NE(NULL, inst);
+	EXPECT_EQ(false, fx_flac_set_range(inst, 5U, 5U));
+	for (uint32_t i = 0U; i < sizeof(ranges) / sizeof(ranges[0]); i++) {
+		const uint32_t first = (uint32_t)ranges[i][0];
+		const uint32_t end = (ranges[i][1] > n_smpls) ? n_smpls
+		                                              : (uint32_t)ranges[i][1];
+		fx_flac_reset(inst);
+		ASSERT_EQ(true, fx_flac_set_range(inst, ranges[i][0], ranges[i][1]));
+		ASSERT_EQ(2U * (end - first),
+		          decode_mixed(inst, FLAC_32BIT, sizeof(FLAC_32BIT), out,
+		                       2U * n_smpls));
+		for (uint32_t j = 0U; j < 2U * (end - first); j++) {
+			ASSERT_EQ(FLAC_32BIT_OUT[2U * first + j], out[j]);
+		}
+		if (ranges[i][1] != FLAC_RANGE_END_OF_STREAM) {
+			EXPECT_EQ(FLAC_END_OF_RANGE, fx_flac_get_state(inst));
+		}
+	}
+
+	/* Skip the frames in front of the range while feeding one byte at a
+	   time */
+	fx_flac_reset(inst);
+	ASSERT_EQ(true, fx_flac_set_range(inst, 40U, 90U));
+	ASSERT_EQ(2U * 50U, decode_chunked(inst, FLAC_32BIT, sizeof(FLAC_32BIT),
+	                                   1U, out, 2U * n_smpls));
+	for (uint32_t j = 0U; j < 2U * 50U; j++) {
+		ASSERT_EQ(FLAC_32BIT_OUT[2U * 40U + j], out[j]);
+	}
+	EXPECT_EQ(FLAC_END_OF_RANGE, fx_flac_get_state(inst));
+	free(inst);
+}
+
+static void test_flac_batch()
+{
+	/* The 32-bit test stream consists of seven frames with 16 samples each */
+	const uint32_t n_out = sizeof(FLAC_32BIT_OUT) / 4U;
+	const uint32_t out_sizes[] = {n_out, 32U, 7U};
+	for (uint32_t i = 0U; i < sizeof(out_sizes) / 4U; i++) {
+		fx_flac_t *inst = FX_FLAC_ALLOC_DEFAULT();
+		ASSERT_NE(NULL, inst);
+		int32_t out[sizeof(FLAC_32BIT_OUT) / 4U];
+		uint32_t in_ptr = 0U, out_ptr = 0U, n_frames = 0U, n_calls = 0U;
+		uint32_t events = 0U;
+		while (true) {
+			uint32_t in_len = sizeof(FLAC_32BIT) - in_ptr;
+			uint32_t out_len = n_out - out_ptr;
+			if (out_len > out_sizes[i]) {
+				out_len = out_sizes[i];
+			}
+			fx_flac_batch_result_t res;
+			fx_flac_state_t state =
+			    fx_flac_process_batch(inst, FLAC_32BIT + in_ptr, &in_len,
+			                          out + out_ptr, &out_len, &res);
+			ASSERT_NE(FLAC_ERR, state);
+			in_ptr += in_len;
+			out_ptr += out_len;
+			n_frames += res.n_frames;
+			events |= res.events;
+			n_calls++;
+			if (in_len == 0U && out_len == 0U) {
+				break;
+			}
+		}
+		EXPECT_EQ(7U, n_frames);
+		EXPECT_EQ(FLAC_BATCH_METADATA, events);
+		ASSERT_EQ(n_out, out_ptr);
+		for (uint32_t j = 0U; j < n_out; j++) {
+			ASSERT_EQ(FLAC_32BIT_OUT[j], out[j]);
+		}
+		if (out_sizes[i] == n_out) {
+			EXPECT_EQ(2U, n_calls); /* Single call plus end of stream */
+		}
+		free(inst);
+	}
+}
+
+static uint32_t decode_with_crc_mode(const uint8_t *in, uint32_t in_len,
+                                     fx_flac_crc_mode_t mode)
+{
+	fx_flac_t *inst = FX_FLAC_ALLOC_DEFAULT();
+	fx_flac_set_crc_mode(inst, mode);
+	fx_flac_reset(inst); /* The CRC mode must survive a reset */
+	int32_t out[sizeof(FLAC_FIXED_1_OUT) / 4U];
+	uint32_t out_len = sizeof(FLAC_FIXED_1_OUT) / 4U;
+	fx_flac_process_batch(inst, in, &in_len, out, &out_len, NULL);
+	for (uint32_t i = 0U; i < out_len; i++) {
+		EXPECT_EQ(FLAC_FIXED_1_OUT[i], out[i] >> 16);
+	}
+	free(inst);
+	return out_len;
+}
+
+static void test_flac_crc_mode()
+{
+	const uint32_t n_out = sizeof(FLAC_FIXED_1_OUT) / 4U;
+	uint8_t in[sizeof(FLAC_FIXED_1)];
+	for (uint32_t i = 0U; i < sizeof(in); i++) {
+		in[i] = FLAC_FIXED_1[i];
+	}
+
+	/* Corrupt the frame CRC-16 */
+	in[sizeof(in) - 1U] ^= 0x01U;
+	EXPECT_EQ(0U, decode_with_crc_mode(in, sizeof(in), FLAC_CRC_FULL));
+	EXPECT_EQ(n_out, decode_with_crc_mode(in, sizeof(in), FLAC_CRC_HEADER));
+	EXPECT_EQ(n_out, decode_with_crc_mode(in, sizeof(in), FLAC_CRC_NONE));
+	in[sizeof(in) - 1U] ^= 0x01U;
+
+	/* Corrupt the frame header CRC-8 */
+	in[48U] ^= 0x01U;
+	EXPECT_EQ(0U, decode_with_crc_mode(in, sizeof(in), FLAC_CRC_FULL));
+	EXPECT_EQ(0U, decode_with_crc_mode(in, sizeof(in), FLAC_CRC_HEADER));
+	EXPECT_EQ(n_out, decode_with_crc_mode(in, sizeof(in), FLAC_CRC_NONE));
+	in[48U] ^= 0x01U;
+
+	/* Changing the mode within a frame only affects the next frame */
+	fx_flac_t *inst = FX_FLAC_ALLOC_DEFAULT();
+	fx_flac_set_crc_mode(inst, FLAC_CRC_NONE);
+	int32_t out[sizeof(FLAC_FIXED_1_OUT) / 4U];
+	uint32_t in_ptr = 0U, out_ptr = 0U;
+	while (in_ptr < sizeof(in)) {
+		uint32_t in_len = 1U, out_len = n_out - out_ptr;
+		const fx_flac_state_t state = fx_flac_process(
+		    inst, in + in_ptr, &in_len, out + out_ptr, &out_len);
+		ASSERT_NE(FLAC_ERR, state);
+		if (state == FLAC_IN_FRAME) {
+			fx_flac_set_crc_mode(inst, FLAC_CRC_FULL);
+		}
+		in_ptr += in_len;
+		out_ptr += out_len;
+	}
+	uint32_t in_len = 0U, out_len = n_out - out_ptr;
+	fx_flac_process(inst, in, &in_len, out + out_ptr, &out_len);
+	out_ptr += out_len;
+	ASSERT_EQ(n_out, out_ptr);
+	for (uint32_t i = 0U; i < n_out; i++) {
+		EXPECT_EQ(FLAC_FIXED_1_OUT[i], out[i] >> 16);
+	}
+	free(inst);
+}
+
+static uint32_t verify_frames(const uint8_t *in, uint32_t in_len,
+                              uint32_t chunk, fx_flac_state_t *states,
+                              fx_flac_frame_info_t *infos, uint32_t n_max)
+{
+	fx_flac_t *inst = FX_FLAC_ALLOC_DEFAULT();
+	fx_flac_set_verify_only(inst, true);
+	uint32_t in_ptr = 0U, n = 0U;
+	while (true) {
+		int32_t out[16U];
+		uint32_t in_len_ = in_len - in_ptr, out_len = 16U;
+		in_len_ = (in_len_ > chunk) ? chunk : in_len_;
+		fx_flac_state_t state =
+		    fx_flac_process(inst, in + in_ptr, &in_len_, out, &out_len);
+		EXPECT_EQ(0U, out_len);
+		in_ptr += in_len_;
+		if (state == FLAC_END_OF_FRAME || state == FLAC_FRAME_CORRUPT) {
+			ASSERT_GT(n_max, n);
+			states[n] = state;
+			EXPECT_EQ(true, fx_flac_get_frame_info(inst, &infos[n]));
+			n++;
+		}
+		if (state == FLAC_ERR || (in_len_ == 0U && in_ptr == in_len)) {
+			break;
+		}
+	}
+	free(inst);
+	return n;
+}
+
+static void test_flac_verify_only()
+{
+	/* Offsets of the seven frames in the 32-bit test stream */
+	const uint32_t offs[] = {42U, 110U, 183U, 249U, 321U, 342U, 408U};
+	fx_flac_state_t states[8U];
+	fx_flac_frame_info_t infos[8U];
+
+	/* Intact stream */
+	uint8_t in[sizeof(FLAC_32BIT)];
+	for (uint32_t i = 0U; i < sizeof(in); i++) {
+		in[i] = FLAC_32BIT[i];
+	}
+	ASSERT_EQ(7U,
+	          verify_frames(in, sizeof(in), sizeof(in), states, infos, 8U));
+	for (uint32_t i = 0U; i < 7U; i++) {
+		EXPECT_EQ(FLAC_END_OF_FRAME, states[i]);
+		EXPECT_EQ(offs[i], infos[i].offset);
+		EXPECT_EQ(16U * i, infos[i].first_sample);
+		EXPECT_EQ(16U, infos[i].n_samples);
+	}
+
+	/* Feed the stream one byte at a time; the residual skip must cope with
+	   single bits left in the bit buffer */
+	ASSERT_EQ(7U, verify_frames(in, sizeof(in), 1U, states, infos, 8U));
+	for (uint32_t i = 0U; i < 7U; i++) {
+		EXPECT_EQ(FLAC_END_OF_FRAME, states[i]);
+		EXPECT_EQ(offs[i], infos[i].offset);
+	}
+
+	/* Corrupt the CRC-16 of the fourth frame */
+	in[offs[4] - 1U] ^= 0x80U;
+	ASSERT_EQ(7U,
+	          verify_frames(in, sizeof(in), sizeof(in), states, infos, 8U));
+	EXPECT_EQ(FLAC_FRAME_CORRUPT, states[3]);
+	EXPECT_EQ(offs[3], infos[3].offset);
+	EXPECT_EQ(48U, infos[3].first_sample);
+	EXPECT_EQ(16U, infos[3].n_samples);
+	EXPECT_EQ(FLAC_END_OF_FRAME, states[4]);
+	in[offs[4] - 1U] ^= 0x80U;
+
+	/* Corrupt the header CRC-8 of the second frame; the frame is skipped
+	   entirely and reported as a gap */
+	in[offs[1] + 7U] ^= 0x80U;
+	ASSERT_EQ(7U,
+	          verify_frames(in, sizeof(in), sizeof(in), states, infos, 8U));
+	EXPECT_EQ(FLAC_END_OF_FRAME, states[0]);
+	EXPECT_EQ(FLAC_FRAME_CORRUPT, states[1]);
+	EXPECT_EQ(offs[1], infos[1].offset);
+	EXPECT_EQ(16U, infos[1].first_sample);
+	EXPECT_EQ(16U, infos[1].n_samples);
+	EXPECT_EQ(FLAC_END_OF_FRAME, states[2]);
+	EXPECT_EQ(offs[2], infos[2].offset);
+}
+
+static void test_flac_sync_stats()
+{
+	/* Offsets of the fourth frame and the 8-byte header of the first frame
+	   in the 32-bit test stream */
+	const uint32_t off = 249U, hdr = 42U, n_hdr = 8U;
+	const uint32_t n_out = sizeof(FLAC_32BIT_OUT) / 4U;
+	int32_t out[sizeof(FLAC_32BIT_OUT) / 4U];
+	uint8_t in[sizeof(FLAC_32BIT) + 8U];
+	fx_flac_sync_stats_t stats;
+	fx_flac_t *inst = FX_FLAC_ALLOC_DEFAULT();
+	ASSERT_NE(NULL, inst);
+
+	/* Insert a copy of the first frame header in front of the fourth frame;
+	   the header CRC-8 is valid, but the frame number is not */
+	for (uint32_t i = 0U; i < off; i++) {
+		in[i] = FLAC_32BIT[i];
+	}
+	for (uint32_t i = 0U; i < n_hdr; i++) {
+		in[off + i] = FLAC_32BIT[hdr + i];
+	}
+	for (uint32_t i = off; i < sizeof(FLAC_32BIT); i++) {
+		in[n_hdr + i] = FLAC_32BIT[i];
+	}
+	ASSERT_EQ(n_out, decode_mixed(inst, in, sizeof(in), out, n_out));
+	for (uint32_t i = 0U; i < n_out; i++) {
+		ASSERT_EQ(FLAC_32BIT_OUT[i], out[i]);
+	}
+	fx_flac_get_sync_stats(inst, &stats);
+	EXPECT_EQ(0U, stats.n_header_crc);
+	EXPECT_EQ(0U, stats.n_inconsistent);
+	EXPECT_EQ(1U, stats.n_discontinuous);
+	EXPECT_EQ(0U, stats.n_oversized);
+
+	/* Announce a maximum block size of eight samples in the STREAMINFO */
+	for (uint32_t i = 0U; i < sizeof(FLAC_32BIT); i++) {
+		in[i] = FLAC_32BIT[i];
+	}
+	in[11U] = 8U;
+	fx_flac_reset(inst);
+	EXPECT_EQ(0U, decode_mixed(inst, in, sizeof(FLAC_32BIT), out, n_out));
+	fx_flac_get_sync_stats(inst, &stats);
+	EXPECT_EQ(7U, stats.n_inconsistent);
+	EXPECT_EQ(0U, stats.n_oversized);
+
+	/* Announce a maximum frame size of 32 bytes in the STREAMINFO; only the
+	   fifth frame is small enough */
+	in[11U] = FLAC_32BIT[11U];
+	in[17U] = 32U;
+	fx_flac_reset(inst);
+	ASSERT_EQ(32U, decode_mixed(inst, in, sizeof(FLAC_32BIT), out, n_out));
+	for (uint32_t i = 0U; i < 32U; i++) {
+		ASSERT_EQ(FLAC_32BIT_OUT[128U + i], out[i]);
+	}
+	fx_flac_get_sync_stats(inst, &stats);
+	EXPECT_EQ(0U, stats.n_inconsistent);
+	EXPECT_EQ(6U, stats.n_oversized);
+	free(inst);
+}
+
+static void test_flac_resync()
+{
+	/* Offsets of the frames and the end of the 32-bit test stream */
+	const uint32_t offs[] = {42U, 110U, 183U, 249U, 321U, 342U, 408U, 550U};
+	const uint32_t n_out = sizeof(FLAC_32BIT_OUT) / 4U;
+	int32_t out[2U * sizeof(FLAC_32BIT_OUT) / 4U];
+	uint8_t in[2U * sizeof(FLAC_32BIT)];
+	fx_flac_sync_stats_t stats;
+	fx_flac_t *inst = FX_FLAC_ALLOC_DEFAULT();
+	ASSERT_NE(NULL, inst);
+
+	/* Feed the stream twice without flushing; the second stream marker
+	   re-anchors the continuity check */
+	for (uint32_t i = 0U; i < sizeof(in); i++) {
+		in[i] = FLAC_32BIT[i % sizeof(FLAC_32BIT)];
+	}
+	ASSERT_EQ(2U * n_out, decode_mixed(inst, in, sizeof(in), out, 2U * n_out));
+	for (uint32_t i = 0U; i < 2U * n_out; i++) {
+		ASSERT_EQ(FLAC_32BIT_OUT[i % n_out], out[i]);
+	}
+	fx_flac_get_sync_stats(inst, &stats);
+	EXPECT_EQ(0U, stats.n_discontinuous);
+
+	/* Jump from the end of the second to the fifth frame */
+	uint32_t n_in = 0U;
+	for (uint32_t i = 0U; i < offs[2]; i++) {
+		in[n_in++] = FLAC_32BIT[i];
+	}
+	for (uint32_t i = offs[4]; i < sizeof(FLAC_32BIT); i++) {
+		in[n_in++] = FLAC_32BIT[i];
+	}
+	fx_flac_reset(inst);
+	ASSERT_EQ(n_out - 64U, decode_mixed(inst, in, n_in, out, n_out));
+	for (uint32_t i = 0U; i < n_out - 64U; i++) {
+		ASSERT_EQ(FLAC_32BIT_OUT[(i < 64U) ? i : (i + 64U)], out[i]);
+	}
+	fx_flac_get_sync_stats(inst, &stats);
+	EXPECT_EQ(0U, stats.n_discontinuous);
+
+	/* Loop the frames without stream marker; the first frame of the repeat
+	   is rejected, the second one continues it and re-anchors */
+	n_in = 0U;
+	for (uint32_t i = 0U; i < sizeof(FLAC_32BIT); i++) {
+		in[n_in++] = FLAC_32BIT[i];
+	}
+	for (uint32_t i = offs[0]; i < sizeof(FLAC_32BIT); i++) {
+		in[n_in++] = FLAC_32BIT[i];
+	}
+	fx_flac_reset(inst);
+	ASSERT_EQ(2U * n_out - 32U, decode_mixed(inst, in, n_in, out, 2U * n_out));
+	for (uint32_t i = 0U; i < 2U * n_out - 32U; i++) {
+		ASSERT_EQ(FLAC_32BIT_OUT[(i < n_out) ? i : (i - n_out + 32U)], out[i]);
+	}
+	fx_flac_get_sync_stats(inst, &stats);
+	EXPECT_EQ(1U, stats.n_discontinuous);
+	free(inst);
+}
+
+static void test_flac_short_last_frame()
+{
+	/* Stream with fixed block size of 24 samples and a last frame of twelve
+	   samples; the STREAMINFO announces the short frame as minimum block
+	   size. The samples are the same as in the variable block size stream. */
+	const uint32_t n_out = 60U, hdr = 42U;
+	int32_t out[60U], out_ref[60U];
+	fx_flac_frame_info_t info;
+	fx_flac_t *inst = FX_FLAC_ALLOC_DEFAULT();
+	ASSERT_NE(NULL, inst);
+	ASSERT_EQ(n_out, decode_mixed(inst, FLAC_VARIABLE, sizeof(FLAC_VARIABLE),
+	                              out_ref, n_out));
+	for (uint32_t k = 0U; k < 2U; k++) {
+		/* Without STREAMINFO, the nominal block size is unknown */
+		fx_flac_reset(inst);
+		ASSERT_EQ(true, fx_flac_set_headerless(inst, k, 44100U, 0U));
+		const uint8_t *in = FLAC_SHORT_LAST + k * hdr;
+		const uint32_t in_len = sizeof(FLAC_SHORT_LAST) - k * hdr;
+		uint32_t in_ptr = 0U, out_ptr = 0U, n_frames = 0U;
+		while (in_ptr < in_len) {
+			uint32_t n_in = in_len - in_ptr, n_smpls = n_out - out_ptr;
+			fx_flac_state_t state = fx_flac_process(inst, in + in_ptr, &n_in,
+			                                        out + out_ptr, &n_smpls);
+			ASSERT_NE(FLAC_ERR, state);
+			in_ptr += n_in;
+			out_ptr += n_smpls;
+			if (state == FLAC_END_OF_FRAME) {
+				ASSERT_EQ(true, fx_flac_get_frame_info(inst, &info));
+				EXPECT_EQ(24U * n_frames, info.first_sample);
+				EXPECT_EQ((n_frames < 2U) ? 24U : 12U, info.n_samples);
+				n_frames++;
+			}
+		}
+		EXPECT_EQ(3U, n_frames);
+		ASSERT_EQ(n_out, out_ptr);
+		for (uint32_t i = 0U; i < n_out; i++) {
+			ASSERT_EQ(out_ref[i], out[i]);
+		}
+	}
+	free(inst);
+}
+
+static uint32_t decode_concealed(fx_flac_t *inst, const uint8_t *in,
+                                 uint32_t in_len, int32_t *out,
+                                 uint32_t out_max, fx_flac_frame_info_t *gap)
+{
+	uint32_t in_ptr = 0U, out_ptr = 0U, n_gaps = 0U;
+	fx_flac_state_t old_state = FLAC_INIT;
+	while (true) {
+		uint32_t n_in = in_len - in_ptr;
+		uint32_t n_out = out_max - out_ptr;
+		n_out = (n_out > 5U) ? 5U : n_out;
+		fx_flac_state_t state =
+		    fx_flac_process(inst, in + in_ptr, &n_in, out + out_ptr, &n_out);
+		EXPECT_NE(FLAC_ERR, state);
+		/* The replacement samples are written in the FLAC_FRAME_CORRUPT
+		   state; only count the transitions */
+		if (state == FLAC_FRAME_CORRUPT && old_state != state &&
+		    n_gaps++ == 0U) {
+			EXPECT_EQ(true, fx_flac_get_frame_info(inst, gap));
+		}
+		old_state = state;
+		in_ptr += n_in;
+		out_ptr += n_out;
+		if (state != FLAC_FRAME_CORRUPT && n_in == 0U && n_out == 0U) {
+			break;
+		}
+	}
+	EXPECT_EQ(1U, n_gaps);
+	return out_ptr;
+}
+
+static void test_flac_conceal()
+{
+	/* The fourth frame of the 32-bit test stream covers the samples 48 to
+	   63; corrupt its CRC-16 */
+	const uint32_t n_out = sizeof(FLAC_32BIT_OUT) / 4U;
+	int32_t out[sizeof(FLAC_32BIT_OUT) / 4U];
+	uint8_t in[sizeof(FLAC_32BIT)];
+	for (uint32_t i = 0U; i < sizeof(in); i++) {
+		in[i] = FLAC_32BIT[i];
+	}
+	in[320U] ^= 0x80U;
+	fx_flac_t *inst = FX_FLAC_ALLOC_DEFAULT();
+	ASSERT_NE(NULL, inst);
+	EXPECT_EQ(false, fx_flac_set_concealment(inst, (fx_flac_conceal_t)3));
+
+	/* By default the frame is dropped */
+	ASSERT_EQ(n_out - 32U, decode_mixed(inst, in, sizeof(in), out, n_out));
+
+	/* Replace the frame with silence; batch decoding is not interrupted */
+	fx_flac_reset(inst);
+	ASSERT_EQ(true, fx_flac_set_concealment(inst, FLAC_CONCEAL_SILENCE));
+	uint32_t in_len = sizeof(in), out_len = n_out;
+	fx_flac_batch_result_t res;
+	fx_flac_process_batch(inst, in, &in_len, out, &out_len, &res);
+	ASSERT_EQ(n_out, out_len);
+	EXPECT_EQ(FLAC_BATCH_METADATA | FLAC_BATCH_RESYNC | FLAC_BATCH_GAP,
+	          res.events);
+	for (uint32_t i = 0U; i < n_out; i++) {
+		const bool lost = (i >= 96U) && (i < 128U);
+		ASSERT_EQ(lost ? 0 : FLAC_32BIT_OUT[i], out[i]);
+	}
+
+	/* Repeat the end of the third frame and fade it out */
+	fx_flac_reset(inst);
+	ASSERT_EQ(true, fx_flac_set_concealment(inst, FLAC_CONCEAL_REPEAT));
+	fx_flac_frame_info_t gap;
+	ASSERT_EQ(n_out, decode_concealed(inst, in, sizeof(in), out, n_out, &gap));
+	EXPECT_EQ(48U, gap.first_sample);
+	EXPECT_EQ(16U, gap.n_samples);
+	for (uint32_t i = 0U; i < n_out; i++) {
+		int32_t expected = FLAC_32BIT_OUT[i];
+		if ((i >= 96U) && (i < 128U)) {
+			const int64_t j = (i - 96U) / 2U;
+			expected = (int32_t)((int64_t)FLAC_32BIT_OUT[i - 32U] * (16 - j) /
+			                     16);
+		}
+		ASSERT_EQ(expected, out[i]);
+	}
+
+	/* A gap straddling the end of the range is concealed up to its end */
+	fx_flac_reset(inst);
+	ASSERT_EQ(true, fx_flac_set_concealment(inst, FLAC_CONCEAL_SILENCE));
+	ASSERT_EQ(true, fx_flac_set_range(inst, 40U, 56U));
+	in_len = sizeof(in);
+	out_len = n_out;
+	EXPECT_EQ(FLAC_END_OF_RANGE,
+	          fx_flac_process_batch(inst, in, &in_len, out, &out_len, &res));
+	ASSERT_EQ(32U, out_len);
+	for (uint32_t i = 0U; i < out_len; i++) {
+		ASSERT_EQ((i >= 16U) ? 0 : FLAC_32BIT_OUT[80U + i], out[i]);
+	}
+	free(inst);
+}
+
+static void test_flac_probe()
+{
+	/* Prepend an ID3v2 tag with five bytes of payload, clear the number of
+	   samples in the STREAMINFO block and append an ID3v1 tag */
+	const uint32_t n_tag = 15U, n_v1 = 128U;
+	uint8_t in[15U + sizeof(FLAC_32BIT) + 128U] = {'I', 'D', '3', 4U, 0U, 0U,
+	                                              0U,  0U,  0U,  5U};
+	for (uint32_t i = 0U; i < sizeof(FLAC_32BIT); i++) {
+		in[n_tag + i] = FLAC_32BIT[i];
+	}
+	in[n_tag + sizeof(FLAC_32BIT)] = 'T';
+	in[n_tag + sizeof(FLAC_32BIT) + 1U] = 'A';
+	in[n_tag + sizeof(FLAC_32BIT) + 2U] = 'G';
+
+	/* The buffer must contain the entire STREAMINFO block */
+	fx_flac_probe_t info;
+	EXPECT_EQ(n_tag + 42U, fx_flac_probe(in, 20U, &info));
+	EXPECT_EQ(n_tag, info.offset);
+	ASSERT_EQ(n_tag + 42U, fx_flac_probe(in, sizeof(in), &info));
+	EXPECT_EQ(n_tag, info.offset);
+	EXPECT_EQ(16U, info.min_block_size);
+	EXPECT_EQ(16U, info.max_block_size);
+	EXPECT_EQ(96000U, info.sample_rate);
+	EXPECT_EQ(2U, info.n_channels);
+	EXPECT_EQ(32U, info.sample_size);
+	EXPECT_EQ(112U, info.n_samples);
+
+	/* Probe a buffer starting at the stream itself */
+	ASSERT_EQ(42U, fx_flac_probe(in + n_tag, 42U, &info));
+	EXPECT_EQ(0U, info.offset);
+
+	/* Determine the number of samples from the last frame */
+	in[n_tag + 21U] &= 0xF0U;
+	in[n_tag + 25U] = 0U;
+	ASSERT_EQ(n_tag + 42U, fx_flac_probe(in, sizeof(in), &info));
+	EXPECT_EQ(0U, info.n_samples);
+	ASSERT_EQ(true, fx_flac_probe_tail(in + sizeof(in) - n_v1 - 200U,
+	                                   200U + n_v1, &info));
+	EXPECT_EQ(112U, info.n_samples);
+
+	/* Only the last bytes are needed to determine the size of the tags */
+	EXPECT_EQ(n_v1, fx_flac_probe_trailer(in + sizeof(in) - 160U, 160U));
+	EXPECT_EQ(0U, fx_flac_probe_trailer(in, sizeof(in) - n_v1));
+
+	/* The tail must contain the entire last frame */
+	EXPECT_EQ(false, fx_flac_probe_tail(in + sizeof(in) - n_v1 - 64U,
+	                                    64U + n_v1, &info));
+
+	/* Reject other data */
+	in[n_tag] = 'F';
+	EXPECT_EQ(0U, fx_flac_probe(in, sizeof(in), &info));
+}
+
+static void test_flac_packet()
+{
+	/* Feed the frames of the 32-bit test stream as individual packets */
+	static const uint32_t offs[] = {42U, 110U, 183U, 249U,
+	                                321U, 342U, 408U, 550U};
+	const uint32_t n_out = sizeof(FLAC_32BIT_OUT) / 4U;
+	int32_t out[sizeof(FLAC_32BIT_OUT) / 4U];
+	uint8_t in[sizeof(FLAC_32BIT)];
+	for (uint32_t i = 0U; i < sizeof(in); i++) {
+		in[i] = FLAC_32BIT[i];
+	}
+	fx_flac_t *inst = FX_FLAC_ALLOC_DEFAULT();
+	ASSERT_NE(NULL, inst);
+	EXPECT_EQ(false, fx_flac_set_streaminfo(inst, in + 8U, 33U));
+	ASSERT_EQ(true, fx_flac_set_streaminfo(inst, in + 8U, 34U));
+	EXPECT_EQ(96000, fx_flac_get_streaminfo(inst, FLAC_KEY_SAMPLE_RATE));
+
+	/* Corrupt the CRC-16 of the fourth frame and truncate the sixth frame;
+	   both packets are rejected without affecting their successors */
+	in[320U] ^= 0x80U;
+	uint32_t n_written = 0U;
+	for (uint32_t i = 0U; i < 7U; i++) {
+		const uint32_t len = offs[i + 1U] - offs[i] - ((i == 5U) ? 3U : 0U);
+		uint32_t out_len = n_out - n_written;
+		fx_flac_state_t state = fx_flac_decode_packet(
+		    inst, in + offs[i], len, out + n_written, &out_len);
+		if (i == 3U || i == 5U) {
+			fx_flac_frame_info_t info;
+			ASSERT_EQ(FLAC_FRAME_CORRUPT, state);
+			ASSERT_EQ(true, fx_flac_get_frame_info(inst, &info));
+			EXPECT_EQ(i * 16U, info.first_sample);
+			EXPECT_EQ(0U, out_len);
+		} else {
+			ASSERT_EQ(FLAC_END_OF_FRAME, state);
+			ASSERT_EQ(32U, out_len);
+			for (uint32_t j = 0U; j < 32U; j++) {
+				ASSERT_EQ(FLAC_32BIT_OUT[i * 32U + j], out[n_written + j]);
+			}
+		}
+		n_written += out_len;
+	}
+	EXPECT_EQ(n_out - 64U, n_written);
+
+	/* A packet is not searched for a frame */
+	uint32_t out_len = n_out;
+	EXPECT_EQ(FLAC_FRAME_CORRUPT,
+	          fx_flac_decode_packet(inst, in + 41U, 69U, out, &out_len));
+	EXPECT_EQ(0U, out_len);
+
+	/* Retrieve the remainder of a frame that does not fit into the output */
+	out_len = 20U;
+	ASSERT_EQ(FLAC_DECODED_FRAME,
+	          fx_flac_decode_packet(inst, in + 42U, 68U, out, &out_len));
+	ASSERT_EQ(20U, out_len);
+	uint32_t in_len = 0U;
+	out_len = 12U;
+	ASSERT_EQ(FLAC_END_OF_FRAME,
+	          fx_flac_process(inst, in, &in_len, out + 20U, &out_len));
+	ASSERT_EQ(12U, out_len);
+	for (uint32_t j = 0U; j < 32U; j++) {
+		ASSERT_EQ(FLAC_32BIT_OUT[j], out[j]);
+	}
+	free(inst);
+}
+
+static void test_flac_headerless()
+{
+	/* Join the 32-bit test stream in the middle of the first frame */
+	const uint32_t n_out = sizeof(FLAC_32BIT_OUT) / 4U;
+	int32_t out[sizeof(FLAC_32BIT_OUT) / 4U];
+	fx_flac_t *inst = FX_FLAC_ALLOC_DEFAULT();
+	ASSERT_NE(NULL, inst);
+	EXPECT_EQ(false, fx_flac_set_headerless(inst, true, 0U, 3U));
+	ASSERT_EQ(true, fx_flac_set_headerless(inst, true, 0U, 0U));
+	EXPECT_EQ(FLAC_SEARCH_FRAME, fx_flac_get_state(inst));
+	ASSERT_EQ(n_out - 32U, decode_mixed(inst, FLAC_32BIT + 80U,
+	                                    sizeof(FLAC_32BIT) - 80U, out, n_out));
+	for (uint32_t i = 0U; i < n_out - 32U; i++) {
+		ASSERT_EQ(FLAC_32BIT_OUT[32U + i], out[i]);
+	}
+
+	/* The frame headers refer to the STREAMINFO for the sample rate */
+	EXPECT_EQ(0, fx_flac_get_streaminfo(inst, FLAC_KEY_SAMPLE_RATE));
+	EXPECT_EQ(32, fx_flac_get_streaminfo(inst, FLAC_KEY_SAMPLE_SIZE));
+	EXPECT_EQ(2, fx_flac_get_streaminfo(inst, FLAC_KEY_N_CHANNELS));
+
+	/* The setting and the defaults are retained when resetting */
+	ASSERT_EQ(true, fx_flac_set_headerless(inst, true, 96000U, 0U));
+	fx_flac_reset(inst);
+	ASSERT_EQ(n_out - 32U, decode_mixed(inst, FLAC_32BIT + 80U,
+	                                    sizeof(FLAC_32BIT) - 80U, out, n_out));
+	EXPECT_EQ(96000, fx_flac_get_streaminfo(inst, FLAC_KEY_SAMPLE_RATE));
+
+	/* Without headerless mode, the decoder waits for the marker */
+	ASSERT_EQ(true, fx_flac_set_headerless(inst, false, 0U, 0U));
+	EXPECT_EQ(0U, decode_mixed(inst, FLAC_32BIT + 80U,
+	                           sizeof(FLAC_32BIT) - 80U, out, n_out));
+	free(inst);
+}
+
+static void test_flac_cuesheet()
+{
+	/* The test stream is the 32-bit stream with a cue sheet splitting it into
+	   three tracks; the second track has a pregap of eight samples */
+	const uint32_t n_out = sizeof(FLAC_32BIT_OUT) / 4U;
+	int32_t out[sizeof(FLAC_32BIT_OUT) / 4U];
+	fx_flac_cuesheet_t cs;
+	fx_flac_cue_track_t tracks[8];
+	fx_flac_cue_index_t indices[8];
+	fx_flac_t *inst = FX_FLAC_ALLOC_DEFAULT();
+	ASSERT_NE(NULL, inst);
+	fx_flac_set_cuesheet_output(inst, &cs, tracks, 8U, indices, 8U);
+	EXPECT_EQ(false, cs.valid);
+	ASSERT_EQ(n_out, decode_mixed(inst, FLAC_CUESHEET, sizeof(FLAC_CUESHEET),
+	                              out, n_out));
+	for (uint32_t i = 0U; i < n_out; i++) {
+		ASSERT_EQ(FLAC_32BIT_OUT[i], out[i]);
+	}
+	ASSERT_EQ(true, cs.valid);
+	EXPECT_EQ(false, cs.is_cd);
+	EXPECT_EQ('1', cs.catalog[0]);
+	EXPECT_EQ('3', cs.catalog[12]);
+	EXPECT_EQ(0, cs.catalog[13]);
+	ASSERT_EQ(4U, cs.n_tracks);
+	ASSERT_EQ(4U, cs.n_indices);
+	EXPECT_EQ(40U, tracks[1].offset);
+	EXPECT_EQ(2U, tracks[1].number);
+	EXPECT_EQ('D', tracks[1].isrc[0]);
+	EXPECT_EQ('9', tracks[1].isrc[11]);
+	EXPECT_EQ(0, tracks[1].isrc[12]);
+	EXPECT_EQ(true, tracks[1].audio);
+	EXPECT_EQ(true, tracks[1].pre_emphasis);
+	EXPECT_EQ(2U, tracks[1].n_indices);
+	EXPECT_EQ(1U, tracks[1].first_index);
+	EXPECT_EQ(8U, indices[2].offset);
+	EXPECT_EQ(1U, indices[2].number);
+	EXPECT_EQ(false, tracks[2].audio);
+	EXPECT_EQ(255U, tracks[3].number);
+	EXPECT_EQ(0U, tracks[3].n_indices);
+
+	/* Compute the track ranges; the pregap belongs to the preceding track */
+	uint64_t first = 0U, end = 0U;
+	ASSERT_EQ(true, fx_flac_cuesheet_track_range(&cs, 1U, &first, &end));
+	EXPECT_EQ(0U, first);
+	EXPECT_EQ(48U, end);
+	ASSERT_EQ(true, fx_flac_cuesheet_track_range(&cs, 3U, &first, &end));
+	EXPECT_EQ(80U, first);
+	EXPECT_EQ(112U, end);
+	EXPECT_EQ(false, fx_flac_cuesheet_track_range(&cs, 4U, &first, &end));
+	EXPECT_EQ(false, fx_flac_cuesheet_track_range(&cs, 255U, &first, &end));
+
+	/* Decode the second track, starting at the frame containing its first
+	   sample */
+	ASSERT_EQ(true, fx_flac_cuesheet_track_range(&cs, 2U, &first, &end));
+	EXPECT_EQ(48U, first);
+	EXPECT_EQ(80U, end);
+	fx_flac_probe_t info;
+	ASSERT_EQ(42U, fx_flac_probe(FLAC_CUESHEET, sizeof(FLAC_CUESHEET), &info));
+	uint64_t first_sample = 0U;
+	uint32_t n_samples = 0U, offs = 42U;
+	while (true) {
+		const int32_t res = fx_flac_find_frame(
+		    FLAC_CUESHEET + offs + 1U, sizeof(FLAC_CUESHEET) - offs - 1U,
+		    &info, &first_sample, &n_samples);
+		ASSERT_NE(-1, res);
+		offs += 1U + (uint32_t)res;
+		if (first_sample + n_samples > first) {
+			break;
+		}
+	}
+	EXPECT_EQ(48U, first_sample);
+	EXPECT_EQ(16U, n_samples);
+	EXPECT_EQ(841U, offs);
+	fx_flac_flush(inst);
+	ASSERT_EQ(true, fx_flac_set_range(inst, first, end));
+	ASSERT_EQ(64U, decode_mixed(inst, FLAC_CUESHEET + offs,
+	                            sizeof(FLAC_CUESHEET) - offs, out, n_out));
+	for (uint32_t i = 0U; i < 64U; i++) {
+		ASSERT_EQ(FLAC_32BIT_OUT[96U + i], out[i]);
+	}
+
+	/* Tracks that do not fit are skipped along with their index points */
+	fx_flac_set_cuesheet_output(inst, &cs, tracks, 2U, indices, 8U);
+	ASSERT_EQ(true, fx_flac_set_range(inst, 0U, FLAC_RANGE_END_OF_STREAM));
+	fx_flac_reset(inst);
+	ASSERT_EQ(n_out, decode_mixed(inst, FLAC_CUESHEET, sizeof(FLAC_CUESHEET),
+	                              out, n_out));
+	ASSERT_EQ(true, cs.valid);
+	EXPECT_EQ(2U, cs.n_tracks);
+	EXPECT_EQ(3U, cs.n_indices);
+	ASSERT_EQ(true, fx_flac_cuesheet_track_range(&cs, 2U, &first, &end));
+	EXPECT_EQ(FLAC_RANGE_END_OF_STREAM, end);
+	free(inst);
+}
+
+static uint32_t build_index(fx_flac_index_t *idx, const uint8_t *in,
+                            uint32_t in_len, uint32_t chunk_size)
+{
+	/* Simulate a file that grows by chunk_size bytes at a time */
+	uint32_t visible = 0U, count = 0U;
+	while (visible < in_len) {
+		visible = (in_len - visible > chunk_size) ? visible + chunk_size
+		                                          : in_len;
+		const uint32_t offs = (uint32_t)fx_flac_index_get_offset(idx);
+		uint32_t len = visible - offs;
+		if (!fx_flac_index_extend(idx, in + offs, &len)) {
+			return 0U;
+		}
+		if (fx_flac_index_get_count(idx) < count) {
+			return 0U; /* Entries are never removed */
+		}
+		count = fx_flac_index_get_count(idx);
+	}
+	return count;
+}
+
+static void test_flac_index()
+{
+	/* Index every frame of the 32-bit test stream */
+	static const uint32_t offs[] = {42U, 110U, 183U, 249U, 321U, 342U, 408U};
+	const uint32_t chunk_sizes[] = {1U, 23U, sizeof(FLAC_32BIT)};
+	for (uint32_t i = 0U; i < 3U; i++) {
+		fx_flac_index_t *idx = FX_FLAC_INDEX_ALLOC(16U, 0U);
+		ASSERT_NE(NULL, idx);
+		ASSERT_EQ(7U, build_index(idx, FLAC_32BIT, sizeof(FLAC_32BIT),
+		                          chunk_sizes[i]));
+		for (uint32_t j = 0U; j < 7U; j++) {
+			fx_flac_index_entry_t entry;
+			ASSERT_EQ(true, fx_flac_index_lookup(idx, j * 16U + 15U, &entry));
+			EXPECT_EQ(offs[j], entry.offset);
+			EXPECT_EQ(j * 16U, entry.first_sample);
+		}
+		free(idx);
+	}
+
+	/* Seek to a sample using the index */
+	const uint32_t n_out = sizeof(FLAC_32BIT_OUT) / 4U;
+	int32_t out[sizeof(FLAC_32BIT_OUT) / 4U];
+	fx_flac_index_t *idx = FX_FLAC_INDEX_ALLOC(16U, 0U);
+	ASSERT_NE(NULL, idx);
+	build_index(idx, FLAC_32BIT, sizeof(FLAC_32BIT), 64U);
+	fx_flac_index_entry_t entry;
+	ASSERT_EQ(true, fx_flac_index_lookup(idx, 50U, &entry));
+	EXPECT_EQ(249U, entry.offset);
+	fx_flac_t *inst = FX_FLAC_ALLOC_DEFAULT();
+	ASSERT_NE(NULL, inst);
+	ASSERT_EQ(true, fx_flac_set_streaminfo(inst, FLAC_32BIT + 8U, 34U));
+	ASSERT_EQ(true, fx_flac_set_range(inst, 50U, FLAC_RANGE_END_OF_STREAM));
+	ASSERT_EQ(n_out - 100U,
+	          decode_mixed(inst, FLAC_32BIT + entry.offset,
+	                       sizeof(FLAC_32BIT) - (uint32_t)entry.offset, out,
+	                       n_out));
+	for (uint32_t i = 0U; i < n_out - 100U; i++) {
+		ASSERT_EQ(FLAC_32BIT_OUT[100U + i], out[i]);
+	}
+	free(inst);
+	free(idx);
+
+	/* Thin out the entries and stop once the index is full */
+	idx = FX_FLAC_INDEX_ALLOC(16U, 32U);
+	ASSERT_EQ(4U, build_index(idx, FLAC_32BIT, sizeof(FLAC_32BIT), 64U));
+	ASSERT_EQ(true, fx_flac_index_lookup(idx, 63U, &entry));
+	EXPECT_EQ(183U, entry.offset);
+	free(idx);
+	idx = FX_FLAC_INDEX_ALLOC(2U, 0U);
+	ASSERT_EQ(2U, build_index(idx, FLAC_32BIT, sizeof(FLAC_32BIT), 64U));
+	free(idx);
+
+	/* Damage the header of the fourth frame; indexing continues with the
+	   fifth frame */
+	uint8_t in[sizeof(FLAC_32BIT)];
+	for (uint32_t i = 0U; i < sizeof(in); i++) {
+		in[i] = FLAC_32BIT[i];
+	}
+	in[offs[3] + 7U] ^= 0x80U;
+	for (uint32_t i = 0U; i < 3U; i++) {
+		idx = FX_FLAC_INDEX_ALLOC(16U, 0U);
+		ASSERT_EQ(6U, build_index(idx, in, sizeof(in), chunk_sizes[i]));
+		ASSERT_EQ(true, fx_flac_index_lookup(idx, 50U, &entry));
+		EXPECT_EQ(offs[2], entry.offset);
+		EXPECT_EQ(32U, entry.first_sample);
+		ASSERT_EQ(true, fx_flac_index_lookup(idx, 64U, &entry));
+		EXPECT_EQ(offs[4], entry.offset);
+		EXPECT_EQ(64U, entry.first_sample);
+		free(idx);
+	}
+
+	/* Plant a copy of the fourth frame header within the second frame; the
+	   false sync must not displace the third frame */
+	for (uint32_t i = 0U; i < sizeof(in); i++) {
+		in[i] = FLAC_32BIT[i];
+	}
+	for (uint32_t i = 0U; i < 8U; i++) {
+		in[offs[1] + 30U + i] = FLAC_32BIT[offs[3] + i];
+	}
+	for (uint32_t i = 0U; i < 3U; i++) {
+		idx = FX_FLAC_INDEX_ALLOC(16U, 0U);
+		ASSERT_EQ(7U, build_index(idx, in, sizeof(in), chunk_sizes[i]));
+		for (uint32_t j = 0U; j < 7U; j++) {
+			ASSERT_EQ(true, fx_flac_index_lookup(idx, j * 16U, &entry));
+			EXPECT_EQ(offs[j], entry.offset);
+		}
+		free(idx);
+	}
+
+	/* Reject other data */
+	idx = FX_FLAC_INDEX_ALLOC(16U, 0U);
+	EXPECT_EQ(0U, build_index(idx, FLAC_32BIT + 1U, sizeof(FLAC_32BIT) - 1U,
+	                          64U));
+	EXPECT_EQ(false, fx_flac_index_lookup(idx, 0U, &entry));
+	free(idx);
+}
+
+static uint32_t decode_to_end(fx_flac_t *inst, const uint8_t *in,
+                              uint32_t in_len, int32_t *out, uint32_t out_max,
+                              uint64_t *offsets)
+{
+	/* Decodes the remaining frames and records their stream offsets */
+	uint32_t n_out = 0U, n_frames = 0U;
+	while (true) {
+		uint32_t len = in_len, out_len = out_max - n_out;
+		fx_flac_state_t state =
+		    fx_flac_process(inst, in, &len, out + n_out, &out_len);
+		in += len;
+		in_len -= len;
+		n_out += out_len;
+		if (state == FLAC_END_OF_FRAME) {
+			fx_flac_frame_info_t info;
+			fx_flac_get_frame_info(inst, &info);
+			offsets[n_frames++] = info.offset;
+		} else if (len == 0U && out_len == 0U) {
+			return n_out;
+		}
+	}
+}
+
+static void test_flac_snapshot()
+{
+	/* Decode up to the end of the third frame of the 32-bit test stream */
+	const uint32_t n_out = sizeof(FLAC_32BIT_OUT) / 4U;
+	int32_t out[sizeof(FLAC_32BIT_OUT) / 4U];
+	uint8_t blob[FLAC_SNAPSHOT_SIZE];
+	fx_flac_t *inst = FX_FLAC_ALLOC_DEFAULT();
+	ASSERT_NE(NULL, inst);
+	EXPECT_EQ(false, fx_flac_snapshot(inst, blob, sizeof(blob)));
+	uint32_t in_pos = 0U, n_frames = 0U;
+	while (n_frames < 3U) {
+		uint32_t len = sizeof(FLAC_32BIT) - in_pos, out_len = n_out;
+		if (fx_flac_process(inst, FLAC_32BIT + in_pos, &len, out, &out_len) ==
+		    FLAC_END_OF_FRAME) {
+			n_frames++;
+		}
+		in_pos += len;
+	}
+	EXPECT_EQ(false, fx_flac_snapshot(inst, blob, sizeof(blob) - 1U));
+	ASSERT_EQ(true, fx_flac_snapshot(inst, blob, sizeof(blob)));
+
+	/* The original and the restored instance produce the same output */
+	int32_t out2[sizeof(FLAC_32BIT_OUT) / 4U];
+	uint64_t offs[8], offs2[8];
+	fx_flac_t *inst2 = FX_FLAC_ALLOC(64U, 2U);
+	ASSERT_NE(NULL, inst2);
+	ASSERT_EQ(true, fx_flac_restore(inst2, blob, sizeof(blob)));
+	EXPECT_EQ(FLAC_END_OF_FRAME, fx_flac_get_state(inst2));
+	EXPECT_EQ(96000, fx_flac_get_streaminfo(inst2, FLAC_KEY_SAMPLE_RATE));
+	fx_flac_frame_header_info_t hdr;
+	ASSERT_EQ(true, fx_flac_get_frame_header(inst2, &hdr));
+	EXPECT_EQ(183U, hdr.offset);
+	EXPECT_EQ(2U, hdr.sync_info);
+	const uint32_t n_rem = n_out - 96U;
+	ASSERT_EQ(n_rem, decode_to_end(inst, FLAC_32BIT + in_pos,
+	                               sizeof(FLAC_32BIT) - in_pos, out, n_out,
+	                               offs));
+	ASSERT_EQ(n_rem, decode_to_end(inst2, FLAC_32BIT + in_pos,
+	                               sizeof(FLAC_32BIT) - in_pos, out2, n_out,
+	                               offs2));
+	for (uint32_t i = 0U; i < n_rem; i++) {
+		ASSERT_EQ(FLAC_32BIT_OUT[96U + i], out[i]);
+		ASSERT_EQ(FLAC_32BIT_OUT[96U + i], out2[i]);
+	}
+	for (uint32_t i = 0U; i < 4U; i++) {
+		EXPECT_EQ(offs[i], offs2[i]);
+	}
+	EXPECT_EQ(249U, offs2[0]);
+
+	/* Reject corrupt blobs and streams that do not fit into the instance */
+	fx_flac_t *inst3 = FX_FLAC_ALLOC(8U, 2U);
+	ASSERT_NE(NULL, inst3);
+	EXPECT_EQ(false, fx_flac_restore(inst3, blob, sizeof(blob)));
+	EXPECT_EQ(false, fx_flac_restore(inst2, blob, sizeof(blob) - 1U));
+	blob[20] ^= 0x01U;
+	EXPECT_EQ(false, fx_flac_restore(inst2, blob, sizeof(blob)));
+	free(inst3);
+	free(inst2);
+	free(inst);
+}
+
+static void test_flac_cache()
+{
+	/* Cache the frames of the 32-bit test stream */
+	const uint32_t n_out = sizeof(FLAC_32BIT_OUT) / 4U;
+	int32_t out[sizeof(FLAC_32BIT_OUT) / 4U];
+	fx_flac_cache_stats_t stats;
+	EXPECT_EQ(NULL, fx_flac_cache_init(NULL, 4096U, 16U, 2U));
+	uint8_t small[64];
+	EXPECT_EQ(NULL, fx_flac_cache_init(small, sizeof(small), 16U, 2U));
+	fx_flac_cache_t *cache = FX_FLAC_CACHE_ALLOC(800U, 16U, 2U);
+	ASSERT_NE(NULL, cache);
+	fx_flac_cache_get_stats(cache, &stats);
+	ASSERT_LT(2U, stats.max_frames);
+	ASSERT_GT(7U, stats.max_frames);
+	const uint32_t max_frames = stats.max_frames;
+	EXPECT_EQ(false, fx_flac_cache_insert(cache, 0U, 17U, 2U, FLAC_32BIT_OUT));
+	for (uint32_t i = 0U; i < 7U; i++) {
+		ASSERT_EQ(true, fx_flac_cache_insert(cache, i * 16U, 16U, 2U,
+		                                     FLAC_32BIT_OUT + i * 32U));
+	}
+
+	/* Read a range spanning several frames */
+	uint32_t out_len = n_out;
+	uint8_t n_channels = 0U;
+	const uint32_t first = 16U * (7U - max_frames) + 5U;
+	ASSERT_EQ(true, fx_flac_cache_read(cache, first, out, &out_len,
+	                                   &n_channels));
+	EXPECT_EQ(2U, n_channels);
+	ASSERT_EQ(n_out - 2U * first, out_len);
+	for (uint32_t i = 0U; i < out_len; i++) {
+		ASSERT_EQ(FLAC_32BIT_OUT[2U * first + i], out[i]);
+	}
+
+	/* Only whole samples are written */
+	out_len = 5U;
+	ASSERT_EQ(true, fx_flac_cache_read(cache, 111U, out, &out_len, NULL));
+	ASSERT_EQ(2U, out_len);
+	EXPECT_EQ(FLAC_32BIT_OUT[222], out[0]);
+	out_len = n_out;
+	EXPECT_EQ(false, fx_flac_cache_read(cache, 112U, out, &out_len, NULL));
+	EXPECT_EQ(0U, out_len);
+
+	/* Inserting another frame evicts the least recently used one */
+	static const int32_t frame[32] = {0};
+	out_len = n_out;
+	ASSERT_EQ(true, fx_flac_cache_read(cache, 111U, out, &out_len, NULL));
+	ASSERT_EQ(true, fx_flac_cache_insert(cache, 112U, 16U, 2U, frame));
+	out_len = n_out;
+	EXPECT_EQ(false, fx_flac_cache_read(cache, first - 5U, out, &out_len,
+	                                    NULL));
+	out_len = n_out;
+	ASSERT_EQ(true, fx_flac_cache_read(cache, 96U, out, &out_len, NULL));
+	ASSERT_EQ(64U, out_len);
+	EXPECT_EQ(FLAC_32BIT_OUT[192], out[0]);
+	EXPECT_EQ(0, out[63]);
+
+	fx_flac_cache_get_stats(cache, &stats);
+	EXPECT_EQ(4U, stats.n_hits);
+	EXPECT_EQ(2U, stats.n_misses);
+	EXPECT_EQ(8U - max_frames, stats.n_evictions);
+	EXPECT_EQ(max_frames, stats.n_frames);
+	fx_flac_cache_clear(cache);
+	fx_flac_cache_get_stats(cache, &stats);
+	EXPECT_EQ(0U, stats.n_frames);
+	free(cache);
+}
+
+static void test_flac_frame_header()
+{
+	/* Frame headers of a stream with fixed and with variable blocking */
+	static const uint32_t offs_fixed[] = {42U, 110U, 183U, 249U,
+	                                      321U, 342U, 408U};
+	static const uint32_t offs_variable[] = {42U, 94U, 144U};
+	static const uint32_t first_variable[] = {0U, 24U, 48U};
+	fx_flac_frame_header_info_t hdr;
+	fx_flac_t *inst = FX_FLAC_ALLOC_DEFAULT();
+	ASSERT_NE(NULL, inst);
+	for (uint32_t k = 0U; k < 2U; k++) {
+		const uint8_t *in = k ? FLAC_VARIABLE : FLAC_32BIT;
+		const uint32_t in_size = k ? sizeof(FLAC_VARIABLE)
+		                           : sizeof(FLAC_32BIT);
+		EXPECT_EQ(false, fx_flac_get_frame_header(inst, &hdr));
+		uint32_t in_pos = 0U, n_frames = 0U;
+		while (in_pos < in_size) {
+			uint32_t len = in_size - in_pos;
+			fx_flac_state_t state =
+			    fx_flac_process(inst, in + in_pos, &len, NULL, NULL);
+			in_pos += len;
+			if (state != FLAC_END_OF_FRAME) {
+				continue;
+			}
+			ASSERT_EQ(true, fx_flac_get_frame_header(inst, &hdr));
+			if (k == 0U) {
+				EXPECT_EQ(offs_fixed[n_frames], hdr.offset);
+				EXPECT_EQ(n_frames * 16U, hdr.first_sample);
+				EXPECT_EQ(n_frames, hdr.sync_info);
+				EXPECT_EQ(FLAC_BLOCKING_FIXED, hdr.blocking);
+				EXPECT_EQ(16U, hdr.block_size);
+				EXPECT_EQ(96000U, hdr.sample_rate);
+				EXPECT_EQ(2U, hdr.channel_count);
+				EXPECT_EQ(32U, hdr.sample_size);
+			} else {
+				EXPECT_EQ(offs_variable[n_frames], hdr.offset);
+				EXPECT_EQ(first_variable[n_frames], hdr.first_sample);
+				EXPECT_EQ(first_variable[n_frames], hdr.sync_info);
+				EXPECT_EQ(FLAC_BLOCKING_VARIABLE, hdr.blocking);
+				EXPECT_EQ((n_frames < 2U) ? 24U : 12U, hdr.block_size);
+				EXPECT_EQ(44100U, hdr.sample_rate);
+				EXPECT_EQ(FLAC_CHANNELS_INDEPENDENT, hdr.channel_assignment);
+				EXPECT_EQ(1U, hdr.channel_count);
+				EXPECT_EQ(16U, hdr.sample_size);
+			}
+			n_frames++;
+		}
+		EXPECT_EQ(k ? 3U : 7U, n_frames);
+		fx_flac_reset(inst);
+	}
+	free(inst);
+}
+
+static uint32_t decode_ogg(const uint8_t *in_, uint32_t in_len_,
+                           uint32_t chunk_size, int32_t *out_,
+                           uint32_t out_len_, fx_flac_ogg_t *ogg)
+{
+	uint32_t in_ptr = 0U, out_ptr = 0U;
+	while (true) {
+		uint32_t in_len = in_len_ - in_ptr;
+		if (in_len > chunk_size) {
+			in_len = chunk_size;
+		}
+		uint32_t out_len = out_len_ - out_ptr;
+		fx_flac_state_t state = fx_flac_ogg_process(
+		    ogg, in_ + in_ptr, &in_len, out_ + out_ptr, &out_len);
+		in_ptr += in_len;
+		out_ptr += out_len;
+		if (state == FLAC_ERR || (in_len == 0U && out_len == 0U &&
+		                          in_ptr == in_len_)) {
+			break;
+		}
+	}
+	return out_ptr;
+}
+
+static void test_flac_ogg()
+{
+	const uint32_t n_out = sizeof(FLAC_FIXED_1_OUT) / 4U;
+	const uint32_t chunk_sizes[] = {1U, 7U, sizeof(FLAC_OGG_FIXED_1)};
+	for (uint32_t i = 0U; i < 3U; i++) {
+		fx_flac_t *inst = FX_FLAC_ALLOC_DEFAULT();
+		fx_flac_ogg_t *ogg = FX_FLAC_OGG_ALLOC(inst);
+		ASSERT_NE(NULL, ogg);
+		EXPECT_EQ(FLAC_OGG_NO_GRANULE, fx_flac_ogg_get_granule(ogg));
+
+		int32_t out[2304U];
+		ASSERT_EQ(n_out,
+		          decode_ogg(FLAC_OGG_FIXED_1, sizeof(FLAC_OGG_FIXED_1),
+		                     chunk_sizes[i], out, n_out, ogg));
+		for (uint32_t j = 0U; j < n_out; j++) {
+			ASSERT_EQ(FLAC_FIXED_1_OUT[j], out[j] >> 16);
+		}
+		EXPECT_EQ(1152, fx_flac_ogg_get_granule(ogg));
+		EXPECT_EQ(0U, fx_flac_ogg_get_crc_errors(ogg));
+		EXPECT_EQ(48000, fx_flac_get_streaminfo(inst, FLAC_KEY_SAMPLE_RATE));
+		free(ogg);
+		free(inst);
+	}
+}
+
+static void test_flac_ogg_crc()
+{
+	/* Corrupt a byte in the audio page; the frame must be dropped */
+	uint8_t in[sizeof(FLAC_OGG_FIXED_1)];
+	for (uint32_t i = 0U; i < sizeof(in); i++) {
+		in[i] = FLAC_OGG_FIXED_1[i];
+	}
+	in[sizeof(in) - 1U] ^= 0x01U;
+
+	fx_flac_t *inst = FX_FLAC_ALLOC_DEFAULT();
+	fx_flac_ogg_t *ogg = FX_FLAC_OGG_ALLOC(inst);
+	ASSERT_NE(NULL, ogg);
+	int32_t out[2304U];
+	EXPECT_EQ(0U, decode_ogg(in, sizeof(in), 64U, out, 2304U, ogg));
+	EXPECT_EQ(1U, fx_flac_ogg_get_crc_errors(ogg));
+	free(ogg);
+	free(inst);
+}
+
+static void test_flac_ogg_find_page()
+{
+	int64_t granule = -2;
+	EXPECT_EQ(0, fx_flac_ogg_find_page(FLAC_OGG_FIXED_1,
+	                                   sizeof(FLAC_OGG_FIXED_1), &granule));
+	EXPECT_EQ(0, granule);
+	EXPECT_EQ(225 - 119, fx_flac_ogg_find_page(FLAC_OGG_FIXED_1 + 120,
+	                                           sizeof(FLAC_OGG_FIXED_1) - 120,
+	                                           &granule));
+	EXPECT_EQ(1152, granule);
+	EXPECT_EQ(-1, fx_flac_ogg_find_page(FLAC_OGG_FIXED_1 + 227,
+	                                    sizeof(FLAC_OGG_FIXED_1) - 227, NULL));
+}
+
 /******************************************************************************
  * Main program                                                               *
  ******************************************************************************/
@@ -286,5 +1829,31 @@ int main()
 	RUN(test_flac_header_shift_4);
 	RUN(test_flac_fixed_1);
 	RUN(test_flac_fixed_2);
+	RUN(test_flac_32bit);
+	RUN(test_flac_planar);
+	RUN(test_flac_downmix);
+	RUN(test_flac_channel_mask);
+	RUN(test_flac_output_stage);
+	RUN(test_flac_peaks);
+	RUN(test_flac_constant);
+	RUN(test_flac_range);
+	RUN(test_flac_batch);
+	RUN(test_flac_crc_mode);
+	RUN(test_flac_verify_only);
+	RUN(test_flac_sync_stats);
+	RUN(test_flac_resync);
+	RUN(test_flac_short_last_frame);
+	RUN(test_flac_conceal);
+	RUN(test_flac_probe);
+	RUN(test_flac_packet);
+	RUN(test_flac_headerless);
+	RUN(test_flac_cuesheet);
+	RUN(test_flac_index);
+	RUN(test_flac_snapshot);
+	RUN(test_flac_cache);
+	RUN(test_flac_frame_header);
+	RUN(test_flac_ogg);
+	RUN(test_flac_ogg_crc);
+	RUN(test_flac_ogg_find_page);
 	DONE;
 }
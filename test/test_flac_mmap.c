@@ -0,0 +1,344 @@
+/*
+ *  libfoxenflac -- Tiny FLAC Decoder Library
+ *  Copyright (C) 2018-2025  Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#define _DEFAULT_SOURCE /* for mkstemp() */
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <foxen-flac-cache.h>
+#include <foxen-flac-mmap.h>
+#include <foxen-flac.h>
+#include <foxen-unittest.h>
+
+/******************************************************************************
+ * Helper functions                                                           *
+ ******************************************************************************/
+
+/**
+ * Directory containing the test files, passed as first argument.
+ */
+static const char *data_dir = "test/data";
+
+/**
+ * Test files decoded by the tests below.
+ */
+static const char *const data_files[] = {
+    "noise.flac", "wasted_bits.flac", "short.flac",
+    "subframe_header_reset.flac", "afl_rice_parameter_zero.flac"};
+
+#define N_DATA_FILES (sizeof(data_files) / sizeof(data_files[0]))
+
+/**
+ * Samples decoded using fx_flac_process(), used as reference.
+ */
+typedef struct {
+	int32_t *data;
+	uint32_t n; /* Number of samples, not samples per channel */
+	uint8_t n_channels;
+} reference_t;
+
+static void data_path(char *path, uint32_t len, uint32_t i)
+{
+	snprintf(path, len, "%s/%s", data_dir, data_files[i]);
+}
+
+static bool decode_reference(const char *path, reference_t *ref)
+{
+	/* Read the entire file */
+	FILE *f = fopen(path, "rb");
+	if (!f) {
+		return false;
+	}
+	fseek(f, 0, SEEK_END);
+	const uint32_t in_len = (uint32_t)ftell(f);
+	fseek(f, 0, SEEK_SET);
+	uint8_t *in = (uint8_t *)malloc(in_len);
+	const bool ok = in && (fread(in, 1U, in_len, f) == in_len);
+	fclose(f);
+
+	/* Decode it using the streaming API */
+	fx_flac_t *inst = FX_FLAC_ALLOC_DEFAULT();
+	uint32_t in_ptr = 0U, max = 1U << 16U;
+	ref->data = (int32_t *)malloc(max * sizeof(int32_t));
+	ref->n = 0U;
+	while (ok && inst && ref->data) {
+		if (max - ref->n < 4096U) {
+			max *= 2U;
+			ref->data = (int32_t *)realloc(ref->data, max * sizeof(int32_t));
+			continue;
+		}
+		uint32_t n_in = in_len - in_ptr, n_out = 4096U;
+		if (fx_flac_process(inst, in + in_ptr, &n_in, ref->data + ref->n,
+		                    &n_out) == FLAC_ERR) {
+			break;
+		}
+		in_ptr += n_in;
+		ref->n += n_out;
+		if (n_in == 0U && n_out == 0U) {
+			ref->n_channels =
+			    (uint8_t)fx_flac_get_streaminfo(inst, FLAC_KEY_N_CHANNELS);
+			free(inst);
+			free(in);
+			return true;
+		}
+	}
+	free(inst);
+	free(in);
+	free(ref->data);
+	return false;
+}
+
+/******************************************************************************
+ * Unit tests                                                                 *
+ ******************************************************************************/
+
+static void test_flac_mmap_decode_file()
+{
+	for (uint32_t i = 0U; i < N_DATA_FILES; i++) {
+		char path[1024];
+		reference_t ref;
+		fx_flac_pcm_t pcm;
+		data_path(path, sizeof(path), i);
+		ASSERT_EQ(true, decode_reference(path, &ref));
+		ASSERT_EQ(true, fx_flac_decode_file(path, FLAC_PCM_S32, &pcm));
+		EXPECT_EQ(ref.n_channels, pcm.n_channels);
+		EXPECT_EQ(FLAC_PCM_S32, pcm.format);
+		EXPECT_EQ(ref.n, pcm.n_samples * pcm.n_channels);
+		EXPECT_EQ(0, memcmp(ref.data, pcm.data, ref.n * sizeof(int32_t)));
+		free(pcm.data);
+		free(ref.data);
+	}
+}
+
+static void test_flac_mmap_read()
+{
+	/* Read the file in chunks that do not align with the frames */
+	int32_t out[1000U];
+	for (uint32_t i = 0U; i < N_DATA_FILES; i++) {
+		char path[1024];
+		reference_t ref;
+		data_path(path, sizeof(path), i);
+		ASSERT_EQ(true, decode_reference(path, &ref));
+		fx_flac_mmap_t *f = fx_flac_open_mmap(path);
+		ASSERT_NE(NULL, f);
+		uint32_t n = 0U;
+		while (true) {
+			uint32_t out_len = 1000U;
+			ASSERT_NE(FLAC_ERR,
+			          fx_flac_mmap_read(f, out, &out_len, FLAC_PCM_S32));
+			ASSERT_EQ(true, n + out_len <= ref.n);
+			EXPECT_EQ(0, memcmp(ref.data + n, out, out_len * sizeof(int32_t)));
+			n += out_len;
+			if (out_len < 1000U) {
+				break;
+			}
+		}
+		EXPECT_EQ(ref.n, n);
+		fx_flac_close_mmap(f);
+		free(ref.data);
+	}
+}
+
+static bool first_sample(fx_flac_mmap_t *f, uint64_t *first)
+{
+	/* Some files do not start at sample zero; read a single sample to find
+	   the first frame. Returns false if the file has no decodable frame. */
+	int32_t smpl;
+	uint32_t out_len = 1U;
+	fx_flac_frame_info_t info;
+	fx_flac_mmap_read(f, &smpl, &out_len, FLAC_PCM_S32);
+	if (out_len == 0U ||
+	    !fx_flac_get_frame_info(fx_flac_mmap_get_decoder(f), &info)) {
+		return false;
+	}
+	*first = info.first_sample;
+	return true;
+}
+
+static void check_read_range(fx_flac_mmap_t *f, const reference_t *ref,
+                             uint64_t first, uint32_t *n_end)
+{
+	/* Windows relative to the first sample: the first frame, an unaligned
+	   window spanning several frames, a jump backwards, the end of the
+	   stream and past the end of the stream */
+	const uint8_t cc = ref->n_channels;
+	const uint32_t n_smpls = ref->n / cc;
+	const uint32_t starts[] = {0U,           1000U,       1U,
+	                           n_smpls / 2U, n_smpls - 7U, n_smpls};
+	const uint32_t len = 3000U;
+	int32_t *out = (int32_t *)malloc(len * cc * sizeof(int32_t));
+	*n_end = 0U;
+	ASSERT_NE(NULL, out);
+	for (uint32_t i = 0U; i < sizeof(starts) / sizeof(starts[0]); i++) {
+		const uint32_t start = (starts[i] > n_smpls) ? 0U : starts[i];
+		const uint32_t n = (n_smpls - start < len) ? n_smpls - start : len;
+		uint32_t out_len = len * cc;
+		EXPECT_EQ(true, fx_flac_mmap_read_range(f, first + start, out,
+		                                        &out_len, FLAC_PCM_S32));
+		EXPECT_EQ(n * cc, out_len);
+		*n_end += (n < len) ? 1U : 0U;
+		EXPECT_EQ(0, memcmp(ref->data + (size_t)start * cc, out,
+		                    out_len * sizeof(int32_t)));
+	}
+	free(out);
+}
+
+static void test_flac_mmap_read_range()
+{
+	for (uint32_t i = 0U; i < N_DATA_FILES; i++) {
+		char path[1024];
+		reference_t ref;
+		data_path(path, sizeof(path), i);
+		ASSERT_EQ(true, decode_reference(path, &ref));
+		fx_flac_mmap_t *f = fx_flac_open_mmap(path);
+		ASSERT_NE(NULL, f);
+		uint64_t first;
+		if (!first_sample(f, &first)) {
+			/* Nothing to read; ranges cannot be located in this file */
+			EXPECT_EQ(0U, ref.n);
+			fx_flac_close_mmap(f);
+			free(ref.data);
+			continue;
+		}
+
+		/* Decode each window from the file */
+		uint32_t n_end;
+		check_read_range(f, &ref, first, &n_end);
+
+		/* Fill the cache, then serve the same windows from it */
+		const fx_flac_t *inst = fx_flac_mmap_get_decoder(f);
+		const uint16_t max_block = (uint16_t)fx_flac_get_streaminfo(
+		    inst, FLAC_KEY_MAX_BLOCK_SIZE);
+		fx_flac_cache_t *cache =
+		    FX_FLAC_CACHE_ALLOC(1U << 22U, max_block, ref.n_channels);
+		ASSERT_NE(NULL, cache);
+		fx_flac_mmap_set_cache(f, cache);
+		check_read_range(f, &ref, first, &n_end);
+		fx_flac_cache_stats_t stats;
+		fx_flac_cache_get_stats(cache, &stats);
+		const uint32_t n_misses = stats.n_misses;
+		EXPECT_NE(0U, stats.n_frames);
+		check_read_range(f, &ref, first, &n_end);
+		fx_flac_cache_get_stats(cache, &stats);
+		EXPECT_EQ(0U, stats.n_evictions);
+
+		/* Only the reads reaching the end of the stream miss */
+		EXPECT_EQ(n_misses + n_end, stats.n_misses);
+
+		fx_flac_mmap_set_cache(f, NULL);
+		fx_flac_close_mmap(f);
+		free(cache);
+		free(ref.data);
+	}
+}
+
+static void test_flac_mmap_read_range_buffered()
+{
+	/* Contiguous reads ending within a frame continue from the decoded frame
+	   without the decoder; flush the decoder to detect that it is not used */
+	char path[1024];
+	reference_t ref;
+	data_path(path, sizeof(path), 0U);
+	ASSERT_EQ(true, decode_reference(path, &ref));
+	fx_flac_mmap_t *f = fx_flac_open_mmap(path);
+	ASSERT_NE(NULL, f);
+	uint64_t first;
+	ASSERT_EQ(true, first_sample(f, &first));
+	const uint8_t cc = ref.n_channels;
+	int32_t out[16U];
+	uint32_t out_len = cc;
+	ASSERT_EQ(true, fx_flac_mmap_read_range(f, first + 10U, out, &out_len,
+	                                        FLAC_PCM_S32));
+	EXPECT_EQ(cc, out_len);
+	fx_flac_flush(fx_flac_mmap_get_decoder(f));
+	for (uint32_t i = 11U; i < 14U; i++) {
+		out_len = cc;
+		ASSERT_EQ(true, fx_flac_mmap_read_range(f, first + i, out, &out_len,
+		                                        FLAC_PCM_S32));
+		ASSERT_EQ(cc, out_len);
+		EXPECT_EQ(0, memcmp(ref.data + (size_t)i * cc, out,
+		                    cc * sizeof(int32_t)));
+	}
+	EXPECT_EQ(FLAC_SEARCH_FRAME,
+	          fx_flac_get_state(fx_flac_mmap_get_decoder(f)));
+	fx_flac_close_mmap(f);
+	free(ref.data);
+}
+
+static void test_flac_mmap_probe_trailer()
+{
+	/* Clear the number of samples in the STREAMINFO block of a file and
+	   append an APEv2 tag that is larger than the maximum frame size */
+	char path[1024];
+	data_path(path, sizeof(path), 0U);
+	FILE *f = fopen(path, "rb");
+	ASSERT_NE(NULL, f);
+	const uint32_t n_tag = 70000U, n_footer = 32U;
+	uint8_t *in = (uint8_t *)calloc(1U << 18U, 1U);
+	ASSERT_NE(NULL, in);
+	const uint32_t in_len = (uint32_t)fread(in, 1U, 1U << 17U, f);
+	fclose(f);
+	in[21U] &= 0xF0U;
+	in[22U] = in[23U] = in[24U] = in[25U] = 0U;
+	uint8_t *footer = in + in_len + n_tag;
+	memcpy(footer, "APETAGEX", 8U);
+	footer[8U] = 0xD0U; /* Version 2000 */
+	footer[9U] = 0x07U;
+	footer[12U] = (uint8_t)(n_tag + n_footer);
+	footer[13U] = (uint8_t)((n_tag + n_footer) >> 8U);
+	footer[14U] = (uint8_t)((n_tag + n_footer) >> 16U);
+
+	char tmp[] = "/tmp/test_flac_mmap_XXXXXX";
+	const int fd = mkstemp(tmp);
+	ASSERT_NE(-1, fd);
+	const size_t len = in_len + n_tag + n_footer;
+	EXPECT_EQ((ssize_t)len, write(fd, in, len));
+	close(fd);
+
+	fx_flac_probe_t info;
+	EXPECT_EQ(true, fx_flac_probe_file(tmp, false, &info));
+	EXPECT_EQ(0U, info.n_samples);
+	EXPECT_EQ(true, fx_flac_probe_file(tmp, true, &info));
+	EXPECT_EQ(true, info.max_frame_size < n_tag);
+	reference_t ref;
+	ASSERT_EQ(true, decode_reference(path, &ref));
+	EXPECT_EQ(ref.n / ref.n_channels, info.n_samples);
+	free(ref.data);
+	unlink(tmp);
+	free(in);
+}
+
+/******************************************************************************
+ * Main program                                                               *
+ ******************************************************************************/
+
+int main(int argc, const char *argv[])
+{
+	if (argc > 1) {
+		data_dir = argv[1];
+	}
+	RUN(test_flac_mmap_decode_file);
+	RUN(test_flac_mmap_read);
+	RUN(test_flac_mmap_read_range);
+	RUN(test_flac_mmap_read_range_buffered);
+	RUN(test_flac_mmap_probe_trailer);
+	DONE;
+}